@@ -0,0 +1,31 @@
+echo
+echo "##########################################################"
+echo "#                 Running Benchmarks....                 #"
+echo "##########################################################"
+
+BENCH_FLAGS="-O2 -g -Wall -Werror"
+INCLUDE_FLAGS="-Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -Iutil"
+SOURCES="src/memory/scratch_arena.c src/memory/page_arena.c src/tsp/dist_matrix.c src/tsp/tsp_loader.c src/tsp/dist_kernels.c src/tsp/dist_oracle.c src/tsp/kd_tree.c src/tsp/hash.c src/tsp/matrix_cache.c src/tsp/quant_matrix.c src/tsp/tiled_matrix.c src/tsp/hilbert.c src/tsp/tour.c src/tsp/construct.c src/tsp/local_search.c src/tsp/lin_kernighan.c src/tsp/held_karp.c src/tsp/window_opt.c src/tsp/fragment_cache.c src/tsp/concurrent_cache.c src/tsp/trie.c src/tsp/lut.c src/thread/thread_pool.c util/timer.c"
+
+mkdir -p build/bench
+mkdir -p bin
+
+for src in $SOURCES; do
+    obj=build/bench/$(basename ${src%.c}).o
+    if ! clang -std=c99 $BENCH_FLAGS -c $src -o $obj $INCLUDE_FLAGS; then
+        echo "[ ] Benchmark compilation failed on $src"
+        exit 1
+    fi
+done
+
+: > bench_output.txt
+for b in bench/bench_*.c; do
+    name=$(basename ${b%.c})
+    if ! clang -std=c99 -pthread $BENCH_FLAGS $b build/bench/*.o -o bin/$name $INCLUDE_FLAGS -lm; then
+        echo "[ ] Benchmark compilation failed on $b"
+        exit 1
+    fi
+    ./bin/$name 2>/dev/null | tee -a bench_output.txt
+done
+
+echo "[X] Benchmarks complete, results in bench_output.txt"
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "tour.h"
+#include "construct.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+
+static void benchFile(ScratchArena* arena, const char* filename) {
+    resetScratchArena(arena);
+    u32 hw = hardwareThreadCount();
+    TspInstance inst = LoadTspInstanceParallel(arena, filename, hw);
+    DistanceMatrix dm = BuildDistanceMatrixParallel(arena, &inst, hw);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    if (!dm.distances) {
+        printf("%-24s build failed\n", filename);
+        return;
+    }
+    for (u32 m = 0; m < CONSTRUCT_METHOD_COUNT; m++) {
+        arenaScratchPush(arena);
+        u64 start = timerNowNs();
+        u32* tour = ConstructTour(arena, (ConstructMethod)m, (const Vec2*)inst.coords, inst.count, &oracle, hw);
+        f64 ms = timerElapsedMs(start);
+        if (!tour) {
+            printf("%-24s %-20s failed\n", filename, ConstructMethodName((ConstructMethod)m));
+        } else {
+            printf("%-24s %-20s %9.3f ms   length %14.1f\n", filename, ConstructMethodName((ConstructMethod)m),
+                   ms, TourLength(dm, tour, inst.count));
+        }
+        arenaScratchPop(arena);
+    }
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== Tour construction: time and length (%u threads) ==\n", hardwareThreadCount());
+    benchFile(&arena, "test_data/ca4663.tsp");
+    benchFile(&arena, "test_data/it16862.tsp");
+    destroyScratchArena(&arena);
+    return 0;
+}
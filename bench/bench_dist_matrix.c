@@ -0,0 +1,108 @@
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+#define ITERATIONS 3
+
+static const char* levelNames[] = { "scalar", "sse2", "avx2" };
+
+static f64 benchAos(const TspInstance* inst, DistanceMatrix dm, TspMetric metric) {
+    DistRowKernel kernel = SelectRowKernel(metric);
+    f64 best = 1e30;
+    for (u32 it = 0; it < ITERATIONS; it++) {
+        u64 start = timerNowNs();
+        for (u32 i = 0; i + 1 < inst->count; i++) {
+            kernel(inst->coords, inst->count, i, dm.distances + dm.rowOffset[i]);
+        }
+        f64 ms = timerElapsedMs(start);
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+static f64 benchSoa(ScratchArena* arena, const TspInstance* inst, DistanceMatrix dm, TspMetric metric, DistSimdLevel level) {
+    f64 best = 1e30;
+    for (u32 it = 0; it < ITERATIONS; it++) {
+        arenaScratchPush(arena);
+        u64 start = timerNowNs();
+        FillDistanceRows(arena, dm, inst->coords, inst->count, metric, level);
+        f64 ms = timerElapsedMs(start);
+        arenaScratchPop(arena);
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+static void benchFile(ScratchArena* arena, const char* filename, u32 limit) {
+    resetScratchArena(arena);
+    TspInstance inst = LoadTspInstance(arena, filename);
+    if (inst.status != TSP_LOAD_OK) return;
+    if (limit && inst.count > limit) inst.count = limit;
+
+    DistanceMatrix dm;
+    dm.rowOffset = arenaScratchAlloc(arena, sizeof(u32) * inst.count, ALIGN_64);
+    dm.distances = arenaScratchAlloc(arena, PackedMatrixSize(inst.count) * sizeof(f32) + sizeof(f32), ALIGN_64);
+    if (!dm.distances) return;
+    FillRowOffsets(dm.rowOffset, inst.count);
+
+    TspMetric metrics[] = { TSP_METRIC_SQR_EUC_2D, TSP_METRIC_EUC_2D };
+    const char* metricNames[] = { "SQR_EUC_2D", "EUC_2D" };
+    DistSimdLevel top = DetectSimdLevel();
+    for (u32 m = 0; m < ARRAY_COUNT(metrics); m++) {
+        f64 aos = benchAos(&inst, dm, metrics[m]);
+        printf("%-24s n=%-6u %-10s aos scalar %9.2f ms\n", filename, inst.count, metricNames[m], aos);
+        for (u32 level = DIST_SIMD_SCALAR; level <= top; level++) {
+            f64 ms = benchSoa(arena, &inst, dm, metrics[m], (DistSimdLevel)level);
+            printf("%-24s n=%-6u %-10s soa %-6s %9.2f ms   speedup %5.2fx\n",
+                   filename, inst.count, metricNames[m], levelNames[level], ms, aos / ms);
+        }
+    }
+}
+
+static void benchThreads(ScratchArena* arena, const char* filename, u32 limit) {
+    resetScratchArena(arena);
+    TspInstance inst = LoadTspInstance(arena, filename);
+    if (inst.status != TSP_LOAD_OK) return;
+    if (limit && inst.count > limit) inst.count = limit;
+
+    DistanceMatrix dm;
+    dm.rowOffset = arenaScratchAlloc(arena, sizeof(u32) * inst.count, ALIGN_64);
+    dm.distances = arenaScratchAlloc(arena, PackedMatrixSize(inst.count) * sizeof(f32) + sizeof(f32), ALIGN_64);
+    if (!dm.distances) return;
+    FillRowOffsets(dm.rowOffset, inst.count);
+
+    u32 hw = hardwareThreadCount();
+    u32 threadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    f64 serial = 0.0;
+    for (u32 t = 0; t < ARRAY_COUNT(threadCounts) && threadCounts[t] <= hw * 2; t++) {
+        f64 best = 1e30;
+        for (u32 it = 0; it < ITERATIONS; it++) {
+            arenaScratchPush(arena);
+            u64 start = timerNowNs();
+            FillDistanceRowsParallel(arena, dm, inst.coords, inst.count, TSP_METRIC_EUC_2D, DetectSimdLevel(), threadCounts[t]);
+            f64 ms = timerElapsedMs(start);
+            arenaScratchPop(arena);
+            if (ms < best) best = ms;
+        }
+        if (t == 0) serial = best;
+        printf("%-24s n=%-6u EUC_2D     threads %2u %9.2f ms   scaling %5.2fx\n",
+               filename, inst.count, threadCounts[t], best, serial / best);
+    }
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== Packed matrix build: AoS scalar vs SoA vector kernels (best of %d) ==\n", ITERATIONS);
+    benchFile(&arena, "test_data/ca4663.tsp", 0);
+    benchFile(&arena, "test_data/it16862.tsp", 12000);
+    printf("== Equal-work parallel build with stealing (%u hardware threads) ==\n", hardwareThreadCount());
+    benchThreads(&arena, "test_data/it16862.tsp", 12000);
+    destroyScratchArena(&arena);
+    return 0;
+}
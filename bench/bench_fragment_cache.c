@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "fragment_cache.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+#define KEYS (1u << 20)
+#define KEY_LEN 10
+#define LEGACY_CAPACITY (1u << 21)
+
+//The cache main.c used to carry: FNV-1a byte at a time, linear probing with % on every step.
+typedef struct {
+    u64 hash;
+    u32 path[KEY_LEN];
+    u32 length;
+    f32 value;
+    bool used;
+} LegacyEntry;
+
+static u64 legacyHash(const u32* path, u32 len) {
+    const u8* p = (const u8*)path;
+    u64 hash = 14695981039346656037ULL;
+    for (u32 i = 0; i < len * sizeof(u32); ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void legacyInsert(LegacyEntry* table, const u32* path, u32 len, f32 value) {
+    u64 h = legacyHash(path, len);
+    u64 index = h % LEGACY_CAPACITY;
+    while (table[index].used) {
+        if (table[index].hash == h && table[index].length == len &&
+            memcmp(table[index].path, path, sizeof(u32) * len) == 0) return;
+        index = (index + 1) % LEGACY_CAPACITY;
+    }
+    table[index].hash = h;
+    table[index].length = len;
+    memcpy(table[index].path, path, sizeof(u32) * len);
+    table[index].value = value;
+    table[index].used = true;
+}
+
+static bool legacyLookup(const LegacyEntry* table, const u32* path, u32 len, f32* out) {
+    u64 h = legacyHash(path, len);
+    u64 index = h % LEGACY_CAPACITY;
+    while (table[index].used) {
+        if (table[index].hash == h && table[index].length == len &&
+            memcmp(table[index].path, path, sizeof(u32) * len) == 0) {
+            *out = table[index].value;
+            return true;
+        }
+        index = (index + 1) % LEGACY_CAPACITY;
+    }
+    return false;
+}
+
+//Window k of a 1M city tour: KEY_LEN consecutive ids starting at a scattered position.
+static void makeKey(u32 k, u32* key) {
+    u32 first = (k * 2654435761u) >> 12;
+    for (u32 i = 0; i < KEY_LEN; i++) key[i] = first + i;
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    u32 key[KEY_LEN];
+    f32 value, sum = 0.0f;
+    printf("== Fragment cache, %u windows of %u u32 cities, ns per operation ==\n", KEYS, KEY_LEN);
+
+    LegacyEntry* legacy = arenaScratchAlloc(&arena, sizeof(LegacyEntry) * LEGACY_CAPACITY, ALIGN_64);
+    memset(legacy, 0, sizeof(LegacyEntry) * LEGACY_CAPACITY);
+    u64 start = timerNowNs();
+    for (u32 k = 0; k < KEYS; k++) {
+        makeKey(k, key);
+        legacyInsert(legacy, key, KEY_LEN, (f32)k);
+    }
+    f64 insertNs = (f64)(timerNowNs() - start) / KEYS;
+    start = timerNowNs();
+    for (u32 k = 0; k < 2 * KEYS; k++) {
+        makeKey(k, key);
+        if (legacyLookup(legacy, key, KEY_LEN, &value)) sum += value;
+    }
+    f64 lookupNs = (f64)(timerNowNs() - start) / (2 * KEYS);
+    printf("fnv-1a + linear %%     insert %7.1f   lookup (half miss) %7.1f\n", insertNs, lookupNs);
+
+    FragmentCache cache = CreateFragmentCache(&arena, 1024, FRAGMENT_KEY_U32);
+    start = timerNowNs();
+    for (u32 k = 0; k < KEYS; k++) {
+        makeKey(k, key);
+        FragmentCacheInsert(&cache, key, KEY_LEN, (f32)k, key);
+    }
+    insertNs = (f64)(timerNowNs() - start) / KEYS;
+    start = timerNowNs();
+    for (u32 k = 0; k < 2 * KEYS; k++) {
+        makeKey(k, key);
+        if (FragmentCacheLookup(&cache, key, KEY_LEN, &value, NULL)) sum += value;
+    }
+    lookupNs = (f64)(timerNowNs() - start) / (2 * KEYS);
+    printf("swiss table, growing  insert %7.1f   lookup (half miss) %7.1f   grows %u  hit rate %.2f\n",
+           insertNs, lookupNs, cache.grows, FragmentCacheHitRate(&cache));
+
+    printf("(checksum %.0f)\n", sum);
+    destroyScratchArena(&arena);
+    return 0;
+}
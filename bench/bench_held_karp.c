@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "page_arena.h"
+#include "dist_kernels.h"
+#include "held_karp.h"
+#include "timer.h"
+
+#define BENCH_MAX_CITIES 20
+#define BENCH_WINDOWS 4
+
+static const char* levelName(DistSimdLevel level) {
+    switch (level) {
+        case DIST_SIMD_AVX2: return "avx2";
+        case DIST_SIMD_SSE2: return "sse2";
+        default:             return "scalar";
+    }
+}
+
+static u32 rng(u32* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+int main(void) {
+    memMap* map = initMemMap(HeldKarpBlockSize(BENCH_MAX_CITIES) + MiB(1));
+    PageArena* arena = createPageArena(map, HeldKarpBlockSize(BENCH_MAX_CITIES) + KiB(64));
+    HeldKarpSolver hk = CreateHeldKarpSolver(arena, BENCH_MAX_CITIES);
+    if (!hk.table) return 1;
+    DistSimdLevel top = hk.level;
+
+    static f32 dist[BENCH_MAX_CITIES * BENCH_MAX_CITIES];
+    u32 order[BENCH_MAX_CITIES];
+    printf("== Held-Karp open path, ms per solve (%u windows each) ==\n", BENCH_WINDOWS);
+    for (u32 count = 12; count <= BENCH_MAX_CITIES; count += 2) {
+        printf("%2u cities", count);
+        for (s32 level = DIST_SIMD_SCALAR; level <= (s32)top; level++) {
+            hk.level = (DistSimdLevel)level;
+            u32 state = count;
+            f64 check = 0.0;
+            u64 start = timerNowNs();
+            for (u32 w = 0; w < BENCH_WINDOWS; w++) {
+                for (u32 i = 0; i < count * count; i++) {
+                    dist[i] = (f32)(rng(&state) % 10000);
+                }
+                check += HeldKarpSolveDense(&hk, dist, count, HK_PATH, order);
+            }
+            f64 ms = timerElapsedMs(start) / BENCH_WINDOWS;
+            printf("   %-6s %9.3f (%.0f)", levelName((DistSimdLevel)level), ms, check);
+        }
+        printf("\n");
+    }
+    releasePages(map);
+    return 0;
+}
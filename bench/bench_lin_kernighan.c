@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "tour.h"
+#include "construct.h"
+#include "local_search.h"
+#include "lin_kernighan.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+#define NEIGHBOR_K 10
+
+static f64 tourLength(ScratchArena* arena, DistanceMatrix dm, const Tour* tour) {
+    u32* result = arenaScratchAlloc(arena, sizeof(u32) * tour->count, ALIGN_64);
+    TourToArray(tour, result);
+    return TourLength(dm, result, tour->count);
+}
+
+static void benchFile(ScratchArena* arena, const char* filename, f64 optimum, u32 kickRounds) {
+    resetScratchArena(arena);
+    u32 hw = hardwareThreadCount();
+    TspInstance inst = LoadTspInstanceParallel(arena, filename, hw);
+    DistanceMatrix dm = BuildDistanceMatrixParallel(arena, &inst, hw);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    CandidateLists lists = BuildCandidateLists(arena, (const Vec2*)inst.coords, inst.count, NEIGHBOR_K, hw);
+    u32* start = GreedyEdgeTour(arena, (const Vec2*)inst.coords, inst.count, &oracle, hw);
+    if (!dm.distances || !lists.neighbors || !start) {
+        printf("%-24s build failed\n", filename);
+        return;
+    }
+    printf("%-24s greedy %32s %5.2f%% over optimal\n", filename, "",
+           100.0 * (TourLength(dm, start, inst.count) / optimum - 1.0));
+
+    Tour tour = CreateTour(arena, TOUR_ARRAY, start, inst.count);
+    u64 t0 = timerNowNs();
+    LocalSearchStats stats = LinKernighan(arena, &tour, &oracle, &lists);
+    f64 ms = timerElapsedMs(t0);
+    printf("%-24s LK             %10.1f ms %8llu moves  %5.2f%% over optimal\n", filename, ms,
+           (unsigned long long)stats.moves, 100.0 * (tourLength(arena, dm, &tour) / optimum - 1.0));
+
+    for (u32 r = 1; r <= kickRounds; r *= 4) {
+        tour = CreateTour(arena, TOUR_ARRAY, start, inst.count);
+        u32 kicks = r * inst.count;
+        t0 = timerNowNs();
+        stats = IteratedLinKernighan(arena, &tour, &oracle, &lists, kicks, 1);
+        ms = timerElapsedMs(t0);
+        printf("%-24s ILK %7u kicks %10.1f ms %8llu moves  %5.2f%% over optimal\n", filename, kicks, ms,
+               (unsigned long long)stats.moves, 100.0 * (tourLength(arena, dm, &tour) / optimum - 1.0));
+    }
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== Lin-Kernighan and iterated LK from greedy, k=%u candidates ==\n", NEIGHBOR_K);
+    benchFile(&arena, "test_data/ca4663.tsp", 1290319.0, 4);
+    benchFile(&arena, "test_data/it16862.tsp", 557315.0, 4);
+    destroyScratchArena(&arena);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(64)
+#define ITERATIONS 10
+
+static const char* files[] = {
+    "test_data/ca4663.tsp",
+    "test_data/it16862.tsp"
+};
+
+static f64 benchLegacy(ScratchArena* arena, const char* filename) {
+    f64 best = 1e30;
+    for (u32 it = 0; it < ITERATIONS; it++) {
+        resetScratchArena(arena);
+        u64 start = timerNowNs();
+        u32 count = CountDataSize(filename);
+        Vec2* coords = LoadDistances(arena, filename, count);
+        f64 ms = timerElapsedMs(start);
+        if (!coords) return -1.0;
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+static f64 benchMapped(ScratchArena* arena, const char* filename, u32 threadCount) {
+    f64 best = 1e30;
+    for (u32 it = 0; it < ITERATIONS; it++) {
+        resetScratchArena(arena);
+        u64 start = timerNowNs();
+        TspInstance inst = (threadCount == 1) ? LoadTspInstance(arena, filename)
+                                              : LoadTspInstanceParallel(arena, filename, threadCount);
+        f64 ms = timerElapsedMs(start);
+        if (!inst.coords) return -1.0;
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== TSPLIB load: fgets/sscanf x2 vs mmap single pass (best of %d) ==\n", ITERATIONS);
+    for (u32 f = 0; f < ARRAY_COUNT(files); f++) {
+        f64 legacy = benchLegacy(&arena, files[f]);
+        f64 mapped = benchMapped(&arena, files[f], 1);
+        printf("%-24s legacy %8.3f ms   mapped %8.3f ms   speedup %5.2fx\n",
+               files[f], legacy, mapped, legacy / mapped);
+    }
+
+    u32 hw = hardwareThreadCount();
+    u32 threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+    printf("== Parallel chunked parse (best of %d, %u hardware threads) ==\n", ITERATIONS, hw);
+    for (u32 f = 0; f < ARRAY_COUNT(files); f++) {
+        f64 serial = benchMapped(&arena, files[f], 1);
+        for (u32 t = 0; t < ARRAY_COUNT(threadCounts) && threadCounts[t] <= hw * 2; t++) {
+            f64 ms = benchMapped(&arena, files[f], threadCounts[t]);
+            printf("%-24s threads %2u %8.3f ms   scaling %5.2fx\n", files[f], threadCounts[t], ms, serial / ms);
+        }
+    }
+    destroyScratchArena(&arena);
+    return 0;
+}
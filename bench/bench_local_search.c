@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "tour.h"
+#include "construct.h"
+#include "local_search.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+#define NEIGHBOR_K 16
+
+static void benchFile(ScratchArena* arena, const char* filename, f64 optimum) {
+    resetScratchArena(arena);
+    u32 hw = hardwareThreadCount();
+    TspInstance inst = LoadTspInstanceParallel(arena, filename, hw);
+    DistanceMatrix dm = BuildDistanceMatrixParallel(arena, &inst, hw);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    CandidateLists lists = BuildCandidateLists(arena, (const Vec2*)inst.coords, inst.count, NEIGHBOR_K, hw);
+    if (!dm.distances || !lists.neighbors) {
+        printf("%-24s build failed\n", filename);
+        return;
+    }
+    for (u32 m = 0; m < CONSTRUCT_METHOD_COUNT; m++) {
+        u32* start = ConstructTour(arena, (ConstructMethod)m, (const Vec2*)inst.coords, inst.count, &oracle, hw);
+        if (!start) {
+            printf("%-24s %-20s failed\n", filename, ConstructMethodName((ConstructMethod)m));
+            continue;
+        }
+        f64 before = TourLength(dm, start, inst.count);
+        for (u32 v = 0; v < 2; v++) {
+            LocalSearchMove moves = (v == 0) ? LS_MOVE_2OPT : LS_MOVE_OR2OPT;
+            Tour tour = CreateTour(arena, TOUR_ARRAY, start, inst.count);
+            u64 t0 = timerNowNs();
+            LocalSearchStats stats = LocalSearch(arena, &tour, &oracle, &lists, moves);
+            f64 ms = timerElapsedMs(t0);
+            u32* result = arenaScratchAlloc(arena, sizeof(u32) * inst.count, ALIGN_64);
+            TourToArray(&tour, result);
+            f64 after = TourLength(dm, result, inst.count);
+            printf("%-24s %-20s %-7s %9.3f ms  %8llu moves  %5.2f%% -> %5.2f%% over optimal\n", filename,
+                   ConstructMethodName((ConstructMethod)m), (v == 0) ? "2-opt" : "or-2opt", ms,
+                   (unsigned long long)stats.moves, 100.0 * (before / optimum - 1.0), 100.0 * (after / optimum - 1.0));
+        }
+    }
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== 2-opt vs 2-opt + Or-opt with k=%u candidate lists and don't-look bits ==\n", NEIGHBOR_K);
+    benchFile(&arena, "test_data/ca4663.tsp", 1290319.0);
+    benchFile(&arena, "test_data/it16862.tsp", 557315.0);
+    destroyScratchArena(&arena);
+    return 0;
+}
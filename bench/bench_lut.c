@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "construct.h"
+#include "lut.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(256)
+
+//Every tour window of len cities on ca4663, solved into a LUT with 1 and all hardware threads.
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    u32 hw = hardwareThreadCount();
+    TspInstance inst = LoadTspInstanceParallel(&arena, "test_data/ca4663.tsp", hw);
+    DistanceMatrix dm = BuildDistanceMatrixParallel(&arena, &inst, hw);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    u32* tour = GreedyEdgeTour(&arena, (const Vec2*)inst.coords, inst.count, &oracle, hw);
+    if (!dm.distances || !tour) {
+        printf("setup failed\n");
+        return 1;
+    }
+    u32 n = inst.count;
+    u16* fragments = arenaScratchAlloc(&arena, sizeof(u16) * LUT_MAX_FRAGMENT * (usize)n, ALIGN_64);
+    u16* lens = arenaScratchAlloc(&arena, sizeof(u16) * (usize)n, ALIGN_64);
+    printf("== LUT bulk build over %u ca4663 tour windows, %u hardware threads ==\n", n, hw);
+
+    for (u16 len = 6; len <= LUT_MAX_FRAGMENT; len += 3) {
+        for (u32 p = 0; p < n; p++) {
+            for (u32 k = 0; k < len; k++) fragments[(usize)p * LUT_MAX_FRAGMENT + k] = (u16)tour[(p + k) % n];
+            lens[p] = len;
+        }
+        u32 threads[2] = { 1, hw };
+        for (u32 t = 0; t < ((hw > 1) ? 2u : 1u); t++) {
+            memMap* map = initMemMap(MiB(64));
+            PageArena* pages = createPageArena(map, sizeof(LutRecord) * (usize)n + LutBuildBlockSize(threads[t]) + MiB(1));
+            LutTable lut = CreateLutTable(pages, n);
+            u64 start = timerNowNs();
+            LutBuild(&lut, pages, dm, fragments, LUT_MAX_FRAGMENT, lens, n, threads[t]);
+            f64 ms = timerElapsedMs(start);
+            f64 gain = 0.0;
+            for (u32 p = 0; p < n; p++) {
+                const u16* f = fragments + (usize)p * LUT_MAX_FRAGMENT;
+                f64 before = 0.0;
+                for (u32 k = 0; k + 1 < len; k++) before += dm.distances[DM_INDEX(dm, f[k], f[k + 1])];
+                gain += before - lut.records[p].cost;
+            }
+            printf("len %2u  %3u threads  %8.2f ms  %8.1f K records/s  summed window gain %.0f\n",
+                   len, threads[t], ms, n / ms, gain);
+            releasePages(map);
+        }
+    }
+    destroyScratchArena(&arena);
+    return 0;
+}
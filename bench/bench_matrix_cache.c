@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "matrix_cache.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+
+static void benchFile(ScratchArena* arena, const char* filename, const char* cachePath) {
+    u32 hw = hardwareThreadCount();
+    remove(cachePath);
+
+    resetScratchArena(arena);
+    u64 start = timerNowNs();
+    CachedMatrix built = LoadOrBuildMatrix(arena, filename, cachePath, hw, true);
+    f64 buildMs = timerElapsedMs(start);
+    if (!built.dm.distances) {
+        printf("%-24s build failed\n", filename);
+        return;
+    }
+
+    start = timerNowNs();
+    CachedMatrix fast = LoadOrBuildMatrix(arena, filename, cachePath, hw, false);
+    f64 mapMs = timerElapsedMs(start);
+    UnmapMatrixCache(&fast);
+
+    start = timerNowNs();
+    CachedMatrix verified = LoadOrBuildMatrix(arena, filename, cachePath, hw, true);
+    f64 verifyMs = timerElapsedMs(start);
+    UnmapMatrixCache(&verified);
+
+    printf("%-24s %6u cities  build+write %9.3f ms   map %7.3f ms   map+checksum %8.3f ms\n",
+           filename, built.count, buildMs, mapMs, verifyMs);
+    remove(cachePath);
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== Distance matrix startup: build from text vs mapped cache (%u threads) ==\n", hardwareThreadCount());
+    benchFile(&arena, "test_data/ca4663.tsp", "build/bench/ca4663.dmc");
+    benchFile(&arena, "test_data/it16862.tsp", "build/bench/it16862.dmc");
+    destroyScratchArena(&arena);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "quant_matrix.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+#define LOOKUPS 20000000u
+
+static inline u32 nextRandom(u32* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static void benchFile(ScratchArena* arena, const char* filename) {
+    resetScratchArena(arena);
+    TspInstance inst = LoadTspInstance(arena, filename);
+    DistanceMatrix dm = BuildDistanceMatrix(arena, &inst);
+    QuantMatrix qm = BuildQuantMatrix(arena, &inst, 0);
+    if (!dm.distances || qm.width == QUANT_NONE) {
+        printf("%-24s build failed\n", filename);
+        return;
+    }
+
+    u32 state = 1;
+    f64 floatSum = 0.0;
+    u64 start = timerNowNs();
+    for (u32 k = 0; k < LOOKUPS; k++) {
+        u32 i = nextRandom(&state) % inst.count, j = nextRandom(&state) % inst.count;
+        if (i != j) floatSum += dm.distances[DM_INDEX(dm, i, j)];
+    }
+    f64 floatMs = timerElapsedMs(start);
+
+    state = 1;
+    u64 quantSum = 0;
+    start = timerNowNs();
+    for (u32 k = 0; k < LOOKUPS; k++) {
+        u32 i = nextRandom(&state) % inst.count, j = nextRandom(&state) % inst.count;
+        quantSum += QuantDistance(&qm, i, j);
+    }
+    f64 quantMs = timerElapsedMs(start);
+
+    u32* tour = arenaScratchAlloc(arena, sizeof(u32) * inst.count, ALIGN_64);
+    for (u32 i = 0; i < inst.count; i++) tour[i] = i;
+    start = timerNowNs();
+    u64 cost = QuantTourCost(&qm, tour, inst.count);
+    f64 tourMs = timerElapsedMs(start);
+
+    printf("%-24s u%-2d %7.1f MiB vs %7.1f MiB   random f32 %8.3f ms  quant %8.3f ms   identity tour %llu (%.3f ms)%s\n",
+           filename, qm.width * 8, PackedMatrixSize(inst.count) * (f64)qm.width / MiB(1),
+           PackedMatrixSize(inst.count) * (f64)sizeof(f32) / MiB(1), floatMs, quantMs,
+           (unsigned long long)cost, tourMs, ((u64)floatSum == quantSum) ? "" : "  SUM MISMATCH");
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== Quantized vs f32 distance matrix, %u random lookups ==\n", LOOKUPS);
+    benchFile(&arena, "test_data/ca4663.tsp");
+    benchFile(&arena, "test_data/it16862.tsp");
+    destroyScratchArena(&arena);
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "tiled_matrix.h"
+#include "hilbert.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1536)
+#define RANDOM_LOOKUPS 20000000u
+#define NEIGHBOR_K 10
+#define NEIGHBOR_PASSES 20
+#define WINDOW 8
+
+static inline u32 nextRandom(u32* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+typedef struct {
+    f64 randomMs;
+    f64 neighborMs;
+    f64 windowMs;
+    f64 checksum;
+} AccessTimes;
+
+//The three patterns run against a lookup macro so both layouts execute identical loops.
+#define RUN_PATTERNS(times, count, lists, LOOKUP)                                   \
+    do {                                                                            \
+        u32 state = 7;                                                              \
+        f64 sum = 0.0;                                                              \
+        u64 start = timerNowNs();                                                   \
+        for (u32 q = 0; q < RANDOM_LOOKUPS; q++) {                                  \
+            u32 i = nextRandom(&state) % (count), j = nextRandom(&state) % (count); \
+            if (i != j) sum += LOOKUP(i, j);                                        \
+        }                                                                           \
+        (times).randomMs = timerElapsedMs(start);                                   \
+        start = timerNowNs();                                                       \
+        for (u32 p = 0; p < NEIGHBOR_PASSES; p++) {                                 \
+            for (u32 i = 0; i < (count); i++) {                                     \
+                const u32* cand = CandidatesOf(&(lists), i);                        \
+                for (u32 s = 0; s < (lists).k; s++) sum += LOOKUP(i, cand[s]);      \
+            }                                                                       \
+        }                                                                           \
+        (times).neighborMs = timerElapsedMs(start);                                 \
+        start = timerNowNs();                                                       \
+        for (u32 p = 0; p < NEIGHBOR_PASSES; p++) {                                 \
+            for (u32 i = 0; i + WINDOW < (count); i++) {                            \
+                for (u32 w = 1; w <= WINDOW; w++) sum += LOOKUP(i, i + w);          \
+            }                                                                       \
+        }                                                                           \
+        (times).windowMs = timerElapsedMs(start);                                   \
+        (times).checksum = sum;                                                     \
+    } while (0)
+
+static void benchFile(ScratchArena* arena, const char* filename, bool hilbert) {
+    resetScratchArena(arena);
+    CityPermutation perm;
+    TspInstance inst = hilbert ? LoadTspInstanceHilbert(arena, filename, 0, &perm) : LoadTspInstance(arena, filename);
+    DistanceMatrix dm = BuildDistanceMatrix(arena, &inst);
+    TiledMatrix tm = BuildTiledMatrix(arena, &inst, 0);
+    CandidateLists lists = BuildCandidateLists(arena, (const Vec2*)inst.coords, inst.count, NEIGHBOR_K, 0);
+    if (!dm.distances || !tm.tiles || !lists.neighbors) {
+        printf("%-24s build failed\n", filename);
+        return;
+    }
+
+    AccessTimes rows, tiles;
+#define ROW_LOOKUP(i, j) dm.distances[DM_INDEX(dm, (i), (j))]
+#define TILE_LOOKUP(i, j) TiledDistance(&tm, (i), (j))
+    RUN_PATTERNS(rows, inst.count, lists, ROW_LOOKUP);
+    RUN_PATTERNS(tiles, inst.count, lists, TILE_LOOKUP);
+#undef ROW_LOOKUP
+#undef TILE_LOOKUP
+
+    printf("%-24s %-8s random   rows %8.3f ms  tiles %8.3f ms\n", filename, hilbert ? "hilbert" : "file",
+           rows.randomMs, tiles.randomMs);
+    printf("%-33s k=%-2d nn  rows %8.3f ms  tiles %8.3f ms\n", "", NEIGHBOR_K, rows.neighborMs, tiles.neighborMs);
+    printf("%-33s window   rows %8.3f ms  tiles %8.3f ms%s\n", "", rows.windowMs, tiles.windowMs,
+           (rows.checksum == tiles.checksum) ? "" : "  CHECKSUM MISMATCH");
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    printf("== Row (DM_INDEX) vs %ux%u tiled layout: random pairs, k-nearest lists, id windows of %u, file vs Hilbert ids ==\n",
+           TILE_DIM, TILE_DIM, WINDOW);
+    benchFile(&arena, "test_data/ca4663.tsp", false);
+    benchFile(&arena, "test_data/ca4663.tsp", true);
+    benchFile(&arena, "test_data/it16862.tsp", false);
+    benchFile(&arena, "test_data/it16862.tsp", true);
+    destroyScratchArena(&arena);
+    return 0;
+}
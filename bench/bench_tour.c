@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "tour.h"
+#include "construct.h"
+#include "local_search.h"
+#include "lin_kernighan.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+#define LOCAL_SPAN 50
+#define REVERSALS 200000u
+#define TRAVERSALS 20u
+#define NEIGHBOR_K 10
+
+static inline u32 nextRandom(u32* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+//ns per reversal of a random path. span 0: both ends uniform, so the array side averages n/4
+//swaps. Otherwise to is at most span steps past from, like the flips of local search.
+static f64 reversalNs(ScratchArena* arena, TourKind kind, const u32* order, u32 n, u32 span) {
+    Tour tour = CreateTour(arena, kind, order, n);
+    u32 state = 11;
+    u64 start = timerNowNs();
+    for (u32 r = 0; r < REVERSALS; r++) {
+        u32 from = nextRandom(&state) % n, to = from;
+        if (span == 0) {
+            to = nextRandom(&state) % n;
+        } else {
+            for (u32 s = nextRandom(&state) % span; s > 0; s--) to = TourNext(&tour, to);
+        }
+        TourReverse(&tour, from, to);
+    }
+    return (f64)(timerNowNs() - start) / REVERSALS;
+}
+
+//ns per TourNext over full walks of the tour after it has been scrambled by reversals.
+static f64 walkNs(ScratchArena* arena, TourKind kind, const u32* order, u32 n, u32* checksum) {
+    Tour tour = CreateTour(arena, kind, order, n);
+    u32 state = 3;
+    for (u32 r = 0; r < 1000; r++) {
+        TourReverse(&tour, nextRandom(&state) % n, nextRandom(&state) % n);
+    }
+    u32 city = 0, sum = 0;
+    u64 start = timerNowNs();
+    for (u32 t = 0; t < TRAVERSALS; t++) {
+        for (u32 k = 0; k < n; k++) {
+            city = TourNext(&tour, city);
+            sum += city;
+        }
+    }
+    *checksum += sum;
+    return (f64)(timerNowNs() - start) / ((f64)TRAVERSALS * n);
+}
+
+static void benchCrossover(ScratchArena* arena) {
+    printf("== Array vs two-level tour, ns per reversal (random ends, local <= %u steps) and per next ==\n", LOCAL_SPAN);
+    u32 sizes[] = { 100, 300, 1000, 3000, 10000, 30000, 100000, 300000 };
+    u32 checksum = 0;
+    for (u32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        resetScratchArena(arena);
+        u32 n = sizes[s];
+        u32* order = arenaScratchAlloc(arena, sizeof(u32) * n, ALIGN_64);
+        for (u32 i = 0; i < n; i++) order[i] = i;
+        f64 arrayRev = reversalNs(arena, TOUR_ARRAY, order, n, 0);
+        f64 twoRev = reversalNs(arena, TOUR_TWO_LEVEL, order, n, 0);
+        f64 arrayLocal = reversalNs(arena, TOUR_ARRAY, order, n, LOCAL_SPAN);
+        f64 twoLocal = reversalNs(arena, TOUR_TWO_LEVEL, order, n, LOCAL_SPAN);
+        f64 arrayWalk = walkNs(arena, TOUR_ARRAY, order, n, &checksum);
+        f64 twoWalk = walkNs(arena, TOUR_TWO_LEVEL, order, n, &checksum);
+        printf("n=%-7u reverse  array %9.1f  two-level %7.1f   local  array %6.1f  two-level %6.1f"
+               "   next  array %5.2f  two-level %5.2f ns\n", n, arrayRev, twoRev, arrayLocal, twoLocal,
+               arrayWalk, twoWalk);
+    }
+    printf("(checksum %u)\n", checksum);
+}
+
+static void benchLk(ScratchArena* arena, const char* filename, f64 optimum) {
+    resetScratchArena(arena);
+    u32 hw = hardwareThreadCount();
+    TspInstance inst = LoadTspInstanceParallel(arena, filename, hw);
+    DistanceMatrix dm = BuildDistanceMatrixParallel(arena, &inst, hw);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    CandidateLists lists = BuildCandidateLists(arena, (const Vec2*)inst.coords, inst.count, NEIGHBOR_K, hw);
+    u32* start = GreedyEdgeTour(arena, (const Vec2*)inst.coords, inst.count, &oracle, hw);
+    if (!dm.distances || !lists.neighbors || !start) {
+        printf("%-24s build failed\n", filename);
+        return;
+    }
+    u32* result = arenaScratchAlloc(arena, sizeof(u32) * inst.count, ALIGN_64);
+    for (u32 kind = TOUR_ARRAY; kind <= TOUR_TWO_LEVEL; kind++) {
+        Tour tour = CreateTour(arena, (TourKind)kind, start, inst.count);
+        u64 t0 = timerNowNs();
+        IteratedLinKernighan(arena, &tour, &oracle, &lists, inst.count, 1);
+        f64 ms = timerElapsedMs(t0);
+        TourToArray(&tour, result);
+        printf("%-24s ILK n kicks  %-9s %10.1f ms  %5.2f%% over optimal\n", filename,
+               (kind == TOUR_ARRAY) ? "array" : "two-level", ms,
+               100.0 * (TourLength(dm, result, inst.count) / optimum - 1.0));
+    }
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    benchCrossover(&arena);
+    benchLk(&arena, "test_data/ca4663.tsp", 1290319.0);
+    benchLk(&arena, "test_data/it16862.tsp", 557315.0);
+    destroyScratchArena(&arena);
+    return 0;
+}
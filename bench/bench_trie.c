@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <string.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "construct.h"
+#include "trie.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(256)
+#define TRIE_ARENA_SIZE MiB(1024)
+#define WINDOW_LEN 8
+#define CANDIDATES 8
+#define LOOKUP_ROUNDS 5
+
+//The trie as it was: every child insert allocates a fresh array one entry larger.
+typedef struct LegacyNode {
+    struct LegacyChild* children;
+    memptr lutPtr;
+    u16 label;
+    u16 childCount;
+    u8 isTerminal;
+} LegacyNode;
+
+typedef struct LegacyChild {
+    u16 label;
+    LegacyNode* child;
+} LegacyChild;
+
+static LegacyNode* legacySearchChild(LegacyNode* node, u16 label) {
+    u16 left = 0, right = node->childCount;
+    while (left < right) {
+        u16 mid = left + (right - left) / 2;
+        if (node->children[mid].label == label) return node->children[mid].child;
+        if (node->children[mid].label < label) left = mid + 1;
+        else right = mid;
+    }
+    return NULL;
+}
+
+static void legacyInsertChild(PageArena* arena, LegacyNode* node, u16 label, LegacyNode* child) {
+    LegacyChild* newChildren = arenaPageAlloc(arena, sizeof(LegacyChild) * (node->childCount + 1), ALIGN_8);
+    u16 i = 0, j = 0;
+    while (i < node->childCount && node->children[i].label < label) newChildren[j++] = node->children[i++];
+    newChildren[j++] = (LegacyChild){ .label = label, .child = child };
+    while (i < node->childCount) newChildren[j++] = node->children[i++];
+    node->children = newChildren;
+    node->childCount += 1;
+}
+
+static void legacyInsert(PageArena* arena, LegacyNode* root, const u16* path, u16 pathLen) {
+    LegacyNode* node = root;
+    for (u16 i = 0; i < pathLen; ++i) {
+        LegacyNode* next = legacySearchChild(node, path[i]);
+        if (!next) {
+            next = arenaPageAlloc(arena, sizeof(LegacyNode), ALIGN_8);
+            *next = (LegacyNode){ .children = NULL, .lutPtr = NULL, .label = path[i], .childCount = 0, .isTerminal = 0 };
+            legacyInsertChild(arena, node, path[i], next);
+        }
+        node = next;
+    }
+    node->isTerminal = 1;
+}
+
+//Fragments of ca4663: every candidate chain c -> a -> b, then every window of the greedy tour.
+static u16* collectFragments(ScratchArena* arena, u32* outCount, u16** outLens) {
+    TspInstance inst = LoadTspInstance(arena, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(arena, &inst);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    CandidateLists lists = BuildCandidateLists(arena, (const Vec2*)inst.coords, inst.count, CANDIDATES, 1);
+    u32* tour = GreedyEdgeTour(arena, (const Vec2*)inst.coords, inst.count, &oracle, 1);
+    u32 n = inst.count;
+    u32 total = n * CANDIDATES * CANDIDATES + n;
+    u16* fragments = arenaScratchAlloc(arena, sizeof(u16) * WINDOW_LEN * (usize)total, ALIGN_64);
+    u16* lens = arenaScratchAlloc(arena, sizeof(u16) * (usize)total, ALIGN_64);
+    u32 m = 0;
+    for (u32 c = 0; c < n; c++) {
+        const u32* ca = CandidatesOf(&lists, c);
+        for (u32 s = 0; s < lists.k; s++) {
+            const u32* cb = CandidatesOf(&lists, ca[s]);
+            for (u32 t = 0; t < lists.k; t++) {
+                if (cb[t] == c) continue;
+                u16* f = fragments + (usize)m * WINDOW_LEN;
+                f[0] = (u16)c; f[1] = (u16)ca[s]; f[2] = (u16)cb[t];
+                lens[m++] = 3;
+            }
+        }
+    }
+    for (u32 p = 0; p < n; p++) {
+        u16* f = fragments + (usize)m * WINDOW_LEN;
+        for (u32 i = 0; i < WINDOW_LEN; i++) f[i] = (u16)tour[(p + i) % n];
+        lens[m++] = WINDOW_LEN;
+    }
+    *outCount = m;
+    *outLens = lens;
+    return fragments;
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    u16* lens = NULL;
+    u32 count = 0;
+    u16* fragments = collectFragments(&arena, &count, &lens);
+    printf("== Trie build over %u ca4663 fragments ==\n", count);
+
+    memMap* map = initMemMap(TRIE_ARENA_SIZE + MiB(4));
+    PageArena* pages = createPageArena(map, TRIE_ARENA_SIZE);
+    LegacyNode legacyRoot = { .children = NULL, .lutPtr = NULL, .label = 0, .childCount = 0, .isTerminal = 0 };
+    u64 start = timerNowNs();
+    for (u32 f = 0; f < count; f++) {
+        legacyInsert(pages, &legacyRoot, fragments + (usize)f * WINDOW_LEN, lens[f]);
+    }
+    f64 ms = timerElapsedMs(start);
+    printf("array per insert      %8.2f MiB   %7.2f M inserts/s\n", (f64)pages->offset / MiB(1), count / ms / 1000.0);
+    releasePages(map);
+
+    //Same build with reader slots: mid-array inserts copy and retire instead of shifting in place.
+    map = initMemMap(TRIE_ARENA_SIZE + MiB(4));
+    pages = createPageArena(map, TRIE_ARENA_SIZE);
+    TrieAllocator shared = createConcurrentTrieAllocator(pages);
+    TrieNode* sharedRoot = createTrieNode(&shared, 0);
+    start = timerNowNs();
+    for (u32 f = 0; f < count; f++) {
+        insertTrie(&shared, sharedRoot, fragments + (usize)f * WINDOW_LEN, lens[f], LUT_NONE);
+    }
+    ms = timerElapsedMs(start);
+    printf("copy on write + epoch %8.2f MiB   %7.2f M inserts/s   arrays retired %llu\n",
+           (f64)pages->offset / MiB(1), count / ms / 1000.0, (unsigned long long)shared.arraysRetired);
+    releasePages(map);
+
+    map = initMemMap(TRIE_ARENA_SIZE + MiB(4));
+    pages = createPageArena(map, TRIE_ARENA_SIZE);
+    TrieAllocator alloc = createTrieAllocator(pages);
+    TrieNode* root = createTrieNode(&alloc, 0);
+    start = timerNowNs();
+    for (u32 f = 0; f < count; f++) {
+        insertTrie(&alloc, root, fragments + (usize)f * WINDOW_LEN, lens[f], LUT_NONE);
+    }
+    ms = timerElapsedMs(start);
+    printf("doubling + free lists %8.2f MiB   %7.2f M inserts/s   arrays reused %llu\n",
+           (f64)pages->offset / MiB(1), count / ms / 1000.0, (unsigned long long)alloc.arraysReused);
+
+    usize before = pages->offset;
+    start = timerNowNs();
+    FrozenTrie frozen = freezeTrie(pages, &alloc, root);
+    ms = timerElapsedMs(start);
+    printf("freeze                %8.2f MiB   %7.2f ms for %u nodes\n",
+           (f64)(pages->offset - before) / MiB(1), ms, frozen.nodeCount);
+
+    //Lookups in shuffled order so consecutive searches do not walk the same warm path.
+    u32* order = arenaScratchAlloc(&arena, sizeof(u32) * (usize)count, ALIGN_64);
+    u16* shuffled = arenaScratchAlloc(&arena, sizeof(u16) * WINDOW_LEN * (usize)count, ALIGN_64);
+    u16* shuffledLens = arenaScratchAlloc(&arena, sizeof(u16) * (usize)count, ALIGN_64);
+    u32* results = arenaScratchAlloc(&arena, sizeof(u32) * (usize)count, ALIGN_64);
+    u32 state = 12345;
+    for (u32 f = 0; f < count; f++) order[f] = f;
+    for (u32 f = count - 1; f > 0; f--) {
+        state = state * 1664525u + 1013904223u;
+        u32 g = (state >> 8) % (f + 1);
+        u32 t = order[f]; order[f] = order[g]; order[g] = t;
+    }
+    for (u32 f = 0; f < count; f++) {
+        memcpy(shuffled + (usize)f * WINDOW_LEN, fragments + (usize)order[f] * WINDOW_LEN, sizeof(u16) * WINDOW_LEN);
+        shuffledLens[f] = lens[order[f]];
+    }
+
+    u64 found = 0;
+    start = timerNowNs();
+    for (u32 r = 0; r < LOOKUP_ROUNDS; r++) {
+        for (u32 f = 0; f < count; f++) {
+            found += searchTrie(root, shuffled + (usize)f * WINDOW_LEN, shuffledLens[f]) != NULL;
+        }
+    }
+    ms = timerElapsedMs(start);
+    printf("pointer lookup        %7.2f M lookups/s   hits %llu\n", (f64)count * LOOKUP_ROUNDS / ms / 1000.0,
+           (unsigned long long)found);
+
+    found = 0;
+    start = timerNowNs();
+    for (u32 r = 0; r < LOOKUP_ROUNDS; r++) {
+        for (u32 f = 0; f < count; f++) {
+            found += searchFrozenTrie(&frozen, shuffled + (usize)f * WINDOW_LEN, shuffledLens[f]) != FROZEN_MISS;
+        }
+    }
+    ms = timerElapsedMs(start);
+    printf("frozen lookup         %7.2f M lookups/s   hits %llu\n", (f64)count * LOOKUP_ROUNDS / ms / 1000.0,
+           (unsigned long long)found);
+
+    found = 0;
+    start = timerNowNs();
+    for (u32 r = 0; r < LOOKUP_ROUNDS; r++) {
+        searchFrozenTrieBatch(&frozen, shuffled, WINDOW_LEN, shuffledLens, count, results);
+        for (u32 f = 0; f < count; f++) found += results[f] != FROZEN_MISS;
+    }
+    ms = timerElapsedMs(start);
+    printf("frozen batched x%-2u    %7.2f M lookups/s   hits %llu\n", FROZEN_BATCH,
+           (f64)count * LOOKUP_ROUNDS / ms / 1000.0, (unsigned long long)found);
+    releasePages(map);
+    destroyScratchArena(&arena);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <string.h>
+#include "common_types.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "tour.h"
+#include "construct.h"
+#include "local_search.h"
+#include "window_opt.h"
+#include "thread_pool.h"
+#include "timer.h"
+
+#define ARENA_SIZE MiB(1024)
+
+static void benchFile(ScratchArena* arena, memMap* map, const char* filename, f64 optimum) {
+    resetScratchArena(arena);
+    u32 hw = hardwareThreadCount();
+    TspInstance inst = LoadTspInstanceParallel(arena, filename, hw);
+    DistanceMatrix dm = BuildDistanceMatrixParallel(arena, &inst, hw);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    CandidateLists lists = BuildCandidateLists(arena, (const Vec2*)inst.coords, inst.count, 16, hw);
+    u32* greedy = GreedyEdgeTour(arena, (const Vec2*)inst.coords, inst.count, &oracle, hw);
+    if (!dm.distances || !lists.neighbors || !greedy) {
+        printf("%-24s setup failed\n", filename);
+        return;
+    }
+    Tour tour = CreateTour(arena, TOUR_ARRAY, greedy, inst.count);
+    Or2Opt(arena, &tour, &oracle, &lists);
+    u32* start = arenaScratchAlloc(arena, sizeof(u32) * inst.count, ALIGN_64);
+    u32* work = arenaScratchAlloc(arena, sizeof(u32) * inst.count, ALIGN_64);
+    TourToArray(&tour, start);
+    f64 base = TourLength(dm, start, inst.count);
+    printf("%-24s or-2opt start     %6.2f%% over optimal\n", filename, 100.0 * (base - optimum) / optimum);
+
+    for (u32 window = 8; window <= 16; window += 4) {
+        memcpy(work, start, sizeof(u32) * inst.count);
+        PageArena* pages = createPageArena(map, WindowOptBlockSize(inst.count, window, hw));
+        u64 begin = timerNowNs();
+        WindowOptStats stats = WindowOptimize(pages, work, inst.count, dm, window, NULL, hw);
+        f64 ms = timerElapsedMs(begin);
+        arenaPagePop(map);
+        f64 length = TourLength(dm, work, inst.count);
+        printf("%-24s window %2u     %10.1f ms   %6.2f%%   rounds %2u  windows %7u  improved %5u\n",
+               filename, window, ms, 100.0 * (length - optimum) / optimum, stats.rounds, stats.windows,
+               stats.improved);
+    }
+}
+
+int main(void) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    memMap* map = initMemMap(MiB(256));
+    printf("== Sliding-window Held-Karp after Or-2opt (%u threads) ==\n", hardwareThreadCount());
+    benchFile(&arena, map, "test_data/ca4663.tsp", 1290319.0);
+    benchFile(&arena, map, "test_data/it16862.tsp", 557315.0);
+    releasePages(map);
+    destroyScratchArena(&arena);
+    return 0;
+}
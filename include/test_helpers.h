@@ -0,0 +1,45 @@
+#ifndef _test_helpers_h
+#define _test_helpers_h
+
+#include "common_types.h"
+#include "thread_pool.h"
+
+//LCG for reproducible test inputs, returning the top 24 bits of the state.
+static inline u32 rng(u32* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+//Per-worker tallies of a stress run. Each worker only touches its own, so they need no atomics.
+typedef struct {
+    u32 count;                  //operations that did work: hits, searches, arenas created
+    u32 errors;
+} StressCounters;
+
+typedef void (*StressTask)(memptr ctx, u32 threadIndex, StressCounters* counters);
+
+typedef struct {
+    StressTask task;
+    memptr ctx;
+    StressCounters counters[THREAD_POOL_MAX_THREADS];
+} StressRun;
+
+static inline void stressWorker(memptr ctx, u32 threadIndex, u32 threadCount) {
+    (void)threadCount;
+    StressRun* run = (StressRun*)ctx;
+    run->task(run->ctx, threadIndex, &run->counters[threadIndex]);
+}
+
+//Runs task on threadCount threads through runThreadPool and returns the summed counters.
+static inline StressCounters runStress(u32 threadCount, StressTask task, memptr ctx) {
+    StressRun run = { .task = task, .ctx = ctx, .counters = { { 0, 0 } } };
+    runThreadPool(threadCount, stressWorker, &run);
+    StressCounters total = { 0, 0 };
+    for (u32 t = 0; t < threadCount && t < THREAD_POOL_MAX_THREADS; t++) {
+        total.count += run.counters[t].count;
+        total.errors += run.counters[t].errors;
+    }
+    return total;
+}
+
+#endif
@@ -8,7 +8,7 @@ DEBUG_FLAGS="-fsanitize=address -g -O0 -Wall -Werror"
 NO_OPT_FLAGS="-O0 -g -fno-omit-frame-pointer -fno-optimize-sibling-calls"
 LIGHT_DBG_FLAGS="-g -O0 -Wall -Werror -fno-optimize-sibling-calls -fno-omit-frame-pointer"
 CFLAGS=$LIGHT_DBG_FLAGS
-INCLUDE_FLAGS="-Iinclude -Isrc -Isrc/tsp -Isrc/memory"
+INCLUDE_FLAGS="-Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread"
 TEST_ONLY=false
 
 #for arg in "$@"; do
@@ -45,12 +45,31 @@ echo "[.] Compiling object files..."
 clang -std=c99 $CFLAGS -c src/memory/scratch_arena.c -o build/scratch_arena.o $INCLUDE_FLAGS 
 clang -std=c99 $CFLAGS -c src/tsp/dist_matrix.c -o build/dist_matrix.o $INCLUDE_FLAGS
 clang -std=c99 $CFLAGS -c src/memory/page_arena.c -o build/page_arena.o $INCLUDE_FLAGS
-clang -std=c99 $CFLAGS -c src/tsp/trie.c -o build/trie $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/trie.c -o build/trie.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/tsp_loader.c -o build/tsp_loader.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/dist_kernels.c -o build/dist_kernels.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/dist_oracle.c -o build/dist_oracle.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/kd_tree.c -o build/kd_tree.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/hash.c -o build/hash.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/matrix_cache.c -o build/matrix_cache.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/quant_matrix.c -o build/quant_matrix.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/tiled_matrix.c -o build/tiled_matrix.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/hilbert.c -o build/hilbert.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/tour.c -o build/tour.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/construct.c -o build/construct.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/local_search.c -o build/local_search.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/lin_kernighan.c -o build/lin_kernighan.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/held_karp.c -o build/held_karp.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/window_opt.c -o build/window_opt.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/fragment_cache.c -o build/fragment_cache.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/concurrent_cache.c -o build/concurrent_cache.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/tsp/lut.c -o build/lut.o $INCLUDE_FLAGS
+clang -std=c99 $CFLAGS -c src/thread/thread_pool.c -o build/thread_pool.o $INCLUDE_FLAGS
 #add as needed here:
 
 #add "runner" here:
-#TARGET="bin/tsp_solver"
-#clang -std=c99 $CFLAGS build/*.o -o $TARGET $INCLUDE_FLAGS
+TARGET="bin/tsp_solver"
+clang -std=c99 -pthread $CFLAGS src/main.c build/*.o -o $TARGET $INCLUDE_FLAGS -lm
 
 if [ $? -ne 0 ]; then
     echo "[ ] Compilation/Linkage Failed."
@@ -2,11 +2,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "held_karp.h"
+#include "dist_kernels.h"
+#include "tour.h"
+#include "fragment_cache.h"
+#include "window_opt.h"
 
 // --- Config ---
 #define MAX_CITIES 6
 #define MAX_FRAGMENT_LEN 6
-#define CACHE_CAPACITY (1 << 20)
+#define CACHE_CAPACITY (1 << 10)       // starting slots, the cache grows past 7/8 full
 #define ARENA_SIZE (10 * 1024 * 1024)
 
 // --- Distance Matrix ---
@@ -19,90 +27,100 @@ float distance_matrix[MAX_CITIES][MAX_CITIES] = {
     {30, 20, 10, 35, 40, 0}
 };
 
-// --- Arena Allocator ---
-char arena[ARENA_SIZE];
-size_t arena_offset = 0;
-void* arena_alloc(size_t size) {
-    if (arena_offset + size > ARENA_SIZE) return NULL;
-    void* ptr = &arena[arena_offset];
-    arena_offset += size;
-    return ptr;
-}
-
-// --- Hash Function (FNV-1a) ---
-uint64_t hash_path(const uint8_t* path, uint8_t len) {
-    uint64_t hash = 14695981039346656037ULL;
-    for (uint8_t i = 0; i < len; ++i) {
-        hash ^= path[i];
-        hash *= 1099511628211ULL;
+// --- Compute Cost of a Path Fragment ---
+float compute_cost(const uint16_t* path, uint8_t len) {
+    float cost = 0;
+    for (uint8_t i = 0; i < len - 1; ++i) {
+        cost += distance_matrix[path[i]][path[i + 1]];
     }
-    return hash;
+    return cost;
 }
 
-// --- Cache Entry ---
-typedef struct {
-    uint64_t hash;
-    uint8_t path[MAX_FRAGMENT_LEN];
-    uint8_t length;
+// --- Exact Fragment Solve, Memoized ---
+// Shortest path through the cities of path with its first and last city fixed, written to
+// out_order. Repeated windows are answered from the cache without running Held-Karp again.
+float solve_fragment(FragmentCache* cache, HeldKarpSolver* hk, const uint16_t* path, uint8_t len,
+                     uint16_t* out_order) {
     float value;
-    bool used;
-} CacheEntry;
-
-CacheEntry cache[CACHE_CAPACITY];
-
-// --- Insert into Cache ---
-void insert_fragment(const uint8_t* path, uint8_t len, float value) {
-    uint64_t h = hash_path(path, len);
-    uint64_t index = h % CACHE_CAPACITY;
-    while (cache[index].used) {
-        if (cache[index].hash == h && cache[index].length == len && 
-            memcmp(cache[index].path, path, len) == 0) return;
-        index = (index + 1) % CACHE_CAPACITY;
-    }
-    cache[index].hash = h;
-    cache[index].length = len;
-    memcpy(cache[index].path, path, len);
-    cache[index].value = value;
-    cache[index].used = true;
-}
-
-// --- Lookup in Cache ---
-bool lookup_fragment(const uint8_t* path, uint8_t len, float* out_value) {
-    uint64_t h = hash_path(path, len);
-    uint64_t index = h % CACHE_CAPACITY;
-    while (cache[index].used) {
-        if (cache[index].hash == h && cache[index].length == len && 
-            memcmp(cache[index].path, path, len) == 0) {
-            *out_value = cache[index].value;
-            return true;
+    if (FragmentCacheLookup(cache, path, len, &value, out_order)) return value;
+    float window[MAX_FRAGMENT_LEN * MAX_FRAGMENT_LEN];
+    uint32_t positions[MAX_FRAGMENT_LEN];
+    for (uint8_t a = 0; a < len; ++a) {
+        for (uint8_t b = 0; b < len; ++b) {
+            window[a * len + b] = distance_matrix[path[a]][path[b]];
         }
-        index = (index + 1) % CACHE_CAPACITY;
     }
-    return false;
+    value = HeldKarpSolveDense(hk, window, len, HK_PATH, positions);
+    if (value < 0) return value;
+    for (uint8_t i = 0; i < len; ++i) {
+        out_order[i] = path[positions[i]];
+    }
+    FragmentCacheInsert(cache, path, len, value, out_order);
+    return value;
 }
 
-// --- Compute Cost of a Path Fragment ---
-float compute_cost(const uint8_t* path, uint8_t len) {
-    float cost = 0;
-    for (uint8_t i = 0; i < len - 1; ++i) {
-        cost += distance_matrix[path[i]][path[i + 1]];
+// --- Packed Copy of distance_matrix ---
+DistanceMatrix packed_distances(ScratchArena* arena) {
+    DistanceMatrix dm;
+    dm.rowOffset = arenaScratchAlloc(arena, sizeof(uint32_t) * MAX_CITIES, ALIGN_64);
+    dm.distances = arenaScratchAlloc(arena, sizeof(float) * PackedMatrixSize(MAX_CITIES), ALIGN_64);
+    FillRowOffsets(dm.rowOffset, MAX_CITIES);
+    for (uint32_t i = 0; i < MAX_CITIES; ++i) {
+        for (uint32_t j = i + 1; j < MAX_CITIES; ++j) {
+            dm.distances[DM_INDEX(dm, i, j)] = distance_matrix[i][j];
+        }
     }
-    return cost;
+    return dm;
 }
 
 // --- Placeholder Main ---
 int main(void) {
-    uint8_t path1[] = {0, 1, 2};
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    FragmentCache cache = CreateFragmentCache(&arena, CACHE_CAPACITY, FRAGMENT_KEY_U16);
+
+    uint16_t path1[] = {0, 1, 2};
     float cost = compute_cost(path1, 3);
-    insert_fragment(path1, 3, cost);
+    FragmentCacheInsert(&cache, path1, 3, cost, NULL);
 
     float cached;
-    if (lookup_fragment(path1, 3, &cached)) {
+    if (FragmentCacheLookup(&cache, path1, 3, &cached, NULL)) {
         printf("Cached cost for [0 1 2]: %.2f\n", cached);
     } else {
         printf("Not cached.\n");
     }
 
+    memMap* map = initMemMap(1 << 22);
+    PageArena* hk_arena = createPageArena(map, HeldKarpBlockSize(MAX_FRAGMENT_LEN) + (1 << 12));
+    HeldKarpSolver hk = CreateHeldKarpSolver(hk_arena, MAX_FRAGMENT_LEN);
+
+    // every window of 4 along the cyclic tour 0..5, swept twice: the second sweep is all hits
+    uint16_t window[4], order[4];
+    for (int sweep = 0; sweep < 2; ++sweep) {
+        for (uint16_t s = 0; s < MAX_CITIES; ++s) {
+            for (uint16_t i = 0; i < 4; ++i) window[i] = (s + i) % MAX_CITIES;
+            float best = solve_fragment(&cache, &hk, window, 4, order);
+            if (sweep == 0) {
+                printf("Window [%u %u %u %u]: %.2f -> [%u %u %u %u] %.2f\n",
+                       window[0], window[1], window[2], window[3], compute_cost(window, 4),
+                       order[0], order[1], order[2], order[3], best);
+            }
+        }
+    }
+
+    // sliding windows over the whole tour; the second pass is answered by the cache
+    DistanceMatrix dm = packed_distances(&arena);
+    uint32_t tour[MAX_CITIES] = {0, 1, 2, 3, 4, 5};
+    FragmentMemo memo = FragmentCacheMemo(&cache);
+    PageArena* window_arena = createPageArena(map, WindowOptBlockSize(MAX_CITIES, 4, 0));
+    for (int pass = 0; pass < 2; ++pass) {
+        WindowOptStats stats = WindowOptimize(window_arena, tour, MAX_CITIES, dm, 4, &memo, 0);
+        printf("Window pass %d: %u windows, %u cache hits, %u improved, gain %.2f, tour length %.2f\n",
+               pass, stats.windows, stats.cacheHits, stats.improved, stats.gain, TourLength(dm, tour, MAX_CITIES));
+    }
+    printf("Fragment cache: %u entries, %llu lookups, hit rate %.1f%%\n", cache.size,
+           (unsigned long long)cache.lookups, 100.0 * FragmentCacheHitRate(&cache));
+
+    releasePages(map);
+    destroyScratchArena(&arena);
     return 0;
 }
-
@@ -45,58 +45,111 @@ memMap* initMemMap(usize requestedSize) {
     memcpy(structBase, &tmp, sizeof(memMap));
     memMap* map = (memMap*)structBase;
     map->structBase = map;
+    usize slotStart = (sizeof(memMap) + ALIGN_64 - 1) & ~(usize)(ALIGN_64 - 1);
+    map->metaChunks[0] = (PageArena*)(structBase + slotStart);
+    map->firstChunkSlots = (u32)((pageSize - slotStart) / sizeof(PageArena));
     memset(usableStart, 0, 1);
  
     return map;
 }
 
-void pageAlign(memMap* map, usize arenaSize) {
-    usize remainder = arenaSize % map->pageSize; 
-    usize alignPad = (remainder == 0) ? 0 : (map->pageSize - remainder);
-    if (map->offset + alignPad + arenaSize < map->limit) {
-        map->offset += arenaSize + alignPad;
-        return;
+static inline usize pageRound(memMap* map, usize size) {
+    usize remainder = size % map->pageSize;
+    return (remainder == 0) ? size : size + (map->pageSize - remainder);
+}
+
+usize reservePages(memMap* map, usize arenaSize) {
+    usize needed = pageRound(map, arenaSize);
+    usize offset = __atomic_load_n(&map->offset, __ATOMIC_RELAXED);
+    do {
+        if (arenaSize > map->size || needed > map->size - offset) {
+            LOG_ERROR("ARENA OVERFLOW on offset alignment : %d Arena", __atomic_load_n(&map->arenaCount, __ATOMIC_RELAXED));
+            return PAGE_RESERVE_FAILED;
+        }
+    } while (!__atomic_compare_exchange_n(&map->offset, &offset, offset + needed, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+    __atomic_store_n(&map->previous, offset, __ATOMIC_RELAXED);
+    return offset;
+}
+
+//Gives a region back if nothing was reserved after it.
+static void unreservePages(memMap* map, usize offset, usize arenaSize) {
+    usize end = offset + pageRound(map, arenaSize);
+    __atomic_compare_exchange_n(&map->offset, &end, offset, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+static inline usize chunkSlots(memMap* map, u32 chunk) {
+    return (usize)map->firstChunkSlots << chunk;
+}
+
+static void releaseMetaChunks(memMap* map) {
+    for (u32 c = 1; c < PAGE_META_CHUNKS; c++) {
+        if (map->metaChunks[c]) munmap(map->metaChunks[c], sizeof(PageArena) * chunkSlots(map, c));
     }
-    LOG_ERROR("ARENA OVERFLOW on offset alginment : %d Arena", map->arenaCount);
 }
 
 void releasePages(memMap* map) {
+    releaseMetaChunks(map);
     munmap(map->start, map->limit);
 }
 
+//Zeroed metadata slot for the next arena, mapping its block the first time any thread reaches
+//it. Racing threads both map a block; the loser of the compare-and-swap unmaps its own.
+static PageArena* claimSlot(memMap* map) {
+    //Acquire pairs with the release that handed a slot back, so its last owner's writes land first.
+    u32 index = __atomic_fetch_add(&map->slotsClaimed, 1, __ATOMIC_ACQUIRE);
+    u32 q = index / map->firstChunkSlots + 1;
+    u32 chunk = 31 - (u32)__builtin_clz(q);
+    if (chunk >= PAGE_META_CHUNKS) {
+        LOG_ERROR("Arena metadata exhausted after %u arenas", index);
+        return NULL;
+    }
+    usize first = (usize)map->firstChunkSlots * ((1u << chunk) - 1);
+    PageArena* block = __atomic_load_n(&map->metaChunks[chunk], __ATOMIC_ACQUIRE);
+    if (!block) {
+        usize bytes = sizeof(PageArena) * chunkSlots(map, chunk);
+        memptr fresh = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (fresh == MAP_FAILED) {
+            LOG_ERROR("FAILED TO MAP ARENA METADATA, size: %zu", bytes);
+            return NULL;
+        }
+        if (__atomic_compare_exchange_n(&map->metaChunks[chunk], &block, (PageArena*)fresh, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            block = (PageArena*)fresh;
+        } else {
+            munmap(fresh, bytes);
+        }
+    }
+    PageArena* arena = block + (index - first);
+    memset(arena, 0, sizeof(PageArena));
+    arena->slot = index;
+    return arena;
+}
+
 PageArena* createPageArena(memMap* map, usize arenaSize) {
-    if(arenaSize > map->size - map->offset) {
+    usize offset = reservePages(map, arenaSize);
+    if (offset == PAGE_RESERVE_FAILED) {
         LOG_ERROR("Arena Requested more than available memory");
         return NULL;
     }
-    byte arenaBase = (byte)map->base + map->offset; 
-    pageAlign(map, arenaSize);
-    if(!arenaBase) {
+    PageArena* arena = claimSlot(map);
+    if (!arena) {
         LOG_ERROR("Arena allocation failed.");
+        unreservePages(map, offset, arenaSize);
         return NULL;
     }
-    PageArena tmp;
-    tmp.size = arenaSize;
-    tmp.offset = 0;
-    tmp.previous = tmp.offset;
-    tmp.parent = map;
-    byte structBase;
-    if(tmp.parent->arenaCount < 1) {
-        structBase = tmp.parent->structBase + sizeof(memMap);
-    } else {
-        structBase = tmp.parent->structBase + sizeof(memMap) + tmp.parent->arenaCount * sizeof(PageArena);
-    }
-    memcpy(structBase, &tmp, sizeof(PageArena));
-    tmp.parent->arenaCount++;
-    PageArena* arena = (PageArena*)structBase;
-    arena->base = arenaBase;
-    map->previous = map->offset;
-    if(map->arenaCurrent) {
-        arena->arenaPrevious = map->arenaCurrent;
-    } else {
-        arena->arenaPrevious = NULL;
-    }
-    map->arenaCurrent = arena;
+    arena->parent = map;
+    arena->base = (byte)map->base + offset;
+    arena->size = arenaSize;
+    arena->offset = 0;
+    arena->previous = arena->offset;
+
+    PageArena* top = __atomic_load_n(&map->arenaCurrent, __ATOMIC_RELAXED);
+    do {
+        arena->arenaPrevious = top;
+    } while (!__atomic_compare_exchange_n(&map->arenaCurrent, &top, arena, false,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_add_fetch(&map->arenaCount, 1, __ATOMIC_RELAXED);
     return arena;
 }
 
@@ -137,17 +190,49 @@ memptr arenaPageAlloc(PageArena* arena, usize alloc_size, usize alignment) {
     return NULL;
 }
 
-void arenaPagePop(memMap* map) {
-    if(map->arenaCurrent) {
-        PageArena* current = map->arenaCurrent;
-        current->base = NULL;
-        current->size = 0;
-        current->offset = 0;
+usize arenaPageMark(PageArena* arena) {
+    usize saved = arena->previous;
+    arena->previous = arena->offset;
+    return saved;
+}
+
+void arenaPageRewind(PageArena* arena, usize saved) {
+    arena->offset = arena->previous;
+    arena->previous = saved;
+}
 
-        map->arenaCurrent = current->arenaPrevious;
-        map->arenaCount--;
-        map->offset = map->previous;
+void releasePageArena(PageArena* arena) {
+    if (!arena->base) {
+        LOG_WARN("Arena already released");
+        return;
+    }
+    memMap* map = arena->parent;
+    unreservePages(map, (usize)(arena->base - (byte)map->base), arena->size);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->offset = 0;
+    arena->previous = 0;
+    //Only an arena unlinked from the chain may give its slot back, or a new arena could be
+    //written over a node other arenas still point at.
+    PageArena* top = arena;
+    if (__atomic_compare_exchange_n(&map->arenaCurrent, &top, arena->arenaPrevious, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        u32 end = arena->slot + 1;
+        __atomic_compare_exchange_n(&map->slotsClaimed, &end, arena->slot, false,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    }
+    __atomic_sub_fetch(&map->arenaCount, 1, __ATOMIC_RELAXED);
+}
 
+void arenaPagePop(memMap* map) {
+    PageArena* current = __atomic_load_n(&map->arenaCurrent, __ATOMIC_ACQUIRE);
+    while (current && !current->base) {
+        current = current->arenaPrevious;
+    }
+    if(current) {
+        //Drops released arenas above it so the release below unlinks current itself.
+        __atomic_store_n(&map->arenaCurrent, current, __ATOMIC_RELEASE);
+        releasePageArena(current);
     } else {
         LOG_ERROR("Current arena NULL on pop request");
         //exit(EXIT_FAILURE);
@@ -3,8 +3,15 @@
 
 #include "common_types.h"
 
+#define PAGE_META_CHUNKS 24         //arena slot blocks, each twice the size of the one before
+#define PAGE_RESERVE_FAILED ((usize)-1)
+
 struct PageArena;
 
+//offset, arenaCurrent and arenaCount are only changed with atomics, so arenas may be created
+//and released from any number of threads. Arena slots are handed out by slotsClaimed from
+//metaChunks: block 0 fills the rest of the metadata page, block c holds firstChunkSlots << c
+//slots and is mapped by whichever thread first needs it.
 typedef struct memMap{
     memptr start;
     memptr structBase;
@@ -18,8 +25,13 @@ typedef struct memMap{
     usize selfSize;
     u32 arenaCount;
     u32 _pad;
+    struct PageArena* metaChunks[PAGE_META_CHUNKS];
+    u32 slotsClaimed;
+    u32 firstChunkSlots;
 } memMap;
 
+//One cache line, so arenas handed to different threads never share one. Allocation from an
+//arena is not synchronized: each arena belongs to one thread at a time.
 typedef struct PageArena{
     memMap* parent;
     struct PageArena* arenaPrevious;
@@ -27,14 +39,30 @@ typedef struct PageArena{
     usize offset;
     usize size;
     usize previous;
+    u32 slot;                   //index in slotsClaimed order, handed back on LIFO release
+    u8 _pad[12];
 } PageArena;
 
 memMap *initMemMap(usize requestedSize);
-void pageAlign(memMap* map, usize arenaSize);
+//Reserves arenaSize bytes rounded up to whole pages with a compare-and-swap on map->offset;
+//returns the region's offset from map->base, PAGE_RESERVE_FAILED when the map is full.
+usize reservePages(memMap* map, usize arenaSize);
 void releasePages(memMap* map);
 
 PageArena *createPageArena(memMap* map, usize arenaSize);
 memptr arenaPageAlloc(PageArena* arena, usize alloc_size, usize alignment);
+//Moves the arena's rewind point (previous) to its current offset and returns the old one.
+//arenaPageRewind frees everything allocated since the mark and reinstates the old point, so
+//marks nest as long as every mark is rewound in reverse order.
+usize arenaPageMark(PageArena* arena);
+void arenaPageRewind(PageArena* arena, usize saved);
+//Retires an arena from any thread. Its pages go back to the map when it is still the newest
+//reservation, and its metadata slot when it is still the top of the arena chain and the
+//newest slot, as with nested create/release on one thread; otherwise both stay reserved
+//until releasePages.
+void releasePageArena(PageArena* arena);
+//Releases the most recently created arena still live. Walks the shared chain, so it is for
+//the thread that owns the map, not for use while other threads create arenas.
 void arenaPagePop(memMap* map);
 
 #endif
@@ -1,3 +1,4 @@
+#define _POSIX_C_SOURCE 200112L
 #include <stdio.h>
 #include <stdlib.h>
 #include "arena_base.h"
@@ -5,7 +6,13 @@
 
 ScratchArena createScratchArena(usize arena_size) {
     ScratchArena arena;
-    arena.base = malloc(arena_size);
+    //alignment is applied to offsets, so the base must satisfy the largest AlignType itself;
+    //plain malloc only promises 16 bytes
+    memptr base = NULL;
+    if(posix_memalign(&base, ALIGN_128, arena_size) != 0) {
+        base = NULL;
+    }
+    arena.base = base;
     if(!arena.base) {
         LOG_ERROR("Arena allocation failed.");
         exit(EXIT_FAILURE);
@@ -0,0 +1,129 @@
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+typedef struct {
+    ThreadTask task;
+    memptr ctx;
+    u32 threadIndex;
+    u32 threadCount;
+} ThreadStart;
+
+static void* threadEntry(void* arg) {
+    ThreadStart* start = (ThreadStart*)arg;
+    start->task(start->ctx, start->threadIndex, start->threadCount);
+    return NULL;
+}
+
+u32 hardwareThreadCount(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n < 1) ? 1 : (u32)n;
+}
+
+void runThreadPool(u32 threadCount, ThreadTask task, memptr ctx) {
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+
+    pthread_t threads[THREAD_POOL_MAX_THREADS];
+    ThreadStart starts[THREAD_POOL_MAX_THREADS];
+    bool spawned[THREAD_POOL_MAX_THREADS];
+
+    for (u32 t = 1; t < threadCount; t++) {
+        starts[t] = (ThreadStart){ .task = task, .ctx = ctx, .threadIndex = t, .threadCount = threadCount };
+        spawned[t] = pthread_create(&threads[t], NULL, threadEntry, &starts[t]) == 0;
+        if (!spawned[t]) {
+            LOG_WARN("pthread_create failed for worker %u, running it on the caller", t);
+        }
+    }
+
+    task(ctx, 0, threadCount);
+
+    for (u32 t = 1; t < threadCount; t++) {
+        if (spawned[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            task(ctx, t, threadCount);
+        }
+    }
+}
+
+//Remaining items of one worker packed as (end << 32 | begin) so owner pops and thief steals
+//are a single CAS on one word. Each span sits on its own cache line.
+typedef struct {
+    u64 span;
+    u8 _pad[56];
+} __attribute__((aligned(64))) StealSpan;
+
+typedef struct {
+    StealSpan spans[THREAD_POOL_MAX_THREADS];
+    ItemTask task;
+    memptr ctx;
+} StealJob;
+
+static inline u64 packSpan(u32 begin, u32 end) {
+    return ((u64)end << 32) | begin;
+}
+
+static bool popFront(StealSpan* s, u32* item) {
+    u64 span = __atomic_load_n(&s->span, __ATOMIC_ACQUIRE);
+    for (;;) {
+        u32 begin = (u32)span, end = (u32)(span >> 32);
+        if (begin >= end) return false;
+        if (__atomic_compare_exchange_n(&s->span, &span, packSpan(begin + 1, end), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *item = begin;
+            return true;
+        }
+    }
+}
+
+static bool stealBack(StealSpan* victim, u32* outBegin, u32* outEnd) {
+    u64 span = __atomic_load_n(&victim->span, __ATOMIC_ACQUIRE);
+    for (;;) {
+        u32 begin = (u32)span, end = (u32)(span >> 32);
+        if (begin >= end) return false;
+        u32 take = (end - begin + 1) / 2;
+        if (__atomic_compare_exchange_n(&victim->span, &span, packSpan(begin, end - take), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *outBegin = end - take;
+            *outEnd = end;
+            return true;
+        }
+    }
+}
+
+static void stealWorker(memptr ctx, u32 threadIndex, u32 threadCount) {
+    StealJob* job = (StealJob*)ctx;
+    StealSpan* own = &job->spans[threadIndex];
+    for (;;) {
+        u32 item;
+        while (popFront(own, &item)) {
+            job->task(job->ctx, item, threadIndex);
+        }
+        bool stole = false;
+        for (u32 k = 1; k < threadCount && !stole; k++) {
+            u32 begin, end;
+            if (stealBack(&job->spans[(threadIndex + k) % threadCount], &begin, &end)) {
+                __atomic_store_n(&own->span, packSpan(begin, end), __ATOMIC_RELEASE);
+                stole = true;
+            }
+        }
+        if (!stole) return;
+    }
+}
+
+void runThreadPoolStealing(u32 threadCount, u32 itemCount, ItemTask task, memptr ctx) {
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+    if (threadCount > itemCount) threadCount = (itemCount > 0) ? itemCount : 1;
+
+    StealJob job;
+    job.task = task;
+    job.ctx = ctx;
+    for (u32 t = 0; t < threadCount; t++) {
+        u32 begin = (u32)((u64)itemCount * t / threadCount);
+        u32 end = (u32)((u64)itemCount * (t + 1) / threadCount);
+        job.spans[t].span = packSpan(begin, end);
+    }
+    runThreadPool(threadCount, stealWorker, &job);
+}
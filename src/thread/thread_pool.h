@@ -0,0 +1,20 @@
+#ifndef t_THREAD_POOL_H
+#define t_THREAD_POOL_H
+
+#include "common_types.h"
+
+#define THREAD_POOL_MAX_THREADS 256
+
+typedef void (*ThreadTask)(memptr ctx, u32 threadIndex, u32 threadCount);
+typedef void (*ItemTask)(memptr ctx, u32 item, u32 threadIndex);
+
+u32 hardwareThreadCount(void);
+//Fork-join: runs task on threadCount workers, the calling thread acting as worker 0, and
+//returns once every worker has finished. threadCount is clamped to [1, THREAD_POOL_MAX_THREADS].
+void runThreadPool(u32 threadCount, ThreadTask task, memptr ctx);
+//Runs task once for every item in [0, itemCount). Each worker starts on a contiguous share of
+//the items and, when it runs dry, steals the back half of another worker's remaining share, so
+//uneven item costs still finish together. Items should be sized for roughly equal work.
+void runThreadPoolStealing(u32 threadCount, u32 itemCount, ItemTask task, memptr ctx);
+
+#endif
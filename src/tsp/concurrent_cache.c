@@ -0,0 +1,164 @@
+#include <string.h>
+#include "concurrent_cache.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "hash.h"
+
+#define CONCURRENT_HASH_SEED 0xC2B2AE3D27D4EB4FULL
+#define CONCURRENT_CLAIM_ATTEMPTS 4
+
+static inline ConcurrentSlot* slotAt(const ConcurrentCache* cache, u32 index) {
+    return (ConcurrentSlot*)(cache->slots + (usize)index * cache->slotStride);
+}
+
+static inline u32* slotKey(ConcurrentSlot* slot) {
+    return (u32*)(slot + 1);
+}
+
+static inline u32* slotOrder(const ConcurrentCache* cache, ConcurrentSlot* slot) {
+    return (u32*)(slot + 1) + cache->maxLen;
+}
+
+ConcurrentCache CreateConcurrentCache(ScratchArena *arena, u32 capacity, u32 maxLen) {
+    ConcurrentCache cache;
+    memset(&cache, 0, sizeof(cache));
+    u32 rounded = CONCURRENT_PROBE;
+    while (rounded < capacity && rounded < (1u << 31)) rounded <<= 1;
+    u32 stride = (u32)((sizeof(ConcurrentSlot) + 2 * sizeof(u32) * (usize)maxLen + 63) & ~(usize)63);
+    if (maxLen == 0) {
+        LOG_ERROR("Concurrent cache needs a key length above 0");
+        return cache;
+    }
+    cache.slots = arenaScratchAlloc(arena, (usize)rounded * stride, ALIGN_64);
+    if (!cache.slots) {
+        LOG_ERROR("Arena too small for a %u slot concurrent cache", rounded);
+        return cache;
+    }
+    memset(cache.slots, 0, (usize)rounded * stride);
+    cache.capacity = rounded;
+    cache.maxLen = maxLen;
+    cache.slotStride = stride;
+    return cache;
+}
+
+//Copies a slot matching (hash, path) into cost/order between two version reads. Returns
+//false on a mismatch, an empty slot, or a slot a writer kept changing.
+static bool readSlot(const ConcurrentCache* cache, ConcurrentSlot* slot, u64 hash, const u32* path, u32 len,
+                     f32* cost, u32* order) {
+    for (u32 attempt = 0; attempt < CONCURRENT_READ_RETRIES; attempt++) {
+        u64 before = __atomic_load_n(&slot->version, __ATOMIC_ACQUIRE);
+        if (before & 1) continue;
+        if (__atomic_load_n(&slot->hash, __ATOMIC_RELAXED) != hash
+            || __atomic_load_n(&slot->len, __ATOMIC_RELAXED) != len) {
+            //a stale mismatch is only a miss, unless a writer was mid-update
+            if (__atomic_load_n(&slot->version, __ATOMIC_ACQUIRE) == before) return false;
+            continue;
+        }
+        bool same = true;
+        u32* key = slotKey(slot);
+        u32* best = slotOrder(cache, slot);
+        for (u32 i = 0; i < len; i++) {
+            same &= (__atomic_load_n(&key[i], __ATOMIC_RELAXED) == path[i]);
+            if (order) order[i] = __atomic_load_n(&best[i], __ATOMIC_RELAXED);
+        }
+        u32 bits = __atomic_load_n(&slot->costBits, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->version, __ATOMIC_RELAXED) != before) continue;
+        if (!same) return false;
+        memcpy(cost, &bits, sizeof(bits));
+        return true;
+    }
+    return false;
+}
+
+bool ConcurrentCacheLookup(ConcurrentCache* cache, const u32* path, u32 len, f32* cost, u32* order) {
+    if (!cache->slots || len == 0 || len > cache->maxLen) return false;
+    u64 hash = HashBytes(path, sizeof(u32) * (usize)len, CONCURRENT_HASH_SEED);
+    u32 mask = cache->capacity - 1;
+    u32 home = (u32)(hash >> 8) & mask;
+    for (u32 p = 0; p < CONCURRENT_PROBE; p++) {
+        ConcurrentSlot* slot = slotAt(cache, (home + p) & mask);
+        if (readSlot(cache, slot, hash, path, len, cost, order)) {
+            if (!__atomic_load_n(&slot->referenced, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&slot->referenced, 1, __ATOMIC_RELAXED);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+//An empty slot of the window if there is one, otherwise the clock victim: from a rotating
+//start, referenced entries lose their bit and are passed over once.
+static u32 pickVictim(ConcurrentCache* cache, u32 home, bool* evicting) {
+    u32 mask = cache->capacity - 1;
+    for (u32 p = 0; p < CONCURRENT_PROBE; p++) {
+        ConcurrentSlot* slot = slotAt(cache, (home + p) & mask);
+        if (__atomic_load_n(&slot->len, __ATOMIC_RELAXED) == 0) {
+            *evicting = false;
+            return (home + p) & mask;
+        }
+    }
+    *evicting = true;
+    u32 hand = (u32)__atomic_fetch_add(&cache->clockHand, 1, __ATOMIC_RELAXED);
+    for (u32 step = 0; step < 2 * CONCURRENT_PROBE; step++) {
+        u32 index = (home + (hand + step) % CONCURRENT_PROBE) & mask;
+        ConcurrentSlot* slot = slotAt(cache, index);
+        if (!__atomic_exchange_n(&slot->referenced, 0, __ATOMIC_RELAXED)) return index;
+    }
+    return (home + hand % CONCURRENT_PROBE) & mask;
+}
+
+bool ConcurrentCacheInsert(ConcurrentCache* cache, const u32* path, u32 len, f32 cost, const u32* order) {
+    if (!cache->slots || len == 0 || len > cache->maxLen) return false;
+    u64 hash = HashBytes(path, sizeof(u32) * (usize)len, CONCURRENT_HASH_SEED);
+    u32 mask = cache->capacity - 1;
+    u32 home = (u32)(hash >> 8) & mask;
+    f32 existing;
+    for (u32 p = 0; p < CONCURRENT_PROBE; p++) {
+        if (readSlot(cache, slotAt(cache, (home + p) & mask), hash, path, len, &existing, NULL)) return true;
+    }
+
+    u32 bits;
+    memcpy(&bits, &cost, sizeof(bits));
+    for (u32 attempt = 0; attempt < CONCURRENT_CLAIM_ATTEMPTS; attempt++) {
+        bool evicting;
+        ConcurrentSlot* slot = slotAt(cache, pickVictim(cache, home, &evicting));
+        u64 version = __atomic_load_n(&slot->version, __ATOMIC_RELAXED);
+        if ((version & 1) || !__atomic_compare_exchange_n(&slot->version, &version, version + 1, false,
+                                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        //odd version published before any payload store
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        evicting = (__atomic_load_n(&slot->len, __ATOMIC_RELAXED) != 0);
+        u32* key = slotKey(slot);
+        u32* best = slotOrder(cache, slot);
+        __atomic_store_n(&slot->hash, hash, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->len, len, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->costBits, bits, __ATOMIC_RELAXED);
+        for (u32 i = 0; i < len; i++) {
+            __atomic_store_n(&key[i], path[i], __ATOMIC_RELAXED);
+            __atomic_store_n(&best[i], order ? order[i] : path[i], __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&slot->referenced, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->version, version + 2, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&cache->inserts, 1, __ATOMIC_RELAXED);
+        if (evicting) __atomic_fetch_add(&cache->evictions, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    return false;
+}
+
+static bool memoLookup(memptr ctx, const u32* path, u32 len, f32* cost, u32* order) {
+    return ConcurrentCacheLookup((ConcurrentCache*)ctx, path, len, cost, order);
+}
+
+static void memoInsert(memptr ctx, const u32* path, u32 len, f32 cost, const u32* order) {
+    ConcurrentCacheInsert((ConcurrentCache*)ctx, path, len, cost, order);
+}
+
+FragmentMemo ConcurrentCacheMemo(ConcurrentCache* cache) {
+    FragmentMemo memo = { .lookup = memoLookup, .insert = memoInsert, .ctx = cache };
+    return memo;
+}
@@ -0,0 +1,53 @@
+#ifndef tsp_CONCURRENT_CACHE_H
+#define tsp_CONCURRENT_CACHE_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "fragment_cache.h"
+
+#define CONCURRENT_PROBE 8              //slots a key may occupy, starting at its home slot
+#define CONCURRENT_READ_RETRIES 4       //re-reads of a slot a writer changed under the reader
+
+//Slot header; the key and the optimal order follow it, maxLen u32 cities each. version is a
+//per-slot sequence number: odd while a writer owns the slot, bumped by two per completed write.
+typedef struct {
+    u64 version;
+    u64 hash;
+    u32 len;                            //0: empty
+    u32 costBits;
+    u8 referenced;                      //clock bit, set by hits
+    u8 _pad[7];
+} ConcurrentSlot;
+
+//Fixed-size fragment cache shared by solver threads without locks. Writers claim a slot with
+//one CAS on its version and publish with a release store; readers copy a slot between two
+//version reads and keep the copy only when both match and are even, so they never block and
+//never see a torn entry. Memory is bounded by the capacity: a key lives in one of the
+//CONCURRENT_PROBE slots from its home slot, and a full window evicts clock style, clearing
+//referenced bits from a rotating hand until it finds an entry that was not hit since the last
+//sweep. Two threads inserting one key at once may both store it; lookups return either copy.
+typedef struct {
+    u8* slots;
+    u32 capacity;                       //power of two, at least CONCURRENT_PROBE
+    u32 maxLen;
+    u32 slotStride;
+    u32 _pad0;
+    u8 _line0[40];
+    u64 clockHand;                      //shared counters each on their own cache line
+    u8 _line1[56];
+    u64 inserts;
+    u8 _line2[56];
+    u64 evictions;
+    u8 _line3[56];
+} __attribute__((aligned(64))) ConcurrentCache;
+
+//capacity is rounded up to a power of two. Keys longer than maxLen are never stored.
+ConcurrentCache CreateConcurrentCache(ScratchArena *arena, u32 capacity, u32 maxLen);
+bool ConcurrentCacheLookup(ConcurrentCache* cache, const u32* path, u32 len, f32* cost, u32* order);
+//Best effort: returns false when the key is too long or every candidate slot stayed owned by
+//other writers.
+bool ConcurrentCacheInsert(ConcurrentCache* cache, const u32* path, u32 len, f32 cost, const u32* order);
+//View for WindowOptimize; every callback is safe to call from any thread.
+FragmentMemo ConcurrentCacheMemo(ConcurrentCache* cache);
+
+#endif
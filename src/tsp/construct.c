@@ -0,0 +1,230 @@
+#include <stdlib.h>
+#include "construct.h"
+#include "kd_tree.h"
+#include "hilbert.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+#define NO_CITY UINT32_MAX
+
+typedef struct {
+    f32 d;
+    u32 a;
+    u32 b;
+} CandidateEdge;
+
+u32* NearestNeighborTour(ScratchArena *arena, const Vec2* coords, u32 count, u32 start) {
+    if (!coords || count == 0 || start >= count) {
+        LOG_ERROR("Nearest neighbor needs coordinates and a start city below %u", count);
+        return NULL;
+    }
+    u32* tour = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    KdTree tree = BuildKdTree(arena, coords, count);
+    if (!tour || !tree.nodes) {
+        LOG_ERROR("Arena too small for a %u city nearest neighbor tour", count);
+        return NULL;
+    }
+
+    u32 cur = start;
+    for (u32 k = 0; k < count; k++) {
+        tour[k] = cur;
+        KdRemove(&tree, cur);
+        if (k + 1 < count) {
+            KdNearest(&tree, coords[cur], 1, KD_NO_CHILD, &cur, NULL);
+        }
+    }
+    return tour;
+}
+
+static int compareEdges(const void* pa, const void* pb) {
+    const CandidateEdge* a = (const CandidateEdge*)pa;
+    const CandidateEdge* b = (const CandidateEdge*)pb;
+    if (a->d != b->d) return (a->d < b->d) ? -1 : 1;
+    if (a->a != b->a) return (a->a < b->a) ? -1 : 1;
+    return (a->b < b->b) ? -1 : (a->b > b->b);
+}
+
+static bool listContains(const u32* list, u32 k, u32 city) {
+    for (u32 s = 0; s < k; s++) {
+        if (list[s] == city) return true;
+    }
+    return false;
+}
+
+//Collects every candidate pair once and sorts it by length: a counting pass spreads edges over
+//one bucket per edge by length, then each (small) bucket is sorted on its own.
+static CandidateEdge* sortedCandidateEdges(ScratchArena *arena, const CandidateLists* lists, DistanceOracle* oracle,
+                                           u32* outCount) {
+    u32 count = lists->count, k = lists->k;
+    CandidateEdge* edges = arenaScratchAlloc(arena, sizeof(CandidateEdge) * (usize)count * k, ALIGN_64);
+    if (!edges) return NULL;
+
+    u32 m = 0;
+    f32 minD = 0.0f, maxD = 0.0f;
+    for (u32 i = 0; i < count; i++) {
+        const u32* list = CandidatesOf(lists, i);
+        for (u32 s = 0; s < k; s++) {
+            u32 j = list[s];
+            if (j < i && listContains(CandidatesOf(lists, j), k, i)) continue;    //taken from j's list
+            f32 d = OracleDistance(oracle, i, j);
+            edges[m].d = d;
+            edges[m].a = (i < j) ? i : j;
+            edges[m].b = (i < j) ? j : i;
+            if (m == 0 || d < minD) minD = d;
+            if (m == 0 || d > maxD) maxD = d;
+            m++;
+        }
+    }
+
+    u32* bucketStart = arenaScratchAlloc(arena, sizeof(u32) * ((usize)m + 1), ALIGN_64);
+    CandidateEdge* sorted = arenaScratchAlloc(arena, sizeof(CandidateEdge) * ((usize)m + 1), ALIGN_64);
+    if (!bucketStart || !sorted) return NULL;
+    f64 scale = (maxD > minD) ? (f64)(m - 1) / ((f64)maxD - minD) : 0.0;
+    for (u32 b = 0; b <= m; b++) {
+        bucketStart[b] = 0;
+    }
+    for (u32 e = 0; e < m; e++) {
+        bucketStart[(u32)(((f64)edges[e].d - minD) * scale) + 1]++;
+    }
+    for (u32 b = 1; b <= m; b++) {
+        bucketStart[b] += bucketStart[b - 1];
+    }
+    for (u32 e = 0; e < m; e++) {
+        sorted[bucketStart[(u32)(((f64)edges[e].d - minD) * scale)]++] = edges[e];
+    }
+    //bucketStart[b] now holds the end of bucket b
+    u32 begin = 0;
+    for (u32 b = 0; b < m; b++) {
+        u32 end = bucketStart[b];
+        if (end - begin > 1) {
+            qsort(sorted + begin, end - begin, sizeof(CandidateEdge), compareEdges);
+        }
+        begin = end;
+    }
+    *outCount = m;
+    return sorted;
+}
+
+static u32 findRoot(u32* parent, u32 x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+//Walks a path fragment from endpoint start, appending it to the tour; returns the far end.
+static u32 emitFragment(const u32* adj, u32 start, u32* tour, u32* pos) {
+    u32 prev = NO_CITY, node = start;
+    for (;;) {
+        tour[(*pos)++] = node;
+        u32 a0 = adj[2 * node], a1 = adj[2 * node + 1];
+        u32 next = (a0 != NO_CITY && a0 != prev) ? a0 : ((a1 != NO_CITY && a1 != prev) ? a1 : NO_CITY);
+        if (next == NO_CITY) return node;
+        prev = node;
+        node = next;
+    }
+}
+
+u32* GreedyEdgeTour(ScratchArena *arena, const Vec2* coords, u32 count, DistanceOracle* oracle, u32 threadCount) {
+    if (!coords || !oracle || count == 0) {
+        LOG_ERROR("Greedy edge needs coordinates and a distance oracle");
+        return NULL;
+    }
+    u32* tour = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    if (!tour) {
+        LOG_ERROR("Arena too small for a %u city tour", count);
+        return NULL;
+    }
+    if (count < 3) {
+        for (u32 i = 0; i < count; i++) tour[i] = i;
+        return tour;
+    }
+
+    CandidateLists lists = BuildCandidateLists(arena, coords, count, GREEDY_CANDIDATES, threadCount);
+    u32 edgeCount = 0;
+    CandidateEdge* edges = lists.neighbors ? sortedCandidateEdges(arena, &lists, oracle, &edgeCount) : NULL;
+    u32* adj = arenaScratchAlloc(arena, sizeof(u32) * 2 * (usize)count, ALIGN_64);
+    u32* parent = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    u32* endpoints = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    u32* localId = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    Vec2* endCoords = arenaScratchAlloc(arena, sizeof(Vec2) * count, ALIGN_64);
+    if (!edges || !adj || !parent || !endpoints || !localId || !endCoords) {
+        LOG_ERROR("Arena too small for greedy edge scratch over %u cities", count);
+        return NULL;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        adj[2 * i] = NO_CITY;
+        adj[2 * i + 1] = NO_CITY;
+        parent[i] = i;
+    }
+    u32 taken = 0;
+    for (u32 e = 0; e < edgeCount && taken < count - 1; e++) {
+        u32 a = edges[e].a, b = edges[e].b;
+        if (adj[2 * a + 1] != NO_CITY || adj[2 * b + 1] != NO_CITY) continue;
+        u32 ra = findRoot(parent, a), rb = findRoot(parent, b);
+        if (ra == rb) continue;
+        parent[ra] = rb;
+        adj[2 * a + (adj[2 * a] != NO_CITY)] = b;
+        adj[2 * b + (adj[2 * b] != NO_CITY)] = a;
+        taken++;
+    }
+
+    //chain fragments: from the far end of each one jump to the nearest free endpoint
+    u32 endCount = 0;
+    for (u32 i = 0; i < count; i++) {
+        localId[i] = NO_CITY;
+        if (adj[2 * i + 1] == NO_CITY) {
+            localId[i] = endCount;
+            endpoints[endCount] = i;
+            endCoords[endCount][0] = coords[i][0];
+            endCoords[endCount][1] = coords[i][1];
+            endCount++;
+        }
+    }
+    KdTree tree = BuildKdTree(arena, (const Vec2*)endCoords, endCount);
+    if (!tree.nodes) return NULL;
+
+    u32 pos = 0;
+    u32 cur = endpoints[0];
+    for (;;) {
+        KdRemove(&tree, localId[cur]);
+        u32 end = emitFragment(adj, cur, tour, &pos);
+        if (end != cur) KdRemove(&tree, localId[end]);
+        if (pos >= count) break;
+        u32 next;
+        if (KdNearest(&tree, coords[end], 1, KD_NO_CHILD, &next, NULL) == 0) {
+            LOG_ERROR("Greedy edge ran out of fragment endpoints at %u of %u cities", pos, count);
+            return NULL;
+        }
+        cur = endpoints[next];
+    }
+    return tour;
+}
+
+u32* SpaceFillingCurveTour(ScratchArena *arena, const Vec2* coords, u32 count) {
+    CityPermutation perm = HilbertOrder(arena, coords, count);
+    return perm.toOld;
+}
+
+u32* ConstructTour(ScratchArena *arena, ConstructMethod method, const Vec2* coords, u32 count,
+                   DistanceOracle* oracle, u32 threadCount) {
+    switch (method) {
+        case CONSTRUCT_NEAREST_NEIGHBOR: return NearestNeighborTour(arena, coords, count, 0);
+        case CONSTRUCT_GREEDY_EDGE:      return GreedyEdgeTour(arena, coords, count, oracle, threadCount);
+        case CONSTRUCT_SPACE_FILLING:    return SpaceFillingCurveTour(arena, coords, count);
+        default:
+            LOG_ERROR("Unknown construction method %d", method);
+            return NULL;
+    }
+}
+
+const char* ConstructMethodName(ConstructMethod method) {
+    switch (method) {
+        case CONSTRUCT_NEAREST_NEIGHBOR: return "nearest neighbor";
+        case CONSTRUCT_GREEDY_EDGE:      return "greedy edge";
+        case CONSTRUCT_SPACE_FILLING:    return "space filling curve";
+        default:                         return "unknown";
+    }
+}
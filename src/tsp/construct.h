@@ -0,0 +1,34 @@
+#ifndef tsp_CONSTRUCT_H
+#define tsp_CONSTRUCT_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_oracle.h"
+
+#define GREEDY_CANDIDATES 10
+
+typedef enum ConstructMethod {
+    CONSTRUCT_NEAREST_NEIGHBOR = 0,
+    CONSTRUCT_GREEDY_EDGE,
+    CONSTRUCT_SPACE_FILLING,
+    CONSTRUCT_METHOD_COUNT
+} ConstructMethod;
+
+//Every constructor returns a tour of count city ids allocated from the arena, NULL on failure.
+//Scratch state (trees, edge lists, degrees) is taken from the same arena and left there.
+
+//Repeatedly moves to the nearest unvisited city, found through a k-d tree that removes each
+//city as it is visited. O(n log n) on typical inputs.
+u32* NearestNeighborTour(ScratchArena *arena, const Vec2* coords, u32 count, u32 start);
+//Greedy matching over the GREEDY_CANDIDATES nearest neighbors of each city: candidate edges
+//are bucketed by length and taken shortest first while both ends have degree < 2 and no cycle
+//closes. Leftover fragments are chained nearest endpoint first. Lengths come from oracle.
+u32* GreedyEdgeTour(ScratchArena *arena, const Vec2* coords, u32 count, DistanceOracle* oracle, u32 threadCount);
+//Visits cities in Hilbert curve order.
+u32* SpaceFillingCurveTour(ScratchArena *arena, const Vec2* coords, u32 count);
+
+u32* ConstructTour(ScratchArena *arena, ConstructMethod method, const Vec2* coords, u32 count,
+                   DistanceOracle* oracle, u32 threadCount);
+const char* ConstructMethodName(ConstructMethod method);
+
+#endif
@@ -0,0 +1,481 @@
+#include <math.h>
+#include "dist_kernels.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "thread_pool.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define DIST_HAS_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define DIST_HAS_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#define DIST_CHUNKS_PER_THREAD 16
+//cvttpd_epi32 is signed: a rounded EUC_2D length at or above 2^31 comes back as INT_MIN, so
+//vector blocks holding one are redone with the scalar u32 pair.
+#define DIST_CVT_LIMIT 2147483648.0
+
+#define GEO_PI  3.141592
+#define GEO_RRR 6378.388
+
+//Products are kept in separate statements so the compiler cannot contract them into an FMA;
+//vector kernels and cached builds have to reproduce these values bit for bit.
+static inline f64 euclidSquared(const f32* a, const f32* b) {
+    f64 dx = (f64)b[0] - (f64)a[0];
+    f64 dy = (f64)b[1] - (f64)a[1];
+    f64 dx2 = dx * dx;
+    f64 dy2 = dy * dy;
+    return dx2 + dy2;
+}
+
+static inline f32 pairSqrEuc2D(const f32* a, const f32* b) {
+    f32 dx = b[0] - a[0];
+    f32 dy = b[1] - a[1];
+    f32 dx2 = dx * dx;
+    f32 dy2 = dy * dy;
+    return dx2 + dy2;
+}
+
+//Integer TSPLIB distances; the f32 pair functions below are these values converted, exact
+//while they stay under 2^24.
+static inline u32 intEuc2D(const f32* a, const f32* b) {
+    return (u32)(sqrt(euclidSquared(a, b)) + 0.5);
+}
+
+static inline u32 intCeil2D(const f32* a, const f32* b) {
+    return (u32)ceil(sqrt(euclidSquared(a, b)));
+}
+
+static inline u32 intAtt(const f32* a, const f32* b) {
+    f64 r = sqrt(euclidSquared(a, b) / 10.0);
+    u32 t = (u32)(r + 0.5);
+    return (t < r) ? t + 1 : t;
+}
+
+//TSPLIB GEO: coordinates are DDD.MM, degrees truncated as in Concorde/LKH.
+static inline f64 geoRadians(f32 v) {
+    f64 x = (f64)v;
+    s32 deg = (s32)x;
+    f64 min = x - deg;
+    return GEO_PI * (deg + 5.0 * min / 3.0) / 180.0;
+}
+
+static inline u32 intGeo(const f32* a, const f32* b) {
+    f64 latA = geoRadians(a[0]), lonA = geoRadians(a[1]);
+    f64 latB = geoRadians(b[0]), lonB = geoRadians(b[1]);
+    f64 q1 = cos(lonA - lonB);
+    f64 q2 = cos(latA - latB);
+    f64 q3 = cos(latA + latB);
+    return (u32)(GEO_RRR * acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
+}
+
+static inline f32 pairEuc2D(const f32* a, const f32* b) {
+    return (f32)intEuc2D(a, b);
+}
+
+static inline f32 pairCeil2D(const f32* a, const f32* b) {
+    return (f32)intCeil2D(a, b);
+}
+
+static inline f32 pairAtt(const f32* a, const f32* b) {
+    return (f32)intAtt(a, b);
+}
+
+static inline f32 pairGeo(const f32* a, const f32* b) {
+    return (f32)intGeo(a, b);
+}
+
+#define DEFINE_ROW_KERNEL(name, pair)                                       \
+    static void name(const Vec2* coords, u32 count, u32 row, f32* out) {    \
+        const f32* a = coords[row];                                         \
+        for (u32 j = row + 1; j < count; j++) {                             \
+            *out++ = pair(a, coords[j]);                                    \
+        }                                                                   \
+    }
+
+DEFINE_ROW_KERNEL(rowSqrEuc2D, pairSqrEuc2D)
+DEFINE_ROW_KERNEL(rowEuc2D, pairEuc2D)
+DEFINE_ROW_KERNEL(rowCeil2D, pairCeil2D)
+DEFINE_ROW_KERNEL(rowAtt, pairAtt)
+DEFINE_ROW_KERNEL(rowGeo, pairGeo)
+
+#undef DEFINE_ROW_KERNEL
+
+DistRowKernel SelectRowKernel(TspMetric metric) {
+    switch (metric) {
+        case TSP_METRIC_EUC_2D:     return rowEuc2D;
+        case TSP_METRIC_CEIL_2D:    return rowCeil2D;
+        case TSP_METRIC_ATT:        return rowAtt;
+        case TSP_METRIC_GEO:        return rowGeo;
+        case TSP_METRIC_SQR_EUC_2D: return rowSqrEuc2D;
+        default:                    return NULL;
+    }
+}
+
+f32 MetricDistance(TspMetric metric, const f32* a, const f32* b) {
+    switch (metric) {
+        case TSP_METRIC_EUC_2D:     return pairEuc2D(a, b);
+        case TSP_METRIC_CEIL_2D:    return pairCeil2D(a, b);
+        case TSP_METRIC_ATT:        return pairAtt(a, b);
+        case TSP_METRIC_GEO:        return pairGeo(a, b);
+        case TSP_METRIC_SQR_EUC_2D: return pairSqrEuc2D(a, b);
+        default:
+            LOG_ERROR("MetricDistance has no coordinates for metric %d", metric);
+            return 0.0f;
+    }
+}
+
+u32 MetricDistanceInt(TspMetric metric, const f32* a, const f32* b) {
+    switch (metric) {
+        case TSP_METRIC_EUC_2D:     return intEuc2D(a, b);
+        case TSP_METRIC_CEIL_2D:    return intCeil2D(a, b);
+        case TSP_METRIC_ATT:        return intAtt(a, b);
+        case TSP_METRIC_GEO:        return intGeo(a, b);
+        default:
+            LOG_ERROR("MetricDistanceInt has no integer form for metric %d", metric);
+            return 0;
+    }
+}
+
+//#############################
+//      SoA VECTOR KERNELS
+//#############################
+
+//Every vector kernel peels scalar pairs until the output row pointer reaches vector alignment,
+//streams aligned stores through the middle of the row and finishes the tail with scalar pairs.
+//The scalar pairs are the same pair functions the AoS kernels use, so results match bit for bit.
+#define SOA_SCALAR_PAIR(pair, soa, a, j) \
+    pair((a), (const f32[2]){ (soa)->x[(j)], (soa)->y[(j)] })
+
+#define DEFINE_SOA_SCALAR_KERNEL(name, pair)                                \
+    static void name(const CoordsSoA* soa, u32 row, f32* out) {            \
+        const f32 a[2] = { soa->x[row], soa->y[row] };                      \
+        for (u32 j = row + 1; j < soa->count; j++) {                        \
+            *out++ = SOA_SCALAR_PAIR(pair, soa, a, j);                      \
+        }                                                                   \
+    }
+
+DEFINE_SOA_SCALAR_KERNEL(rowSqrEuc2DSoa, pairSqrEuc2D)
+DEFINE_SOA_SCALAR_KERNEL(rowEuc2DSoa, pairEuc2D)
+DEFINE_SOA_SCALAR_KERNEL(rowCeil2DSoa, pairCeil2D)
+
+#undef DEFINE_SOA_SCALAR_KERNEL
+
+#ifdef DIST_HAS_SSE2
+
+static void rowSqrEuc2DSse2(const CoordsSoA* soa, u32 row, f32* out) {
+    const f32 a[2] = { soa->x[row], soa->y[row] };
+    u32 n = soa->count, j = row + 1;
+    for (; j < n && ((usize)out & 15); j++) *out++ = SOA_SCALAR_PAIR(pairSqrEuc2D, soa, a, j);
+
+    __m128 xi = _mm_set1_ps(a[0]);
+    __m128 yi = _mm_set1_ps(a[1]);
+    for (; j + 4 <= n; j += 4, out += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(soa->x + j), xi);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(soa->y + j), yi);
+        _mm_store_ps(out, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+    }
+    for (; j < n; j++) *out++ = SOA_SCALAR_PAIR(pairSqrEuc2D, soa, a, j);
+}
+
+//d + 0.5 for two pairs, still in f64; the caller truncates it.
+static inline __m128d eucPairSse2(const f32* x, const f32* y, __m128d xi, __m128d yi, __m128d half) {
+    __m128d xj = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)x)));
+    __m128d yj = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)y)));
+    __m128d dx = _mm_sub_pd(xj, xi);
+    __m128d dy = _mm_sub_pd(yj, yi);
+    __m128d d = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+    return _mm_add_pd(d, half);
+}
+
+static void rowEuc2DSse2(const CoordsSoA* soa, u32 row, f32* out) {
+    const f32 a[2] = { soa->x[row], soa->y[row] };
+    u32 n = soa->count, j = row + 1;
+    for (; j < n && ((usize)out & 15); j++) *out++ = SOA_SCALAR_PAIR(pairEuc2D, soa, a, j);
+
+    __m128d xi = _mm_set1_pd((f64)a[0]);
+    __m128d yi = _mm_set1_pd((f64)a[1]);
+    __m128d half = _mm_set1_pd(0.5);
+    __m128d limit = _mm_set1_pd(DIST_CVT_LIMIT);
+    for (; j + 4 <= n; j += 4, out += 4) {
+        __m128d lo = eucPairSse2(soa->x + j, soa->y + j, xi, yi, half);
+        __m128d hi = eucPairSse2(soa->x + j + 2, soa->y + j + 2, xi, yi, half);
+        if (_mm_movemask_pd(_mm_or_pd(_mm_cmpge_pd(lo, limit), _mm_cmpge_pd(hi, limit)))) {
+            for (u32 k = 0; k < 4; k++) out[k] = SOA_SCALAR_PAIR(pairEuc2D, soa, a, j + k);
+            continue;
+        }
+        _mm_store_ps(out, _mm_cvtepi32_ps(_mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi))));
+    }
+    for (; j < n; j++) *out++ = SOA_SCALAR_PAIR(pairEuc2D, soa, a, j);
+}
+
+#endif
+
+#ifdef DIST_HAS_AVX2
+
+TARGET_AVX2 static void rowSqrEuc2DAvx2(const CoordsSoA* soa, u32 row, f32* out) {
+    const f32 a[2] = { soa->x[row], soa->y[row] };
+    u32 n = soa->count, j = row + 1;
+    for (; j < n && ((usize)out & 31); j++) *out++ = SOA_SCALAR_PAIR(pairSqrEuc2D, soa, a, j);
+
+    __m256 xi = _mm256_set1_ps(a[0]);
+    __m256 yi = _mm256_set1_ps(a[1]);
+    for (; j + 8 <= n; j += 8, out += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(soa->x + j), xi);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(soa->y + j), yi);
+        _mm256_store_ps(out, _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+    }
+    for (; j < n; j++) *out++ = SOA_SCALAR_PAIR(pairSqrEuc2D, soa, a, j);
+}
+
+TARGET_AVX2 static inline __m256d distQuadAvx2(const f32* x, const f32* y, __m256d xi, __m256d yi) {
+    __m256d dx = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(x)), xi);
+    __m256d dy = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(y)), yi);
+    return _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+}
+
+TARGET_AVX2 static void rowEuc2DAvx2(const CoordsSoA* soa, u32 row, f32* out) {
+    const f32 a[2] = { soa->x[row], soa->y[row] };
+    u32 n = soa->count, j = row + 1;
+    for (; j < n && ((usize)out & 31); j++) *out++ = SOA_SCALAR_PAIR(pairEuc2D, soa, a, j);
+
+    __m256d xi = _mm256_set1_pd((f64)a[0]);
+    __m256d yi = _mm256_set1_pd((f64)a[1]);
+    __m256d half = _mm256_set1_pd(0.5);
+    __m256d limit = _mm256_set1_pd(DIST_CVT_LIMIT);
+    for (; j + 8 <= n; j += 8, out += 8) {
+        __m256d lo = _mm256_add_pd(distQuadAvx2(soa->x + j, soa->y + j, xi, yi), half);
+        __m256d hi = _mm256_add_pd(distQuadAvx2(soa->x + j + 4, soa->y + j + 4, xi, yi), half);
+        __m256d over = _mm256_or_pd(_mm256_cmp_pd(lo, limit, _CMP_GE_OQ), _mm256_cmp_pd(hi, limit, _CMP_GE_OQ));
+        if (_mm256_movemask_pd(over)) {
+            for (u32 k = 0; k < 8; k++) out[k] = SOA_SCALAR_PAIR(pairEuc2D, soa, a, j + k);
+            continue;
+        }
+        __m128 lo32 = _mm_cvtepi32_ps(_mm256_cvttpd_epi32(lo));
+        __m128 hi32 = _mm_cvtepi32_ps(_mm256_cvttpd_epi32(hi));
+        _mm256_store_ps(out, _mm256_insertf128_ps(_mm256_castps128_ps256(lo32), hi32, 1));
+    }
+    for (; j < n; j++) *out++ = SOA_SCALAR_PAIR(pairEuc2D, soa, a, j);
+}
+
+TARGET_AVX2 static void rowCeil2DAvx2(const CoordsSoA* soa, u32 row, f32* out) {
+    const f32 a[2] = { soa->x[row], soa->y[row] };
+    u32 n = soa->count, j = row + 1;
+    for (; j < n && ((usize)out & 31); j++) *out++ = SOA_SCALAR_PAIR(pairCeil2D, soa, a, j);
+
+    __m256d xi = _mm256_set1_pd((f64)a[0]);
+    __m256d yi = _mm256_set1_pd((f64)a[1]);
+    for (; j + 8 <= n; j += 8, out += 8) {
+        __m128 lo = _mm256_cvtpd_ps(_mm256_ceil_pd(distQuadAvx2(soa->x + j, soa->y + j, xi, yi)));
+        __m128 hi = _mm256_cvtpd_ps(_mm256_ceil_pd(distQuadAvx2(soa->x + j + 4, soa->y + j + 4, xi, yi)));
+        _mm256_store_ps(out, _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1));
+    }
+    for (; j < n; j++) *out++ = SOA_SCALAR_PAIR(pairCeil2D, soa, a, j);
+}
+
+#endif
+
+DistSimdLevel DetectSimdLevel(void) {
+#ifdef DIST_HAS_AVX2
+    if (__builtin_cpu_supports("avx2")) return DIST_SIMD_AVX2;
+#endif
+#ifdef DIST_HAS_SSE2
+    return DIST_SIMD_SSE2;
+#else
+    return DIST_SIMD_SCALAR;
+#endif
+}
+
+CoordsSoA CreateCoordsSoA(ScratchArena *arena, const Vec2* coords, u32 count) {
+    CoordsSoA soa = { .x = NULL, .y = NULL, .count = count };
+    soa.x = arenaScratchAlloc(arena, sizeof(f32) * count, ALIGN_64);
+    soa.y = arenaScratchAlloc(arena, sizeof(f32) * count, ALIGN_64);
+    if (!soa.x || !soa.y) {
+        LOG_ERROR("Arena too small for SoA copy of %u coordinates", count);
+        soa.x = soa.y = NULL;
+        return soa;
+    }
+    for (u32 i = 0; i < count; i++) {
+        soa.x[i] = coords[i][0];
+        soa.y[i] = coords[i][1];
+    }
+    return soa;
+}
+
+DistSoaRowKernel SelectSoaRowKernel(TspMetric metric, DistSimdLevel level) {
+    switch (metric) {
+        case TSP_METRIC_SQR_EUC_2D:
+#ifdef DIST_HAS_AVX2
+            if (level >= DIST_SIMD_AVX2) return rowSqrEuc2DAvx2;
+#endif
+#ifdef DIST_HAS_SSE2
+            if (level >= DIST_SIMD_SSE2) return rowSqrEuc2DSse2;
+#endif
+            return rowSqrEuc2DSoa;
+        case TSP_METRIC_EUC_2D:
+#ifdef DIST_HAS_AVX2
+            if (level >= DIST_SIMD_AVX2) return rowEuc2DAvx2;
+#endif
+#ifdef DIST_HAS_SSE2
+            if (level >= DIST_SIMD_SSE2) return rowEuc2DSse2;
+#endif
+            return rowEuc2DSoa;
+        case TSP_METRIC_CEIL_2D:
+#ifdef DIST_HAS_AVX2
+            if (level >= DIST_SIMD_AVX2) return rowCeil2DAvx2;
+#endif
+            return rowCeil2DSoa;
+        default:
+            return NULL;
+    }
+}
+
+#undef SOA_SCALAR_PAIR
+
+void FillRowOffsets(u32* rowOffset, u32 count) {
+    u32 index = 0;
+    for (u32 i = 0; i < count; i++) {
+        rowOffset[i] = index;
+        index += count - i - 1;
+    }
+}
+
+void FillDistanceRows(ScratchArena *arena, DistanceMatrix dm, const Vec2* coords, u32 count,
+                      TspMetric metric, DistSimdLevel level) {
+    DistSoaRowKernel soaKernel = SelectSoaRowKernel(metric, level);
+    if (soaKernel) {
+        CoordsSoA soa = CreateCoordsSoA(arena, coords, count);
+        if (soa.x) {
+            for (u32 i = 0; i + 1 < count; i++) {
+                soaKernel(&soa, i, dm.distances + dm.rowOffset[i]);
+            }
+            return;
+        }
+    }
+    DistRowKernel kernel = SelectRowKernel(metric);
+    for (u32 i = 0; i + 1 < count; i++) {
+        kernel(coords, count, i, dm.distances + dm.rowOffset[i]);
+    }
+}
+
+typedef struct {
+    DistanceMatrix dm;
+    const Vec2* coords;
+    const CoordsSoA* soa;
+    DistSoaRowKernel soaKernel;
+    DistRowKernel kernel;
+    const u32* chunkRows;
+    u32 count;
+} RowFillJob;
+
+static void fillChunkTask(memptr ctx, u32 chunk, u32 threadIndex) {
+    (void)threadIndex;
+    RowFillJob* job = (RowFillJob*)ctx;
+    for (u32 i = job->chunkRows[chunk]; i < job->chunkRows[chunk + 1]; i++) {
+        f32* out = job->dm.distances + job->dm.rowOffset[i];
+        if (job->soaKernel) {
+            job->soaKernel(job->soa, i, out);
+        } else {
+            job->kernel(job->coords, job->count, i, out);
+        }
+    }
+}
+
+//Cuts the packed triangle into chunkCount row ranges holding about the same number of entries
+//each. Row i holds count-i-1 entries, so early chunks are a few long rows and late chunks many
+//short ones.
+static void splitEqualWork(const u32* rowOffset, u32 count, u32 chunkCount, u32* chunkRows) {
+    usize total = PackedMatrixSize(count);
+    u32 row = 0;
+    chunkRows[0] = 0;
+    for (u32 c = 1; c < chunkCount; c++) {
+        usize target = total * c / chunkCount;
+        while (row + 1 < count && rowOffset[row] < target) row++;
+        chunkRows[c] = row;
+    }
+    chunkRows[chunkCount] = count - 1;
+}
+
+void FillDistanceRowsParallel(ScratchArena *arena, DistanceMatrix dm, const Vec2* coords, u32 count,
+                              TspMetric metric, DistSimdLevel level, u32 threadCount) {
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount < 2 || count < 2) {
+        FillDistanceRows(arena, dm, coords, count, metric, level);
+        return;
+    }
+
+    RowFillJob job = { .dm = dm, .coords = coords, .soa = NULL, .count = count };
+    job.kernel = SelectRowKernel(metric);
+    job.soaKernel = SelectSoaRowKernel(metric, level);
+    CoordsSoA soa;
+    if (job.soaKernel) {
+        soa = CreateCoordsSoA(arena, coords, count);
+        if (soa.x) {
+            job.soa = &soa;
+        } else {
+            job.soaKernel = NULL;
+        }
+    }
+
+    u32 chunkCount = threadCount * DIST_CHUNKS_PER_THREAD;
+    if (chunkCount > count - 1) chunkCount = count - 1;
+    u32* chunkRows = arenaScratchAlloc(arena, sizeof(u32) * (chunkCount + 1), ALIGN_64);
+    if (!chunkRows) {
+        LOG_WARN("Arena too small for %u row chunks, building serially", chunkCount);
+        FillDistanceRows(arena, dm, coords, count, metric, level);
+        return;
+    }
+    splitEqualWork(dm.rowOffset, count, chunkCount, chunkRows);
+    job.chunkRows = chunkRows;
+    runThreadPoolStealing(threadCount, chunkCount, fillChunkTask, &job);
+}
+
+static DistanceMatrix buildMatrix(ScratchArena *arena, const TspInstance* inst, u32 threadCount) {
+    DistanceMatrix dm = { .distances = NULL, .rowOffset = NULL };
+    u32 count = inst->count;
+    if (inst->status != TSP_LOAD_OK || count < 2) {
+        LOG_ERROR("Cannot build a distance matrix from a failed or trivial instance");
+        return dm;
+    }
+    if (PackedMatrixSize(count) > UINT32_MAX) {
+        LOG_ERROR("%u cities overflow the u32 rowOffset of a dense DistanceMatrix", count);
+        return dm;
+    }
+
+    dm.rowOffset = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    if (!dm.rowOffset) {
+        LOG_ERROR("Arena too small for rowOffset of %u cities", count);
+        return dm;
+    }
+    FillRowOffsets(dm.rowOffset, count);
+
+    if (inst->metric == TSP_METRIC_EXPLICIT) {
+        dm.distances = inst->weights;
+        return dm;
+    }
+
+    if (!SelectRowKernel(inst->metric) || !inst->coords) {
+        LOG_ERROR("No distance kernel for metric %d", inst->metric);
+        dm.rowOffset = NULL;
+        return dm;
+    }
+    dm.distances = arenaScratchAlloc(arena, PackedMatrixSize(count) * sizeof(f32) + sizeof(f32), ALIGN_64);
+    if (!dm.distances) {
+        LOG_ERROR("Arena too small for a %u city distance matrix", count);
+        dm.rowOffset = NULL;
+        return dm;
+    }
+    FillDistanceRowsParallel(arena, dm, inst->coords, count, inst->metric, DetectSimdLevel(), threadCount);
+    return dm;
+}
+
+DistanceMatrix BuildDistanceMatrix(ScratchArena *arena, const TspInstance* inst) {
+    return buildMatrix(arena, inst, 1);
+}
+
+DistanceMatrix BuildDistanceMatrixParallel(ScratchArena *arena, const TspInstance* inst, u32 threadCount) {
+    return buildMatrix(arena, inst, (threadCount == 0) ? hardwareThreadCount() : threadCount);
+}
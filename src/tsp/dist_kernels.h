@@ -0,0 +1,57 @@
+#ifndef tsp_DIST_KERNELS_H
+#define tsp_DIST_KERNELS_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+
+//Fills out[0 .. count-row-2] with d(row, j) for j = row+1 .. count-1, i.e. one packed row.
+typedef void (*DistRowKernel)(const Vec2* coords, u32 count, u32 row, f32* out);
+
+//Picks the row kernel for a coordinate metric once, so the pair loop itself never branches
+//on the metric. Returns NULL for EXPLICIT, which has no coordinates.
+DistRowKernel SelectRowKernel(TspMetric metric);
+f32 MetricDistance(TspMetric metric, const f32* a, const f32* b);
+//Exact integer TSPLIB distance for EUC_2D, CEIL_2D, ATT and GEO, 0 for other metrics.
+u32 MetricDistanceInt(TspMetric metric, const f32* a, const f32* b);
+
+typedef enum DistSimdLevel {
+    DIST_SIMD_SCALAR = 0,
+    DIST_SIMD_SSE2,
+    DIST_SIMD_AVX2
+} DistSimdLevel;
+
+//Structure-of-arrays copy of the coordinates for the vector kernels, 64-byte aligned.
+typedef struct {
+    f32* x;
+    f32* y;
+    u32 count;
+} CoordsSoA;
+
+//Same contract as DistRowKernel over SoA coordinates; out must be at least 4-byte aligned.
+typedef void (*DistSoaRowKernel)(const CoordsSoA* soa, u32 row, f32* out);
+
+DistSimdLevel DetectSimdLevel(void);
+CoordsSoA CreateCoordsSoA(ScratchArena *arena, const Vec2* coords, u32 count);
+//Best SoA kernel for metric at or below level (SQR_EUC_2D, EUC_2D, CEIL_2D), NULL otherwise.
+//Vector kernels produce the same bits as the scalar AoS kernels.
+DistSoaRowKernel SelectSoaRowKernel(TspMetric metric, DistSimdLevel level);
+
+void FillRowOffsets(u32* rowOffset, u32 count);
+//Fills every packed row of dm, through the SoA vector path when the metric has one. The SoA
+//copy is taken from the arena and left there.
+void FillDistanceRows(ScratchArena *arena, DistanceMatrix dm, const Vec2* coords, u32 count,
+                      TspMetric metric, DistSimdLevel level);
+//Builds the packed matrix for any loaded instance. Coordinate metrics run their row kernel
+//over every row; EXPLICIT adopts inst->weights as the distances array without copying.
+DistanceMatrix BuildDistanceMatrix(ScratchArena *arena, const TspInstance* inst);
+
+//Parallel mode: the packed triangle is cut into equal-work row chunks (16 per thread) that
+//workers fill in place, stealing chunks from each other when they finish early.
+//threadCount 0 uses every hardware thread.
+void FillDistanceRowsParallel(ScratchArena *arena, DistanceMatrix dm, const Vec2* coords, u32 count,
+                              TspMetric metric, DistSimdLevel level, u32 threadCount);
+DistanceMatrix BuildDistanceMatrixParallel(ScratchArena *arena, const TspInstance* inst, u32 threadCount);
+
+#endif
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "dist_matrix.h"
+#include "dist_kernels.h"
 #include "arena_base.h"
 #include "scratch_arena.h"
 
@@ -73,23 +74,21 @@ Vec2* LoadDistances(ScratchArena *arena, const char *filename, u32 size) {
     return dist_matrix;
 }
 
-DistanceMatrix CreateDistanceMatrix(ScratchArena *arena, Vec2* coords, u32 count) {
-    u32 flatSize = ((u32)count * (count - 1)) >> 1;
+static DistanceMatrix createMatrix(ScratchArena *arena, Vec2* coords, u32 count, u32 threadCount) {
+    usize flatSize = PackedMatrixSize(count);
     DistanceMatrix dm;
     arenaScratchPush(arena);
-    dm.distances = arenaScratchAlloc(arena, (flatSize * sizeof(f32)) + sizeof(f32), ALIGN_4);
-    dm.rowOffset = arenaScratchAlloc(arena, sizeof(f32) * count, ALIGN_4);
-    u32 index = 0;
-    for(u32 i = 0; i < count; i++) {
-        dm.rowOffset[i] = index;
-        for(u32 j = i + 1; j < count; j++) {
-            f32 dx = coords[j][0] - coords[i][0];
-            f32 dy = coords[j][1] - coords[i][1];
-            //flatArray[index] = sqrtf(dx*dx + dy*dy);
-            dm.distances[index] = dx*dx + dy*dy;
-            index++;
-        }
-    }
+    dm.distances = arenaScratchAlloc(arena, (flatSize * sizeof(f32)) + sizeof(f32), ALIGN_64);
+    dm.rowOffset = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_4);
+    FillRowOffsets(dm.rowOffset, count);
+    FillDistanceRowsParallel(arena, dm, coords, count, TSP_METRIC_SQR_EUC_2D, DetectSimdLevel(), threadCount);
     return dm;
 }
 
+DistanceMatrix CreateDistanceMatrix(ScratchArena *arena, Vec2* coords, u32 count) {
+    return createMatrix(arena, coords, count, 1);
+}
+
+DistanceMatrix CreateDistanceMatrixParallel(ScratchArena *arena, Vec2* coords, u32 count, u32 threadCount) {
+    return createMatrix(arena, coords, count, threadCount);
+}
@@ -13,8 +13,19 @@ typedef struct {
     u32* rowOffset;
 } DistanceMatrix;
 
+//Entries in the packed upper triangle and the flat index of (i, j) with i < j, computed
+//without a rowOffset table so loaders can fill the layout before it exists.
+static inline usize PackedMatrixSize(u32 count) {
+    return ((usize)count * (count - 1)) >> 1;
+}
+
+static inline usize PackedIndex(u32 count, u32 i, u32 j) {
+    return (usize)i * count - (((usize)i * (i + 1)) >> 1) + (j - i - 1);
+}
+
 u32 CountDataSize(const char *filename);
 Vec2* LoadDistances(ScratchArena *arena, const char *filename, u32 size);
 DistanceMatrix CreateDistanceMatrix(ScratchArena *arena, Vec2* coords, u32 count);
+DistanceMatrix CreateDistanceMatrixParallel(ScratchArena *arena, Vec2* coords, u32 count, u32 threadCount);
 
 #endif
@@ -0,0 +1,105 @@
+#include "dist_oracle.h"
+#include "dist_kernels.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+static u32 roundUpPow2(u32 v) {
+    u32 p = 1;
+    while (p < v && p < (1u << 31)) p <<= 1;
+    return p;
+}
+
+static DistCacheSlot* createPairCache(ScratchArena *arena, u32 slots) {
+    DistCacheSlot* cache = arenaScratchAlloc(arena, sizeof(DistCacheSlot) * slots, ALIGN_64);
+    if (!cache) {
+        LOG_WARN("Arena too small for a %u slot pair cache, running uncached", slots);
+        return NULL;
+    }
+    for (u32 s = 0; s < slots; s++) {
+        cache[s].key = ORACLE_EMPTY_KEY;
+    }
+    return cache;
+}
+
+DistanceOracle CreateDenseOracle(DistanceMatrix dm, u32 count, TspMetric metric) {
+    DistanceOracle oracle = {
+        .backend = DIST_BACKEND_DENSE,
+        .metric = metric,
+        .count = count,
+        .cacheMask = 0,
+        .dense = dm,
+        .coords = NULL,
+        .cache = NULL,
+        .cacheHits = 0,
+        .cacheMisses = 0
+    };
+    return oracle;
+}
+
+DistanceOracle CreateImplicitOracle(ScratchArena *arena, const TspInstance* inst, u32 cacheSlots) {
+    DistanceOracle oracle = {
+        .backend = DIST_BACKEND_IMPLICIT,
+        .metric = inst->metric,
+        .count = inst->count,
+        .cacheMask = 0,
+        .dense = { .distances = NULL, .rowOffset = NULL },
+        .coords = inst->coords,
+        .cache = NULL,
+        .cacheHits = 0,
+        .cacheMisses = 0
+    };
+    if (!inst->coords) {
+        LOG_ERROR("Implicit distances need coordinates, metric %d has none", inst->metric);
+        oracle.count = 0;
+        return oracle;
+    }
+    if (cacheSlots > 0) {
+        u32 slots = roundUpPow2(cacheSlots);
+        oracle.cache = createPairCache(arena, slots);
+        oracle.cacheMask = oracle.cache ? slots - 1 : 0;
+    }
+    return oracle;
+}
+
+DistanceOracle CreateDistanceOracle(ScratchArena *arena, const TspInstance* inst, DistBackend backend, u32 threadCount) {
+    if (backend == DIST_BACKEND_IMPLICIT && inst->metric != TSP_METRIC_EXPLICIT) {
+        return CreateImplicitOracle(arena, inst, ORACLE_DEFAULT_CACHE_SLOTS);
+    }
+    DistanceMatrix dm = BuildDistanceMatrixParallel(arena, inst, threadCount);
+    return CreateDenseOracle(dm, dm.distances ? inst->count : 0, inst->metric);
+}
+
+DistanceOracle ForkDistanceOracle(ScratchArena *arena, const DistanceOracle* oracle) {
+    DistanceOracle fork = *oracle;
+    fork.cacheHits = 0;
+    fork.cacheMisses = 0;
+    if (oracle->cache) {
+        fork.cache = createPairCache(arena, oracle->cacheMask + 1);
+        fork.cacheMask = fork.cache ? oracle->cacheMask : 0;
+    }
+    return fork;
+}
+
+//Direct-mapped on a multiplicative hash of the ordered pair: a hit costs one cache line, a
+//miss overwrites the slot, which keeps the most recently used pairs around.
+f32 ImplicitDistance(DistanceOracle* oracle, u32 i, u32 j) {
+    if (i > j) {
+        u32 t = i; i = j; j = t;
+    }
+    const Vec2* coords = oracle->coords;
+    if (!oracle->cache) {
+        return MetricDistance(oracle->metric, coords[i], coords[j]);
+    }
+
+    u64 key = ((u64)i << 32) | j;
+    DistCacheSlot* slot = &oracle->cache[(u32)((key * 0x9E3779B97F4A7C15ULL) >> 32) & oracle->cacheMask];
+    if (slot->key == key) {
+        oracle->cacheHits++;
+        return slot->value;
+    }
+    oracle->cacheMisses++;
+    f32 d = MetricDistance(oracle->metric, coords[i], coords[j]);
+    slot->key = key;
+    slot->value = d;
+    return d;
+}
@@ -0,0 +1,57 @@
+#ifndef tsp_DIST_ORACLE_H
+#define tsp_DIST_ORACLE_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+
+#define ORACLE_DEFAULT_CACHE_SLOTS 4096
+
+typedef enum DistBackend {
+    DIST_BACKEND_DENSE = 0,     //packed DistanceMatrix, O(n^2) memory
+    DIST_BACKEND_IMPLICIT       //computed from coordinates on demand, O(n) memory
+} DistBackend;
+
+typedef struct {
+    u64 key;                    //(i << 32) | j with i < j, ORACLE_EMPTY_KEY when unused
+    f32 value;
+    u32 _pad;
+} DistCacheSlot;
+
+//One lookup interface over every distance backend. Solvers hold a DistanceOracle* and call
+//OracleDistance; which storage sits behind it is chosen when the oracle is created.
+//The implicit backend's pair cache is not shared safely between threads: give each worker its
+//own copy through ForkDistanceOracle. Dense oracles are read-only and can be shared.
+typedef struct {
+    DistBackend backend;
+    TspMetric metric;
+    u32 count;
+    u32 cacheMask;
+    DistanceMatrix dense;
+    const Vec2* coords;
+    DistCacheSlot* cache;       //direct mapped, NULL when disabled
+    u64 cacheHits;
+    u64 cacheMisses;
+} DistanceOracle;
+
+#define ORACLE_EMPTY_KEY UINT64_MAX
+
+DistanceOracle CreateDenseOracle(DistanceMatrix dm, u32 count, TspMetric metric);
+//cacheSlots is rounded up to a power of two, 0 disables the cache.
+DistanceOracle CreateImplicitOracle(ScratchArena *arena, const TspInstance* inst, u32 cacheSlots);
+//Builds the requested backend for a loaded instance; EXPLICIT instances are always dense.
+DistanceOracle CreateDistanceOracle(ScratchArena *arena, const TspInstance* inst, DistBackend backend, u32 threadCount);
+DistanceOracle ForkDistanceOracle(ScratchArena *arena, const DistanceOracle* oracle);
+
+f32 ImplicitDistance(DistanceOracle* oracle, u32 i, u32 j);
+
+static inline f32 OracleDistance(DistanceOracle* oracle, u32 i, u32 j) {
+    if (i == j) return 0.0f;
+    if (oracle->backend == DIST_BACKEND_DENSE) {
+        return oracle->dense.distances[DM_INDEX(oracle->dense, i, j)];
+    }
+    return ImplicitDistance(oracle, i, j);
+}
+
+#endif
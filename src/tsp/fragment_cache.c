@@ -0,0 +1,208 @@
+#include <string.h>
+#include "fragment_cache.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "hash.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAGMENT_HAS_SSE2 1
+#endif
+
+#define FRAGMENT_HASH_SEED 0x9E3779B97F4A7C15ULL
+
+static inline u8 hashTag(u64 hash) {
+    return (u8)(hash & 0x7F);
+}
+
+static inline u32 lowestBit(u32 bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (u32)__builtin_ctz(bits);
+#else
+    u32 j = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        j++;
+    }
+    return j;
+#endif
+}
+
+//Bit i set when ctrl[i] == byte, over one group.
+static inline u32 matchGroup(const u8* ctrl, u8 byte) {
+#ifdef FRAGMENT_HAS_SSE2
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+    u32 bits = 0;
+    for (u32 i = 0; i < FRAGMENT_GROUP; i++) {
+        bits |= (u32)(ctrl[i] == byte) << i;
+    }
+    return bits;
+#endif
+}
+
+static inline void setCtrl(FragmentCache* cache, u32 index, u8 byte) {
+    cache->ctrl[index] = byte;
+    if (index < FRAGMENT_GROUP) cache->ctrl[cache->capacity + index] = byte;
+}
+
+static bool allocTable(FragmentCache* cache, u32 capacity) {
+    u8* ctrl = arenaScratchAlloc(cache->arena, (usize)capacity + FRAGMENT_GROUP, ALIGN_64);
+    FragmentSlot* slots = arenaScratchAlloc(cache->arena, sizeof(FragmentSlot) * (usize)capacity, ALIGN_64);
+    if (!ctrl || !slots) return false;
+    memset(ctrl, FRAGMENT_CTRL_EMPTY, (usize)capacity + FRAGMENT_GROUP);
+    cache->ctrl = ctrl;
+    cache->slots = slots;
+    cache->capacity = capacity;
+    return true;
+}
+
+FragmentCache CreateFragmentCache(ScratchArena *arena, u32 capacity, FragmentKeyWidth width) {
+    FragmentCache cache = { .arena = arena, .ctrl = NULL, .slots = NULL, .capacity = 0, .size = 0,
+                            .width = width, .grows = 0, .lookups = 0, .hits = 0, .inserts = 0 };
+    if (width != FRAGMENT_KEY_U16 && width != FRAGMENT_KEY_U32) {
+        LOG_ERROR("Fragment keys are u16 or u32 cities, not %d bytes", width);
+        return cache;
+    }
+    u32 rounded = FRAGMENT_MIN_CAPACITY;
+    while (rounded < capacity && rounded < (1u << 31)) rounded <<= 1;
+    if (!allocTable(&cache, rounded)) {
+        LOG_ERROR("Arena too small for a %u slot fragment cache", rounded);
+    }
+    return cache;
+}
+
+//Triangular probe over groups: position, then +16, +32, ... visits every group of a power of
+//two table. Returns the slot holding the key or, on a miss, UINT32_MAX with the first empty
+//slot seen in *empty.
+static u32 findSlot(const FragmentCache* cache, u64 hash, const void* path, u32 len, u32* empty) {
+    u32 mask = cache->capacity - 1;
+    u32 pos = (u32)(hash >> 7) & mask;
+    u8 tag = hashTag(hash);
+    usize keyBytes = (usize)len * cache->width;
+    for (u32 stride = FRAGMENT_GROUP;; stride += FRAGMENT_GROUP) {
+        const u8* group = cache->ctrl + pos;
+        for (u32 bits = matchGroup(group, tag); bits; bits &= bits - 1) {
+            u32 index = (pos + lowestBit(bits)) & mask;
+            const FragmentSlot* slot = &cache->slots[index];
+            if (slot->hash == hash && slot->len == len && memcmp(slot->key, path, keyBytes) == 0) return index;
+        }
+        u32 free = matchGroup(group, FRAGMENT_CTRL_EMPTY);
+        if (free) {
+            *empty = (pos + lowestBit(free)) & mask;
+            return UINT32_MAX;
+        }
+        pos = (pos + stride) & mask;
+    }
+}
+
+static u32 findEmpty(const FragmentCache* cache, u64 hash) {
+    u32 mask = cache->capacity - 1;
+    u32 pos = (u32)(hash >> 7) & mask;
+    for (u32 stride = FRAGMENT_GROUP;; stride += FRAGMENT_GROUP) {
+        u32 free = matchGroup(cache->ctrl + pos, FRAGMENT_CTRL_EMPTY);
+        if (free) return (pos + lowestBit(free)) & mask;
+        pos = (pos + stride) & mask;
+    }
+}
+
+static bool grow(FragmentCache* cache) {
+    FragmentSlot* old = cache->slots;
+    u8* oldCtrl = cache->ctrl;
+    u32 oldCapacity = cache->capacity;
+    if (oldCapacity >= (1u << 31) || !allocTable(cache, oldCapacity << 1)) {
+        LOG_ERROR("Arena too small to grow the fragment cache past %u slots", oldCapacity);
+        return false;
+    }
+    for (u32 i = 0; i < oldCapacity; i++) {
+        if (oldCtrl[i] == FRAGMENT_CTRL_EMPTY) continue;
+        u32 index = findEmpty(cache, old[i].hash);
+        cache->slots[index] = old[i];
+        setCtrl(cache, index, hashTag(old[i].hash));
+    }
+    cache->grows++;
+    return true;
+}
+
+bool FragmentCacheLookup(FragmentCache* cache, const void* path, u32 len, f32* cost, void* order) {
+    if (!cache->ctrl) return false;
+    cache->lookups++;
+    u64 hash = HashBytes(path, (usize)len * cache->width, FRAGMENT_HASH_SEED);
+    u32 empty;
+    u32 index = findSlot(cache, hash, path, len, &empty);
+    if (index == UINT32_MAX) return false;
+    const FragmentSlot* slot = &cache->slots[index];
+    *cost = slot->cost;
+    if (order) {
+        usize keyBytes = (usize)len * cache->width;
+        memcpy(order, slot->key + keyBytes, keyBytes);
+    }
+    cache->hits++;
+    return true;
+}
+
+bool FragmentCacheInsert(FragmentCache* cache, const void* path, u32 len, f32 cost, const void* order) {
+    if (!cache->ctrl) return false;
+    usize keyBytes = (usize)len * cache->width;
+    u64 hash = HashBytes(path, keyBytes, FRAGMENT_HASH_SEED);
+    u32 empty;
+    if (findSlot(cache, hash, path, len, &empty) != UINT32_MAX) return true;
+    if ((u64)(cache->size + 1) * FRAGMENT_LOAD_DEN > (u64)cache->capacity * FRAGMENT_LOAD_NUM) {
+        if (!grow(cache)) return false;
+        empty = findEmpty(cache, hash);
+    }
+    u8* key = arenaScratchAlloc(cache->arena, 2 * keyBytes, ALIGN_8);
+    if (!key) {
+        LOG_ERROR("Arena too small for a %u city fragment key", len);
+        return false;
+    }
+    memcpy(key, path, keyBytes);
+    memcpy(key + keyBytes, order ? order : path, keyBytes);
+    FragmentSlot* slot = &cache->slots[empty];
+    slot->hash = hash;
+    slot->key = key;
+    slot->len = len;
+    slot->cost = cost;
+    setCtrl(cache, empty, hashTag(hash));
+    cache->size++;
+    cache->inserts++;
+    return true;
+}
+
+//u32 adapter: a u32 cache passes keys straight through, a u16 cache narrows them on the stack.
+static bool narrowPath(const u32* path, u32 len, u16* out) {
+    if (len > FRAGMENT_MEMO_MAX_LEN) return false;
+    for (u32 i = 0; i < len; i++) {
+        if (path[i] > UINT16_MAX) return false;
+        out[i] = (u16)path[i];
+    }
+    return true;
+}
+
+static bool memoLookup(memptr ctx, const u32* path, u32 len, f32* cost, u32* order) {
+    FragmentCache* cache = (FragmentCache*)ctx;
+    if (cache->width == FRAGMENT_KEY_U32) return FragmentCacheLookup(cache, path, len, cost, order);
+    u16 key[FRAGMENT_MEMO_MAX_LEN] = { 0 }, best[FRAGMENT_MEMO_MAX_LEN] = { 0 };
+    if (!narrowPath(path, len, key) || !FragmentCacheLookup(cache, key, len, cost, best)) return false;
+    for (u32 i = 0; i < len; i++) {
+        order[i] = best[i];
+    }
+    return true;
+}
+
+static void memoInsert(memptr ctx, const u32* path, u32 len, f32 cost, const u32* order) {
+    FragmentCache* cache = (FragmentCache*)ctx;
+    if (cache->width == FRAGMENT_KEY_U32) {
+        FragmentCacheInsert(cache, path, len, cost, order);
+        return;
+    }
+    u16 key[FRAGMENT_MEMO_MAX_LEN] = { 0 }, best[FRAGMENT_MEMO_MAX_LEN] = { 0 };
+    if (!narrowPath(path, len, key) || !narrowPath(order, len, best)) return;
+    FragmentCacheInsert(cache, key, len, cost, best);
+}
+
+FragmentMemo FragmentCacheMemo(FragmentCache* cache) {
+    FragmentMemo memo = { .lookup = memoLookup, .insert = memoInsert, .ctx = cache };
+    return memo;
+}
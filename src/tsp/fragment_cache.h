@@ -0,0 +1,70 @@
+#ifndef tsp_FRAGMENT_CACHE_H
+#define tsp_FRAGMENT_CACHE_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+
+#define FRAGMENT_GROUP 16               //control bytes probed at once
+#define FRAGMENT_CTRL_EMPTY 0x80
+#define FRAGMENT_MIN_CAPACITY 16
+#define FRAGMENT_LOAD_NUM 7             //grows past 7/8 full
+#define FRAGMENT_LOAD_DEN 8
+#define FRAGMENT_MEMO_MAX_LEN 64        //longest key the FragmentMemo adapter narrows on the stack
+
+//Memo of solved windows. A window is keyed by its city sequence; the value is the optimal
+//fixed-end path over those cities and its length. lookup returns false on a miss; either
+//callback may decline a key it cannot store (too long, city ids too large).
+typedef bool (*FragmentLookup)(memptr ctx, const u32* path, u32 len, f32* cost, u32* order);
+typedef void (*FragmentInsert)(memptr ctx, const u32* path, u32 len, f32 cost, const u32* order);
+
+typedef struct {
+    FragmentLookup lookup;
+    FragmentInsert insert;
+    memptr ctx;
+} FragmentMemo;
+
+typedef enum FragmentKeyWidth {
+    FRAGMENT_KEY_U16 = 2,
+    FRAGMENT_KEY_U32 = 4
+} FragmentKeyWidth;
+
+typedef struct {
+    u64 hash;
+    u8* key;                            //len cities of the key then len of the order, width bytes each
+    u32 len;
+    f32 cost;
+} FragmentSlot;
+
+//Swiss-table style open addressing. ctrl holds one byte per slot, FRAGMENT_CTRL_EMPTY or the
+//low 7 hash bits, and repeats its first FRAGMENT_GROUP bytes past the end so a group load
+//never wraps. A probe compares a whole group of control bytes against the 7-bit tag at once
+//and only touches slots whose tag matched; it stops at the first group holding an empty byte.
+//Keys and tables live in the arena: growing doubles the table and leaves the old one behind.
+typedef struct {
+    ScratchArena* arena;
+    u8* ctrl;
+    FragmentSlot* slots;
+    u32 capacity;                       //power of two
+    u32 size;
+    FragmentKeyWidth width;
+    u32 grows;
+    u64 lookups;
+    u64 hits;
+    u64 inserts;
+} FragmentCache;
+
+//capacity is rounded up to a power of two of at least FRAGMENT_MIN_CAPACITY.
+FragmentCache CreateFragmentCache(ScratchArena *arena, u32 capacity, FragmentKeyWidth width);
+//path and order are arrays of len cities of the cache's width. order may be NULL.
+bool FragmentCacheLookup(FragmentCache* cache, const void* path, u32 len, f32* cost, void* order);
+//Keeps the first value stored for a key. Returns false only when the arena is exhausted.
+bool FragmentCacheInsert(FragmentCache* cache, const void* path, u32 len, f32 cost, const void* order);
+
+static inline f64 FragmentCacheHitRate(const FragmentCache* cache) {
+    return cache->lookups ? (f64)cache->hits / (f64)cache->lookups : 0.0;
+}
+
+//u32 view for WindowOptimize; a u16 cache declines keys naming cities above UINT16_MAX.
+FragmentMemo FragmentCacheMemo(FragmentCache* cache);
+
+#endif
@@ -0,0 +1,52 @@
+#include <string.h>
+#include "hash.h"
+
+#define HASH_P1 0x9E3779B185EBCA87ULL
+#define HASH_P2 0xC2B2AE3D27D4EB4FULL
+
+static inline u64 rotl64(u64 v, u32 r) {
+    return (v << r) | (v >> (64 - r));
+}
+
+static inline u64 hashRound(u64 h, u64 w) {
+    h += w * HASH_P2;
+    return rotl64(h, 31) * HASH_P1;
+}
+
+static inline u64 loadWord(const u8* p) {
+    u64 w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+u64 HashBytes(const void* data, usize size, u64 seed) {
+    const u8* p = (const u8*)data;
+    const u8* end = p + size;
+    u64 h0 = seed + HASH_P1 + HASH_P2, h1 = seed + HASH_P2, h2 = seed, h3 = seed - HASH_P1;
+
+    while (end - p >= 32) {
+        h0 = hashRound(h0, loadWord(p));
+        h1 = hashRound(h1, loadWord(p + 8));
+        h2 = hashRound(h2, loadWord(p + 16));
+        h3 = hashRound(h3, loadWord(p + 24));
+        p += 32;
+    }
+    u64 h = rotl64(h0, 1) + rotl64(h1, 7) + rotl64(h2, 12) + rotl64(h3, 18) + (u64)size;
+    while (end - p >= 8) {
+        h = hashRound(h, loadWord(p));
+        p += 8;
+    }
+    u64 tail = 0;
+    for (u32 shift = 0; p < end; p++, shift += 8) {
+        tail |= (u64)*p << shift;
+    }
+    h = hashRound(h, tail);
+
+    //murmur3 finalizer
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
@@ -0,0 +1,9 @@
+#ifndef tsp_HASH_H
+#define tsp_HASH_H
+
+#include "common_types.h"
+
+//64-bit hash read a word at a time, four independent lanes so it runs near memory speed.
+u64 HashBytes(const void* data, usize size, u64 seed);
+
+#endif
@@ -0,0 +1,251 @@
+#include "held_karp.h"
+#include "arena_base.h"
+#include "page_arena.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define HK_HAS_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define HK_HAS_AVX2 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//Fills row S of the table from rows S \ {j}; interior is the number of DP cities.
+typedef void (*HeldKarpRowKernel)(const f32* table, const f32* columns, u32 stride, u32 interior, u32 set, f32* row);
+
+static inline usize alignUp64(usize size) {
+    return (size + 63) & ~(usize)63;
+}
+
+static inline u32 laneStride(u32 interior) {
+    return (interior + HK_LANES - 1) & ~(u32)(HK_LANES - 1);
+}
+
+static inline u32 lowestBit(u32 bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (u32)__builtin_ctz(bits);
+#else
+    u32 j = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        j++;
+    }
+    return j;
+#endif
+}
+
+usize HeldKarpBlockSize(u32 maxCities) {
+    if (maxCities < 2 || maxCities > HK_MAX_CITIES) return 0;
+    u32 interior = maxCities - 1;
+    u32 stride = laneStride(interior);
+    return alignUp64(sizeof(f32) * ((usize)1 << interior) * stride)
+         + alignUp64(sizeof(f32) * (usize)stride * stride)
+         + 2 * alignUp64(sizeof(f32) * stride)
+         + alignUp64(sizeof(f32) * (usize)maxCities * maxCities);
+}
+
+HeldKarpSolver CreateHeldKarpSolver(PageArena *arena, u32 maxCities) {
+    HeldKarpSolver hk = { .table = NULL, .columns = NULL, .fromStart = NULL, .toEnd = NULL, .window = NULL,
+                          .maxCities = 0, .level = DIST_SIMD_SCALAR };
+    usize size = HeldKarpBlockSize(maxCities);
+    if (size == 0) {
+        LOG_ERROR("Held-Karp windows must have 2 to %u cities, not %u", HK_MAX_CITIES, maxCities);
+        return hk;
+    }
+    byte block = (byte)arenaPageAlloc(arena, size, ALIGN_64);
+    if (!block) {
+        LOG_ERROR("Page arena too small for a %u city Held-Karp table", maxCities);
+        return hk;
+    }
+    u32 interior = maxCities - 1;
+    u32 stride = laneStride(interior);
+    hk.table = (f32*)block;
+    block += alignUp64(sizeof(f32) * ((usize)1 << interior) * stride);
+    hk.columns = (f32*)block;
+    block += alignUp64(sizeof(f32) * (usize)stride * stride);
+    hk.fromStart = (f32*)block;
+    block += alignUp64(sizeof(f32) * stride);
+    hk.toEnd = (f32*)block;
+    block += alignUp64(sizeof(f32) * stride);
+    hk.window = (f32*)block;
+    hk.maxCities = maxCities;
+    hk.level = DetectSimdLevel();
+    return hk;
+}
+
+static void fillRowScalar(const f32* table, const f32* columns, u32 stride, u32 interior, u32 set, f32* row) {
+    for (u32 j = 0; j < stride; j++) {
+        row[j] = HK_INF;
+    }
+    for (u32 bits = set; bits; bits &= bits - 1) {
+        u32 j = lowestBit(bits);
+        const f32* prev = table + (usize)(set ^ (1u << j)) * stride;
+        const f32* col = columns + (usize)j * stride;
+        f32 best = HK_INF;
+        for (u32 i = 0; i < interior; i++) {
+            f32 c = prev[i] + col[i];
+            if (c < best) best = c;
+        }
+        row[j] = best;
+    }
+}
+
+#ifdef HK_HAS_SSE2
+static void fillRowSse2(const f32* table, const f32* columns, u32 stride, u32 interior, u32 set, f32* row) {
+    (void)interior;
+    const __m128 inf = _mm_set1_ps(HK_INF);
+    for (u32 j = 0; j < stride; j += 4) {
+        _mm_store_ps(row + j, inf);
+    }
+    for (u32 bits = set; bits; bits &= bits - 1) {
+        u32 j = lowestBit(bits);
+        const f32* prev = table + (usize)(set ^ (1u << j)) * stride;
+        const f32* col = columns + (usize)j * stride;
+        __m128 best = inf;
+        for (u32 i = 0; i < stride; i += 4) {
+            best = _mm_min_ps(best, _mm_add_ps(_mm_load_ps(prev + i), _mm_load_ps(col + i)));
+        }
+        best = _mm_min_ps(best, _mm_movehl_ps(best, best));
+        best = _mm_min_ss(best, _mm_shuffle_ps(best, best, 1));
+        row[j] = _mm_cvtss_f32(best);
+    }
+}
+#endif
+
+#ifdef HK_HAS_AVX2
+TARGET_AVX2 static void fillRowAvx2(const f32* table, const f32* columns, u32 stride, u32 interior, u32 set, f32* row) {
+    (void)interior;
+    const __m256 inf = _mm256_set1_ps(HK_INF);
+    for (u32 j = 0; j < stride; j += HK_LANES) {
+        _mm256_store_ps(row + j, inf);
+    }
+    for (u32 bits = set; bits; bits &= bits - 1) {
+        u32 j = lowestBit(bits);
+        const f32* prev = table + (usize)(set ^ (1u << j)) * stride;
+        const f32* col = columns + (usize)j * stride;
+        __m256 best = inf;
+        for (u32 i = 0; i < stride; i += HK_LANES) {
+            best = _mm256_min_ps(best, _mm256_add_ps(_mm256_load_ps(prev + i), _mm256_load_ps(col + i)));
+        }
+        __m128 half = _mm_min_ps(_mm256_castps256_ps128(best), _mm256_extractf128_ps(best, 1));
+        half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+        row[j] = _mm_cvtss_f32(half);
+    }
+}
+#endif
+
+static HeldKarpRowKernel selectRowKernel(DistSimdLevel level) {
+#ifdef HK_HAS_AVX2
+    if (level >= DIST_SIMD_AVX2) return fillRowAvx2;
+#endif
+#ifdef HK_HAS_SSE2
+    if (level >= DIST_SIMD_SSE2) return fillRowSse2;
+#endif
+    (void)level;
+    return fillRowScalar;
+}
+
+//Interior city k is window position k + 1. Padding lanes of every column are 0 and padding
+//lanes of every row HK_INF, so the vector kernels run over whole strides without masks.
+static void loadInterior(HeldKarpSolver* hk, const f32* dist, u32 count, u32 interior, u32 stride, u32 end) {
+    for (u32 j = 0; j < interior; j++) {
+        f32* col = hk->columns + (usize)j * stride;
+        for (u32 i = 0; i < stride; i++) {
+            col[i] = (i < interior && i != j) ? dist[(usize)(i + 1) * count + j + 1] : 0.0f;
+        }
+        hk->fromStart[j] = dist[j + 1];
+        hk->toEnd[j] = dist[(usize)(j + 1) * count + end];
+    }
+}
+
+f32 HeldKarpSolveDense(HeldKarpSolver* hk, const f32* dist, u32 count, HeldKarpShape shape, u32* order) {
+    if (!hk->table || !dist || !order || count == 0 || count > hk->maxCities) {
+        LOG_ERROR("Held-Karp solver holds windows of up to %u cities, asked for %u", hk->maxCities, count);
+        return -1.0f;
+    }
+    if (shape == HK_PATH && count < 3) {
+        for (u32 k = 0; k < count; k++) order[k] = k;
+        return (count == 2) ? dist[1] : 0.0f;
+    }
+    if (count < 2) {
+        order[0] = 0;
+        return 0.0f;
+    }
+
+    u32 end = (shape == HK_PATH) ? count - 1 : 0;
+    u32 interior = (shape == HK_PATH) ? count - 2 : count - 1;
+    u32 stride = laneStride(interior);
+    u32 full = (1u << interior) - 1;
+    f32* table = hk->table;
+    loadInterior(hk, dist, count, interior, stride, end);
+
+    HeldKarpRowKernel fillRow = selectRowKernel(hk->level);
+    for (u32 set = 1; set <= full; set++) {
+        f32* row = table + (usize)set * stride;
+        if (set & (set - 1)) {
+            fillRow(table, hk->columns, stride, interior, set, row);
+        } else {
+            for (u32 j = 0; j < stride; j++) {
+                row[j] = (set == (1u << j)) ? hk->fromStart[j] : HK_INF;
+            }
+        }
+    }
+
+    const f32* last = table + (usize)full * stride;
+    u32 j = 0;
+    f32 best = HK_INF;
+    for (u32 k = 0; k < interior; k++) {
+        f32 c = last[k] + hk->toEnd[k];
+        if (c < best) {
+            best = c;
+            j = k;
+        }
+    }
+
+    //walk back: the predecessor of j in S is any i reaching the stored minimum
+    order[0] = 0;
+    if (shape == HK_PATH) order[count - 1] = count - 1;
+    u32 set = full;
+    for (u32 k = interior; k >= 1; k--) {
+        order[k] = j + 1;
+        u32 prevSet = set ^ (1u << j);
+        if (!prevSet) break;
+        const f32* prev = table + (usize)prevSet * stride;
+        const f32* col = hk->columns + (usize)j * stride;
+        u32 pick = 0;
+        f32 pickCost = HK_INF;
+        for (u32 bits = prevSet; bits; bits &= bits - 1) {
+            u32 i = lowestBit(bits);
+            f32 c = prev[i] + col[i];
+            if (c < pickCost) {
+                pickCost = c;
+                pick = i;
+            }
+        }
+        set = prevSet;
+        j = pick;
+    }
+    return best;
+}
+
+f32 HeldKarpSolve(HeldKarpSolver* hk, DistanceMatrix dm, const u32* cities, u32 count,
+                  HeldKarpShape shape, u32* order) {
+    if (!hk->window || !cities || count > hk->maxCities) {
+        LOG_ERROR("Held-Karp solver holds windows of up to %u cities, asked for %u", hk->maxCities, count);
+        return -1.0f;
+    }
+    for (u32 a = 0; a < count; a++) {
+        for (u32 b = 0; b < count; b++) {
+            hk->window[(usize)a * count + b] = (a == b) ? 0.0f
+                : dm.distances[DM_INDEX(dm, cities[a], cities[b])];
+        }
+    }
+    f32 length = HeldKarpSolveDense(hk, hk->window, count, shape, order);
+    if (length < 0.0f) return length;
+    for (u32 k = 0; k < count; k++) {
+        order[k] = cities[order[k]];
+    }
+    return length;
+}
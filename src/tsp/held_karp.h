@@ -0,0 +1,45 @@
+#ifndef tsp_HELD_KARP_H
+#define tsp_HELD_KARP_H
+
+#include "common_types.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "dist_kernels.h"
+
+#define HK_MAX_CITIES 24
+#define HK_LANES 8                  //table rows and distance columns are padded to this many f32
+#define HK_INF 1e30f
+
+typedef enum HeldKarpShape {
+    HK_PATH = 0,                    //open path from window position 0 to position count-1
+    HK_CYCLE                        //closed cycle through position 0
+} HeldKarpShape;
+
+//Solver state sized once for windows of up to maxCities. The DP visits the interior cities
+//(all but the fixed ends) as a bitmask S; table[S * stride + j] is the shortest path from the
+//start through every city of S ending at interior city j, HK_INF when j is not in S. Every
+//entry is written exactly once, so the table needs no clearing between solves.
+typedef struct {
+    f32* table;                     //(1 << interior) rows of stride entries
+    f32* columns;                   //columns[j * stride + i] = d(i, j) between interior cities
+    f32* fromStart;
+    f32* toEnd;                     //to the path end, or back to the start for a cycle
+    f32* window;                    //dense gather buffer for HeldKarpSolve
+    u32 maxCities;
+    DistSimdLevel level;
+} HeldKarpSolver;
+
+//Bytes CreateHeldKarpSolver takes from its page arena. The table dominates: a cycle over n
+//cities has n-1 interior cities, so 24 cities need 2^23 rows (about 800 MiB) and 20 cities 50 MiB.
+usize HeldKarpBlockSize(u32 maxCities);
+HeldKarpSolver CreateHeldKarpSolver(PageArena *arena, u32 maxCities);
+
+//Exact solve over a dense row-major count x count matrix, dist[i * count + j] = d(i, j); the
+//matrix may be asymmetric. order receives the window positions of the optimal path (0 first,
+//count-1 last) or cycle (0 first); returns its length, or a negative value on bad input.
+f32 HeldKarpSolveDense(HeldKarpSolver* hk, const f32* dist, u32 count, HeldKarpShape shape, u32* order);
+//Same over cities of a packed matrix: order receives city ids, cities[0] first.
+f32 HeldKarpSolve(HeldKarpSolver* hk, DistanceMatrix dm, const u32* cities, u32 count,
+                  HeldKarpShape shape, u32* order);
+
+#endif
@@ -0,0 +1,199 @@
+#include "hilbert.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1u << RADIX_BITS)
+
+u32 HilbertKey(u32 x, u32 y, u32 order) {
+    u32 n = 1u << order;
+    u32 d = 0;
+    for (u32 s = n >> 1; s > 0; s >>= 1) {
+        u32 rx = (x & s) ? 1 : 0;
+        u32 ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        //rotate the quadrant so the sub-curve starts and ends where the parent expects
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            u32 t = x; x = y; y = t;
+        }
+    }
+    return d;
+}
+
+CityPermutation IdentityPermutation(ScratchArena *arena, u32 count) {
+    CityPermutation perm = { .toNew = NULL, .toOld = NULL, .count = 0 };
+    perm.toNew = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    perm.toOld = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    if (!perm.toNew || !perm.toOld) {
+        LOG_ERROR("Arena too small for a %u city permutation", count);
+        perm.toNew = NULL;
+        perm.toOld = NULL;
+        return perm;
+    }
+    for (u32 i = 0; i < count; i++) {
+        perm.toNew[i] = i;
+        perm.toOld[i] = i;
+    }
+    perm.count = count;
+    return perm;
+}
+
+CityPermutation HilbertOrder(ScratchArena *arena, const Vec2* coords, u32 count) {
+    CityPermutation perm = { .toNew = NULL, .toOld = NULL, .count = 0 };
+    if (!coords || count == 0) {
+        LOG_ERROR("Hilbert ordering needs coordinates");
+        return perm;
+    }
+    perm.toNew = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    perm.toOld = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    if (!perm.toNew || !perm.toOld) {
+        LOG_ERROR("Arena too small for a %u city permutation", count);
+        perm.toNew = NULL;
+        perm.toOld = NULL;
+        return perm;
+    }
+
+    //sort buffers stay in the arena, like the SoA copies of the distance kernels
+    u32* keys = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    u32* keysTmp = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    u32* ids = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    u32* idsTmp = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    if (!keys || !keysTmp || !ids || !idsTmp) {
+        LOG_ERROR("Arena too small to sort %u cities along the Hilbert curve", count);
+        perm.toNew = NULL;
+        perm.toOld = NULL;
+        return perm;
+    }
+
+    f32 minX = coords[0][0], maxX = minX, minY = coords[0][1], maxY = minY;
+    for (u32 i = 1; i < count; i++) {
+        if (coords[i][0] < minX) minX = coords[i][0];
+        if (coords[i][0] > maxX) maxX = coords[i][0];
+        if (coords[i][1] < minY) minY = coords[i][1];
+        if (coords[i][1] > maxY) maxY = coords[i][1];
+    }
+    f64 extent = ((f64)maxX - minX > (f64)maxY - minY) ? (f64)maxX - minX : (f64)maxY - minY;
+    f64 scale = (extent > 0.0) ? (f64)((1u << HILBERT_ORDER) - 1) / extent : 0.0;
+    for (u32 i = 0; i < count; i++) {
+        u32 gx = (u32)(((f64)coords[i][0] - minX) * scale);
+        u32 gy = (u32)(((f64)coords[i][1] - minY) * scale);
+        keys[i] = HilbertKey(gx, gy, HILBERT_ORDER);
+        ids[i] = i;
+    }
+
+    //stable LSD radix sort of (key, id), 8 bits per pass
+    for (u32 shift = 0; shift < 32; shift += RADIX_BITS) {
+        u32 histogram[RADIX_BUCKETS] = { 0 };
+        for (u32 i = 0; i < count; i++) {
+            histogram[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+        u32 sum = 0;
+        for (u32 b = 0; b < RADIX_BUCKETS; b++) {
+            u32 c = histogram[b];
+            histogram[b] = sum;
+            sum += c;
+        }
+        for (u32 i = 0; i < count; i++) {
+            u32 slot = histogram[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            keysTmp[slot] = keys[i];
+            idsTmp[slot] = ids[i];
+        }
+        u32* t = keys; keys = keysTmp; keysTmp = t;
+        t = ids; ids = idsTmp; idsTmp = t;
+    }
+
+    for (u32 n = 0; n < count; n++) {
+        perm.toOld[n] = ids[n];
+    }
+    for (u32 n = 0; n < count; n++) {
+        perm.toNew[perm.toOld[n]] = n;
+    }
+    perm.count = count;
+    return perm;
+}
+
+TspInstance RenumberInstance(ScratchArena *arena, const TspInstance* inst, const CityPermutation* perm) {
+    TspInstance out = *inst;
+    u32 count = inst->count;
+    if (inst->status != TSP_LOAD_OK || perm->count != count) {
+        LOG_ERROR("Permutation of %u cities does not fit an instance of %u", perm->count, count);
+        out.status = TSP_LOAD_ERR_PARSE;
+        out.coords = NULL;
+        out.weights = NULL;
+        return out;
+    }
+
+    if (inst->coords) {
+        Vec2* coords = arenaScratchAlloc(arena, sizeof(Vec2) * count, ALIGN_16);
+        if (!coords) {
+            LOG_ERROR("Arena too small for %u renumbered coordinates", count);
+            out.status = TSP_LOAD_ERR_ALLOC;
+            out.coords = NULL;
+            return out;
+        }
+        for (u32 n = 0; n < count; n++) {
+            coords[n][0] = inst->coords[perm->toOld[n]][0];
+            coords[n][1] = inst->coords[perm->toOld[n]][1];
+        }
+        out.coords = coords;
+        out.dimension = count;
+    }
+
+    if (inst->weights && count > 1) {
+        f32* weights = arenaScratchAlloc(arena, PackedMatrixSize(count) * sizeof(f32) + sizeof(f32), ALIGN_64);
+        if (!weights) {
+            LOG_ERROR("Arena too small for %u renumbered edge weights", count);
+            out.status = TSP_LOAD_ERR_ALLOC;
+            out.weights = NULL;
+            return out;
+        }
+        f32* w = weights;
+        for (u32 i = 0; i < count; i++) {
+            u32 oi = perm->toOld[i];
+            for (u32 j = i + 1; j < count; j++) {
+                u32 oj = perm->toOld[j];
+                *w++ = (oi < oj) ? inst->weights[PackedIndex(count, oi, oj)]
+                                 : inst->weights[PackedIndex(count, oj, oi)];
+            }
+        }
+        out.weights = weights;
+    }
+    return out;
+}
+
+TspInstance LoadTspInstanceHilbert(ScratchArena *arena, const char *filename, u32 threadCount,
+                                   CityPermutation* perm) {
+    TspInstance inst = LoadTspInstanceParallel(arena, filename, threadCount);
+    perm->toNew = NULL;
+    perm->toOld = NULL;
+    perm->count = 0;
+    if (inst.status != TSP_LOAD_OK) {
+        return inst;
+    }
+    if (!inst.coords) {
+        *perm = IdentityPermutation(arena, inst.count);
+        return inst;
+    }
+    *perm = HilbertOrder(arena, (const Vec2*)inst.coords, inst.count);
+    if (!perm->toOld) {
+        inst.status = TSP_LOAD_ERR_ALLOC;
+        return inst;
+    }
+    return RenumberInstance(arena, &inst, perm);
+}
+
+void TourToOriginal(const CityPermutation* perm, const u32* tour, u32* out, u32 count) {
+    for (u32 k = 0; k < count; k++) {
+        out[k] = perm->toOld[tour[k]];
+    }
+}
+
+void TourToRenumbered(const CityPermutation* perm, const u32* tour, u32* out, u32 count) {
+    for (u32 k = 0; k < count; k++) {
+        out[k] = perm->toNew[tour[k]];
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef tsp_HILBERT_H
+#define tsp_HILBERT_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+
+#define HILBERT_ORDER 16            //grid of 2^16 x 2^16 cells, keys fit a u32
+
+//toNew[original id] = renumbered id and toOld[renumbered id] = original id.
+typedef struct {
+    u32* toNew;
+    u32* toOld;
+    u32 count;
+} CityPermutation;
+
+//Distance along the Hilbert curve of cell (x, y) on a 2^order grid.
+u32 HilbertKey(u32 x, u32 y, u32 order);
+
+//Orders cities along the Hilbert curve through their bounding box (one scale on both axes);
+//cities sharing a cell keep file order. Sorting is a stable LSD radix sort, O(n).
+CityPermutation HilbertOrder(ScratchArena *arena, const Vec2* coords, u32 count);
+CityPermutation IdentityPermutation(ScratchArena *arena, u32 count);
+
+//Copy of inst with city ids relabelled by perm: coords are permuted, EXPLICIT weights are
+//rewritten in the new packed order. Build the distance matrix from the result.
+TspInstance RenumberInstance(ScratchArena *arena, const TspInstance* inst, const CityPermutation* perm);
+//Loads filename and renumbers it along the Hilbert curve; perm receives the mapping needed to
+//translate tours back. EXPLICIT instances have no coordinates and keep the identity order.
+TspInstance LoadTspInstanceHilbert(ScratchArena *arena, const char *filename, u32 threadCount,
+                                   CityPermutation* perm);
+
+//out may alias tour.
+void TourToOriginal(const CityPermutation* perm, const u32* tour, u32* out, u32 count);
+void TourToRenumbered(const CityPermutation* perm, const u32* tour, u32* out, u32 count);
+
+#endif
@@ -0,0 +1,300 @@
+#include "kd_tree.h"
+#include "thread_pool.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+#define KD_QUERY_BLOCK 256
+#define KD_STACK_DEPTH 128
+
+typedef struct {
+    KdTree* tree;
+    const Vec2* coords;
+} KdBuild;
+
+//Total order on cities along one axis; ties fall back to the id so the tree and every query
+//built on it are deterministic.
+static inline bool coordLess(const Vec2* coords, u32 axis, u32 a, u32 b) {
+    f32 ca = coords[a][axis], cb = coords[b][axis];
+    return (ca < cb) || (ca == cb && a < b);
+}
+
+//Quickselect: afterwards index[kth] holds the city of rank kth in [begin, end), with smaller
+//ones before it and larger ones after.
+static void selectNth(const Vec2* coords, u32 axis, u32* index, u32 begin, u32 end, u32 kth) {
+    while (end - begin > 1) {
+        u32 mid = begin + (end - begin) / 2;
+        u32 last = end - 1;
+        //median of three moved to last as the pivot
+        if (coordLess(coords, axis, index[mid], index[begin])) { u32 t = index[mid]; index[mid] = index[begin]; index[begin] = t; }
+        if (coordLess(coords, axis, index[last], index[begin])) { u32 t = index[last]; index[last] = index[begin]; index[begin] = t; }
+        if (coordLess(coords, axis, index[mid], index[last])) { u32 t = index[mid]; index[mid] = index[last]; index[last] = t; }
+
+        u32 pivot = index[last];
+        u32 store = begin;
+        for (u32 i = begin; i < last; i++) {
+            if (coordLess(coords, axis, index[i], pivot)) {
+                u32 t = index[i]; index[i] = index[store]; index[store] = t;
+                store++;
+            }
+        }
+        index[last] = index[store];
+        index[store] = pivot;
+
+        if (store == kth) return;
+        if (kth < store) {
+            end = store;
+        } else {
+            begin = store + 1;
+        }
+    }
+}
+
+static u32 buildNode(KdBuild* b, u32 begin, u32 end) {
+    KdTree* tree = b->tree;
+    u32 id = tree->nodeCount++;
+    KdNode* node = &tree->nodes[id];
+    node->begin = begin;
+    node->end = end;
+    node->left = KD_NO_CHILD;
+    node->right = KD_NO_CHILD;
+    node->axis = 0;
+    node->split = 0.0f;
+    if (end - begin <= KD_LEAF_SIZE) return id;
+
+    const Vec2* coords = b->coords;
+    f32 minX = coords[tree->index[begin]][0], maxX = minX;
+    f32 minY = coords[tree->index[begin]][1], maxY = minY;
+    for (u32 i = begin + 1; i < end; i++) {
+        const f32* p = coords[tree->index[i]];
+        if (p[0] < minX) minX = p[0];
+        if (p[0] > maxX) maxX = p[0];
+        if (p[1] < minY) minY = p[1];
+        if (p[1] > maxY) maxY = p[1];
+    }
+    u32 axis = (maxY - minY > maxX - minX) ? 1 : 0;
+    u32 mid = begin + (end - begin) / 2;
+    selectNth(coords, axis, tree->index, begin, end, mid);
+
+    node->axis = axis;
+    node->split = coords[tree->index[mid]][axis];
+    u32 left = buildNode(b, begin, mid);
+    u32 right = buildNode(b, mid, end);
+    tree->nodes[id].left = left;
+    tree->nodes[id].right = right;
+    return id;
+}
+
+//Median splits of a range larger than a leaf leave both halves with at least KD_LEAF_SIZE / 2
+//cities, which bounds the leaf count and so the node count.
+static u32 maxNodeCount(u32 count) {
+    if (count <= KD_LEAF_SIZE) return 1;
+    return 2 * (count / (KD_LEAF_SIZE / 2)) + 1;
+}
+
+KdTree BuildKdTree(ScratchArena *arena, const Vec2* coords, u32 count) {
+    KdTree tree = { .nodes = NULL, .index = NULL, .points = NULL, .live = NULL, .position = NULL,
+                    .nodeCount = 0, .count = 0, .liveCount = 0 };
+    if (!coords || count == 0) {
+        LOG_ERROR("Cannot build a k-d tree without coordinates");
+        return tree;
+    }
+
+    tree.nodes = arenaScratchAlloc(arena, sizeof(KdNode) * maxNodeCount(count), ALIGN_64);
+    tree.index = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    tree.points = arenaScratchAlloc(arena, sizeof(Vec2) * count, ALIGN_64);
+    tree.live = arenaScratchAlloc(arena, sizeof(u32) * maxNodeCount(count), ALIGN_64);
+    tree.position = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    if (!tree.nodes || !tree.index || !tree.points || !tree.live || !tree.position) {
+        LOG_ERROR("Arena too small for a k-d tree over %u cities", count);
+        tree.nodes = NULL;
+        tree.index = NULL;
+        tree.points = NULL;
+        tree.live = NULL;
+        tree.position = NULL;
+        return tree;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        tree.index[i] = i;
+    }
+    KdBuild b = { .tree = &tree, .coords = coords };
+    buildNode(&b, 0, count);
+    for (u32 i = 0; i < count; i++) {
+        tree.points[i][0] = coords[tree.index[i]][0];
+        tree.points[i][1] = coords[tree.index[i]][1];
+        tree.position[tree.index[i]] = i;
+    }
+    for (u32 n = 0; n < tree.nodeCount; n++) {
+        tree.live[n] = tree.nodes[n].end - tree.nodes[n].begin;
+    }
+    tree.count = count;
+    tree.liveCount = count;
+    return tree;
+}
+
+//Walks from the root to the leaf holding city, then drops one live city from every node on
+//that path and swaps city behind the leaf's live prefix.
+void KdRemove(KdTree* tree, u32 city) {
+    u32 slot = tree->position[city];
+    if (slot >= tree->count || tree->liveCount == 0) return;
+
+    u32 path[KD_STACK_DEPTH];
+    u32 depth = 0;
+    u32 n = 0;
+    path[depth++] = n;
+    while (tree->nodes[n].left != KD_NO_CHILD) {
+        u32 left = tree->nodes[n].left;
+        n = (slot < tree->nodes[left].end) ? left : tree->nodes[n].right;
+        path[depth++] = n;
+    }
+    u32 last = tree->nodes[n].begin + tree->live[n] - 1;
+    if (tree->live[n] == 0 || slot > last) return;      //already removed
+
+    for (u32 d = 0; d < depth; d++) {
+        tree->live[path[d]]--;
+    }
+    u32 other = tree->index[last];
+    tree->index[last] = city;
+    tree->index[slot] = other;
+    tree->position[city] = last;
+    tree->position[other] = slot;
+    f32 x = tree->points[slot][0], y = tree->points[slot][1];
+    tree->points[slot][0] = tree->points[last][0];
+    tree->points[slot][1] = tree->points[last][1];
+    tree->points[last][0] = x;
+    tree->points[last][1] = y;
+    tree->liveCount--;
+}
+
+//Keeps the best k seen so far sorted nearest first; returns the new found count.
+static inline u32 offerCandidate(u32* ids, f32* dist2, u32 found, u32 k, u32 id, f32 d) {
+    if (found == k) {
+        if (d > dist2[k - 1] || (d == dist2[k - 1] && id > ids[k - 1])) return found;
+    } else {
+        found++;
+    }
+    u32 slot = found - 1;
+    while (slot > 0 && (d < dist2[slot - 1] || (d == dist2[slot - 1] && id < ids[slot - 1]))) {
+        ids[slot] = ids[slot - 1];
+        dist2[slot] = dist2[slot - 1];
+        slot--;
+    }
+    ids[slot] = id;
+    dist2[slot] = d;
+    return found;
+}
+
+u32 KdNearest(const KdTree* tree, const f32* query, u32 k, u32 exclude, u32* outIds, f32* outDist2) {
+    if (k == 0 || tree->liveCount == 0) return 0;
+    if (k > CANDIDATE_MAX_K) k = CANDIDATE_MAX_K;
+    f32 localDist[CANDIDATE_MAX_K];
+    f32* dist2 = outDist2 ? outDist2 : localDist;
+
+    u32 stackNode[KD_STACK_DEPTH];
+    f32 stackBound[KD_STACK_DEPTH];
+    u32 top = 0;
+    u32 found = 0;
+    stackNode[top] = 0;
+    stackBound[top] = 0.0f;
+    top++;
+
+    while (top > 0) {
+        top--;
+        if (found == k && stackBound[top] > dist2[k - 1]) continue;
+        u32 n = stackNode[top];
+        if (tree->live[n] == 0) continue;
+        const KdNode* node = &tree->nodes[n];
+
+        //descend to the leaf on the query's side, deferring every far side with the plane gap
+        //as its lower bound
+        while (node->left != KD_NO_CHILD) {
+            f32 diff = query[node->axis] - node->split;
+            u32 nearChild = (diff < 0.0f) ? node->left : node->right;
+            u32 farChild = (diff < 0.0f) ? node->right : node->left;
+            stackNode[top] = farChild;
+            stackBound[top] = diff * diff;
+            top++;
+            n = nearChild;
+            node = &tree->nodes[n];
+        }
+
+        u32 liveEnd = node->begin + tree->live[n];
+        for (u32 i = node->begin; i < liveEnd; i++) {
+            u32 id = tree->index[i];
+            if (id == exclude) continue;
+            f32 dx = tree->points[i][0] - query[0];
+            f32 dy = tree->points[i][1] - query[1];
+            f32 dx2 = dx * dx;
+            f32 dy2 = dy * dy;
+            found = offerCandidate(outIds, dist2, found, k, id, dx2 + dy2);
+        }
+    }
+    return found;
+}
+
+typedef struct {
+    const KdTree* tree;
+    CandidateLists lists;
+} CandidateJob;
+
+//One item is a block of consecutive cities in tree order, so neighboring queries walk the
+//same leaves while they are still in cache.
+static void candidateBlockTask(memptr ctx, u32 item, u32 threadIndex) {
+    (void)threadIndex;
+    CandidateJob* job = (CandidateJob*)ctx;
+    const KdTree* tree = job->tree;
+    u32 begin = item * KD_QUERY_BLOCK;
+    u32 end = begin + KD_QUERY_BLOCK;
+    if (end > tree->count) end = tree->count;
+
+    for (u32 t = begin; t < end; t++) {
+        u32 city = tree->index[t];
+        u32* out = job->lists.neighbors + (usize)city * job->lists.stride;
+        KdNearest(tree, tree->points[t], job->lists.k, city, out, NULL);
+        for (u32 s = job->lists.k; s < job->lists.stride; s++) {
+            out[s] = KD_NO_CHILD;
+        }
+    }
+}
+
+CandidateLists BuildCandidateListsFromTree(ScratchArena *arena, const KdTree* tree, u32 k, u32 threadCount) {
+    CandidateLists lists = { .neighbors = NULL, .k = 0, .stride = 0, .count = 0 };
+    if (!tree->nodes || tree->count < 2) {
+        LOG_ERROR("Candidate lists need a k-d tree over at least two cities");
+        return lists;
+    }
+    if (k > tree->count - 1) k = tree->count - 1;
+    if (k > CANDIDATE_MAX_K) {
+        LOG_WARN("Candidate list size %u clamped to %u", k, CANDIDATE_MAX_K);
+        k = CANDIDATE_MAX_K;
+    }
+    if (k == 0) {
+        LOG_ERROR("Candidate lists need k > 0");
+        return lists;
+    }
+
+    u32 stride = (k + CANDIDATE_STRIDE_ALIGN - 1) & ~(u32)(CANDIDATE_STRIDE_ALIGN - 1);
+    lists.neighbors = arenaScratchAlloc(arena, sizeof(u32) * stride * (usize)tree->count, ALIGN_64);
+    if (!lists.neighbors) {
+        LOG_ERROR("Arena too small for %u candidate lists of %u", tree->count, k);
+        return lists;
+    }
+    lists.k = k;
+    lists.stride = stride;
+    lists.count = tree->count;
+
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    CandidateJob job = { .tree = tree, .lists = lists };
+    u32 blocks = (tree->count + KD_QUERY_BLOCK - 1) / KD_QUERY_BLOCK;
+    runThreadPoolStealing(threadCount, blocks, candidateBlockTask, &job);
+    return lists;
+}
+
+CandidateLists BuildCandidateLists(ScratchArena *arena, const Vec2* coords, u32 count, u32 k, u32 threadCount) {
+    KdTree tree = BuildKdTree(arena, coords, count);
+    if (!tree.nodes) {
+        CandidateLists empty = { .neighbors = NULL, .k = 0, .stride = 0, .count = 0 };
+        return empty;
+    }
+    return BuildCandidateListsFromTree(arena, &tree, k, threadCount);
+}
@@ -0,0 +1,66 @@
+#ifndef tsp_KD_TREE_H
+#define tsp_KD_TREE_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+
+#define KD_LEAF_SIZE 8
+#define KD_NO_CHILD UINT32_MAX
+#define CANDIDATE_MAX_K 64
+#define CANDIDATE_STRIDE_ALIGN 16   //u32 per 64 byte cache line
+
+typedef struct {
+    f32 split;                  //coordinate of the splitting plane, unused on leaves
+    u32 begin;                  //range [begin, end) of KdTree.index covered by this node
+    u32 end;
+    u32 left;                   //KD_NO_CHILD on leaves
+    u32 right;
+    u32 axis;
+} KdNode;
+
+//Balanced 2-d tree split at the median of the widest axis until at most KD_LEAF_SIZE cities
+//remain. index holds city ids in tree order and points their coordinates in the same order,
+//so a leaf scan reads one contiguous run. Node 0 is the root.
+//Cities can be removed (KdRemove): live counts per node let queries skip empty subtrees, and
+//a leaf keeps its live cities packed at the front of its range.
+typedef struct {
+    KdNode* nodes;
+    u32* index;
+    Vec2* points;
+    u32* live;                  //live cities under each node
+    u32* position;              //position[city] = slot of city in index
+    u32 nodeCount;
+    u32 count;
+    u32 liveCount;
+} KdTree;
+
+//Fixed-k neighbor lists, nearest first. List i starts at neighbors + i * stride; stride is k
+//rounded up to a whole cache line and the block is 64 byte aligned, so every list starts on
+//its own line; slots past k hold KD_NO_CHILD. k is clamped to count - 1 and CANDIDATE_MAX_K.
+typedef struct {
+    u32* neighbors;
+    u32 k;
+    u32 stride;
+    u32 count;
+} CandidateLists;
+
+KdTree BuildKdTree(ScratchArena *arena, const Vec2* coords, u32 count);
+//Writes the k cities nearest to query (squared Euclidean, ties broken by lower id) into outIds,
+//nearest first, skipping the city exclude (pass KD_NO_CHILD to keep all). outDist2 may be NULL.
+//Returns how many were found, min(k, cities available).
+u32 KdNearest(const KdTree* tree, const f32* query, u32 k, u32 exclude, u32* outIds, f32* outDist2);
+//Removes city from every later query in O(log n). Not safe while other threads query the tree.
+void KdRemove(KdTree* tree, u32 city);
+
+//k nearest neighbors of every city, queried in tree order by threadCount workers (0 picks the
+//hardware thread count). Ranking is planar: exact for EUC_2D, CEIL_2D and ATT, an
+//approximation for GEO coordinates.
+CandidateLists BuildCandidateLists(ScratchArena *arena, const Vec2* coords, u32 count, u32 k, u32 threadCount);
+CandidateLists BuildCandidateListsFromTree(ScratchArena *arena, const KdTree* tree, u32 k, u32 threadCount);
+
+static inline const u32* CandidatesOf(const CandidateLists* lists, u32 city) {
+    return lists->neighbors + (usize)city * lists->stride;
+}
+
+#endif
@@ -0,0 +1,218 @@
+#include "lin_kernighan.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+#define LK_EPS 1e-7
+
+static const u32 lkBreadth[LK_BREADTH_LEVELS] = { 5, 3, 2 };
+
+typedef struct {
+    u32 t3;
+    u32 t4;
+    f64 score;
+} LkAlternative;
+
+LkSearch CreateLkSearch(ScratchArena *arena, Tour* tour, DistanceOracle* oracle, const CandidateLists* lists) {
+    LkSearch search = { .tour = tour, .oracle = oracle, .lists = lists, .journal = NULL, .journalSize = 0,
+                        .keepJournal = false, .bestGain = 0.0, .bestJournalSize = 0 };
+    search.journal = arenaScratchAlloc(arena, sizeof(FlipRecord) * LK_JOURNAL_CAPACITY, ALIGN_64);
+    if (!search.journal) {
+        LOG_ERROR("Arena too small for a %u flip LK journal", LK_JOURNAL_CAPACITY);
+    }
+    return search;
+}
+
+//Removes (a, b), (c, d) and adds (a, c), (b, d). Forward: a b .. c d reverses b..c; otherwise
+//the tour reads b a .. d c and a..d is reversed.
+static void applyFlip(Tour* tour, u32 a, u32 b, u32 c, u32 d) {
+    if (TourNext(tour, a) == b) TourReverse(tour, b, c);
+    else TourReverse(tour, a, d);
+}
+
+static void pushFlip(LkSearch* s, u32 a, u32 b, u32 c, u32 d) {
+    applyFlip(s->tour, a, b, c, d);
+    FlipRecord* rec = &s->journal[s->journalSize++];
+    rec->a = a;
+    rec->b = b;
+    rec->c = c;
+    rec->d = d;
+}
+
+static void rollbackTo(LkSearch* s, u32 size) {
+    while (s->journalSize > size) {
+        const FlipRecord* rec = &s->journal[--s->journalSize];
+        applyFlip(s->tour, rec->a, rec->c, rec->b, rec->d);
+    }
+}
+
+static bool addedOnChain(const LkSearch* s, u32 level, u32 x, u32 y) {
+    for (u32 l = 0; l < level; l++) {
+        if ((s->addedA[l] == x && s->addedB[l] == y) || (s->addedA[l] == y && s->addedB[l] == x)) return true;
+    }
+    return false;
+}
+
+//The tour is closed after every flip: t1 and the current t2 are tour neighbors and gain is
+//what the open path has saved so far, before paying for the closing edge (t2, t1).
+static bool lkStep(LkSearch* s, u32 level, u32 t1, u32 t2, f64 gain) {
+    Tour* tour = s->tour;
+    bool t1Follows = (TourNext(tour, t2) == t1);
+    u32 other = t1Follows ? TourPrev(tour, t2) : TourNext(tour, t2);
+    u32 breadth = (level < LK_BREADTH_LEVELS) ? lkBreadth[level] : 1;
+
+    LkAlternative alt[LK_MAX_BREADTH];
+    u32 altCount = 0;
+    const u32* cand = CandidatesOf(s->lists, t2);
+    for (u32 k = 0; k < s->lists->k; k++) {
+        u32 t3 = cand[k];
+        f64 d23 = LsDist(s->oracle, t2, t3);
+        if (gain - d23 <= LK_EPS) break;
+        if (t3 == t1 || t3 == other) continue;
+        u32 t4 = t1Follows ? TourNext(tour, t3) : TourPrev(tour, t3);
+        if (addedOnChain(s, level, t3, t4)) continue;
+        f64 score = LsDist(s->oracle, t3, t4) - d23;
+        if (altCount == breadth && score <= alt[breadth - 1].score) continue;
+        u32 slot = (altCount < breadth) ? altCount++ : breadth - 1;
+        while (slot > 0 && alt[slot - 1].score < score) {
+            alt[slot] = alt[slot - 1];
+            slot--;
+        }
+        alt[slot].t3 = t3;
+        alt[slot].t4 = t4;
+        alt[slot].score = score;
+    }
+
+    for (u32 i = 0; i < altCount; i++) {
+        u32 t3 = alt[i].t3, t4 = alt[i].t4;
+        u32 mark = s->journalSize;
+        pushFlip(s, t2, t1, t3, t4);
+        s->addedA[level] = t2;
+        s->addedB[level] = t3;
+        f64 g = gain + alt[i].score;
+        f64 closed = g - LsDist(s->oracle, t4, t1);
+        if (closed > s->bestGain + LK_EPS) {
+            s->bestGain = closed;
+            s->bestJournalSize = s->journalSize;
+        }
+        if (level + 1 < LK_MAX_DEPTH) lkStep(s, level + 1, t1, t4, g);
+        if (s->bestGain > LK_EPS) return true;
+        rollbackTo(s, mark);
+    }
+    return false;
+}
+
+static bool improveCityLk(LkSearch* s, DontLookQueue* queue, u32 t1, LocalSearchStats* stats) {
+    if (s->journalSize + LK_MAX_DEPTH > LK_JOURNAL_CAPACITY) return false;
+    for (u32 dir = 0; dir < 2; dir++) {
+        u32 t2 = (dir == 0) ? TourNext(s->tour, t1) : TourPrev(s->tour, t1);
+        u32 base = s->journalSize;
+        s->bestGain = 0.0;
+        s->bestJournalSize = base;
+        if (!lkStep(s, 0, t1, t2, LsDist(s->oracle, t1, t2))) continue;
+        rollbackTo(s, s->bestJournalSize);
+        for (u32 f = base; f < s->journalSize; f++) {
+            QueuePush(queue, s->journal[f].a);
+            QueuePush(queue, s->journal[f].b);
+            QueuePush(queue, s->journal[f].c);
+            QueuePush(queue, s->journal[f].d);
+        }
+        if (!s->keepJournal) s->journalSize = 0;
+        stats->moves++;
+        stats->gain += s->bestGain;
+        return true;
+    }
+    return false;
+}
+
+LocalSearchStats LinKernighanWithQueue(LkSearch* search, DontLookQueue* queue) {
+    LocalSearchStats stats = { .moves = 0, .scans = 0, .gain = 0.0 };
+    u32 t1;
+    while (QueuePop(queue, &t1)) {
+        stats.scans++;
+        improveCityLk(search, queue, t1, &stats);
+    }
+    return stats;
+}
+
+LocalSearchStats LinKernighan(ScratchArena *arena, Tour* tour, DistanceOracle* oracle, const CandidateLists* lists) {
+    LocalSearchStats stats = { .moves = 0, .scans = 0, .gain = 0.0 };
+    if (tour->count < 8 || !lists->neighbors) return stats;
+    LkSearch search = CreateLkSearch(arena, tour, oracle, lists);
+    DontLookQueue queue = CreateDontLookQueue(arena, tour->count);
+    if (!search.journal || !queue.ring) return stats;
+    QueueAllCities(&queue, tour);
+    return LinKernighanWithQueue(&search, &queue);
+}
+
+static inline u32 nextRandom(u32* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static inline u32 step(const Tour* tour, u32 city, bool forward) {
+    return forward ? TourNext(tour, city) : TourPrev(tour, city);
+}
+
+static inline u32 stepMany(const Tour* tour, u32 city, u32 steps, bool forward) {
+    for (u32 s = 0; s < steps; s++) {
+        city = step(tour, city, forward);
+    }
+    return city;
+}
+
+//v B C w becomes v C B w for B = b1..b2 and C = c1..c2, as three journaled flips. The side of
+//v the segments are taken from is random, so kicks do not depend on how a representation
+//happens to orient the tour. Returns the length change.
+static f64 segmentDoubleBridge(LkSearch* s, DontLookQueue* queue, u32* rng) {
+    Tour* tour = s->tour;
+    u32 v = nextRandom(rng) % tour->count;
+    u32 lenB = 1 + nextRandom(rng) % LK_KICK_SPAN;
+    u32 lenC = 1 + nextRandom(rng) % LK_KICK_SPAN;
+    bool forward = (nextRandom(rng) & 0x100) != 0;
+    u32 b1 = step(tour, v, forward), b2 = stepMany(tour, b1, lenB - 1, forward);
+    u32 c1 = step(tour, b2, forward), c2 = stepMany(tour, c1, lenC - 1, forward);
+    u32 w = step(tour, c2, forward);
+    DistanceOracle* oracle = s->oracle;
+    f64 delta = LsDist(oracle, v, c1) + LsDist(oracle, c2, b1) + LsDist(oracle, b2, w)
+              - LsDist(oracle, v, b1) - LsDist(oracle, b2, c1) - LsDist(oracle, c2, w);
+    pushFlip(s, v, b1, c2, w);          //v c2..c1 b2..b1 w
+    pushFlip(s, v, c2, c1, b2);         //v c1..c2 b2..b1 w
+    pushFlip(s, c2, b2, b1, w);         //v c1..c2 b1..b2 w
+    QueuePush(queue, v);
+    QueuePush(queue, b1);
+    QueuePush(queue, b2);
+    QueuePush(queue, c1);
+    QueuePush(queue, c2);
+    QueuePush(queue, w);
+    return delta;
+}
+
+LocalSearchStats IteratedLinKernighan(ScratchArena *arena, Tour* tour, DistanceOracle* oracle,
+                                      const CandidateLists* lists, u32 kicks, u32 seed) {
+    LocalSearchStats stats = { .moves = 0, .scans = 0, .gain = 0.0 };
+    if (tour->count < 2 * LK_KICK_SPAN + 2 || !lists->neighbors) return LinKernighan(arena, tour, oracle, lists);
+    LkSearch search = CreateLkSearch(arena, tour, oracle, lists);
+    DontLookQueue queue = CreateDontLookQueue(arena, tour->count);
+    if (!search.journal || !queue.ring) return stats;
+    QueueAllCities(&queue, tour);
+    stats = LinKernighanWithQueue(&search, &queue);
+
+    u32 rng = seed ? seed : 0x9E3779B9u;
+    search.keepJournal = true;
+    for (u32 k = 0; k < kicks; k++) {
+        search.journalSize = 0;
+        f64 delta = segmentDoubleBridge(&search, &queue, &rng);
+        LocalSearchStats trial = LinKernighanWithQueue(&search, &queue);
+        stats.scans += trial.scans;
+        if (delta - trial.gain < -LK_EPS) {
+            stats.moves += trial.moves;
+            stats.gain += trial.gain - delta;
+        } else {
+            rollbackTo(&search, 0);
+        }
+    }
+    search.journalSize = 0;
+    return stats;
+}
@@ -0,0 +1,58 @@
+#ifndef tsp_LIN_KERNIGHAN_H
+#define tsp_LIN_KERNIGHAN_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_oracle.h"
+#include "kd_tree.h"
+#include "tour.h"
+#include "local_search.h"
+
+#define LK_MAX_DEPTH 50             //flips in one chain
+#define LK_BREADTH_LEVELS 3         //levels that backtrack over more than one t3
+#define LK_MAX_BREADTH 5
+#define LK_KICK_SPAN 50             //double-bridge segments stay within this many tour steps
+#define LK_JOURNAL_CAPACITY (1u << 16)
+
+//A chain step removes (a, b) and (c, d) and adds (a, c) and (b, d), with b following a and d
+//following c in the same orientation. Reapplying it as (a, c, b, d) undoes it.
+typedef struct {
+    u32 a;
+    u32 b;
+    u32 c;
+    u32 d;
+} FlipRecord;
+
+//Search state, allocated once so the chain itself never allocates. Flips applied since the
+//journal was last cleared are kept in order so a whole trial can be rolled back.
+typedef struct {
+    Tour* tour;
+    DistanceOracle* oracle;
+    const CandidateLists* lists;
+    FlipRecord* journal;
+    u32 journalSize;
+    bool keepJournal;               //false: the journal is cleared after each kept chain
+    u32 addedA[LK_MAX_DEPTH];       //edges added on the current chain, never removed by it
+    u32 addedB[LK_MAX_DEPTH];
+    f64 bestGain;
+    u32 bestJournalSize;
+} LkSearch;
+
+LkSearch CreateLkSearch(ScratchArena *arena, Tour* tour, DistanceOracle* oracle, const CandidateLists* lists);
+
+//Variable-depth Lin-Kernighan over candidate lists, driven by a don't-look queue. From base
+//t1 and each tour neighbor t2 the chain grows by sequential 2-opt flips: t3 is a candidate of
+//the last t2 with positive partial gain (the sorted list stops at the first that is not), t4
+//the neighbor that keeps the tour closed. The first LK_BREADTH_LEVELS levels backtrack over
+//the best few t3 by d(t3, t4) - d(t2, t3); deeper levels take the best only. The best closed
+//prefix of the chain is kept and the rest rolled back.
+LocalSearchStats LinKernighanWithQueue(LkSearch* search, DontLookQueue* queue);
+LocalSearchStats LinKernighan(ScratchArena *arena, Tour* tour, DistanceOracle* oracle, const CandidateLists* lists);
+
+//LK to a local optimum, then kicks rounds of segment double-bridge kicks. A kick exchanges two
+//adjacent short segments near a random city and reruns LK from the kick's endpoints only.
+//The trial is kept when the tour got shorter and rolled back through the journal otherwise.
+LocalSearchStats IteratedLinKernighan(ScratchArena *arena, Tour* tour, DistanceOracle* oracle,
+                                      const CandidateLists* lists, u32 kicks, u32 seed);
+
+#endif
@@ -0,0 +1,178 @@
+#include "local_search.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+#define LS_EPS 1e-7
+
+DontLookQueue CreateDontLookQueue(ScratchArena *arena, u32 count) {
+    DontLookQueue queue = { .ring = NULL, .queued = NULL, .head = 0, .size = 0, .capacity = 0 };
+    queue.ring = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    queue.queued = arenaScratchAlloc(arena, sizeof(u8) * count, ALIGN_64);
+    if (!queue.ring || !queue.queued) {
+        LOG_ERROR("Arena too small for a %u city don't-look queue", count);
+        queue.ring = NULL;
+        queue.queued = NULL;
+        return queue;
+    }
+    for (u32 i = 0; i < count; i++) {
+        queue.queued[i] = 0;
+    }
+    queue.capacity = count;
+    return queue;
+}
+
+void QueueAllCities(DontLookQueue* queue, const Tour* tour) {
+    u32 city = 0;
+    for (u32 k = 0; k < tour->count; k++) {
+        QueuePush(queue, city);
+        city = TourNext(tour, city);
+    }
+}
+
+//Tries both tour neighbors of a. Successor side: a an .. c cn becomes a c .. an cn by
+//reversing an..c. Predecessor side: cn c .. an a mirrored, reversing a..cn.
+static bool improveCity2Opt(Tour* tour, DistanceOracle* oracle, const CandidateLists* lists, DontLookQueue* queue,
+                            u32 a, LocalSearchStats* stats) {
+    const u32* cand = CandidatesOf(lists, a);
+    for (u32 dir = 0; dir < 2; dir++) {
+        u32 an = (dir == 0) ? TourNext(tour, a) : TourPrev(tour, a);
+        f64 d1 = LsDist(oracle, a, an);
+        for (u32 s = 0; s < lists->k; s++) {
+            u32 c = cand[s];
+            f64 dac = LsDist(oracle, a, c);
+            if (dac >= d1) break;
+            u32 cn = (dir == 0) ? TourNext(tour, c) : TourPrev(tour, c);
+            if (c == an || cn == a) continue;
+            f64 delta = dac + LsDist(oracle, an, cn) - d1 - LsDist(oracle, c, cn);
+            if (delta < -LS_EPS) {
+                if (dir == 0) {
+                    TourReverse(tour, an, c);
+                } else {
+                    TourReverse(tour, a, cn);
+                }
+                QueuePush(queue, a);
+                QueuePush(queue, an);
+                QueuePush(queue, c);
+                QueuePush(queue, cn);
+                stats->moves++;
+                stats->gain -= delta;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//Or-opt in a frame: walking with frameNext the tour reads p s1..s2 n X c d Y, every city
+//outside the segment S lying on n..p. The segment goes between c and d either as c s1..s2 d
+//or reversed as c s2..s1 d. It is moved by reversing s1..c then c..n (giving the reversed
+//insertion) and finally the segment itself. Reversals may flip the orientation, so the frame
+//is re-read from p after each one.
+static inline u32 frameNext(const Tour* tour, u32 city, bool forward) {
+    return forward ? TourNext(tour, city) : TourPrev(tour, city);
+}
+
+static void reverseInFrame(Tour* tour, u32 from, u32 to, bool forward) {
+    if (forward) TourReverse(tour, from, to);
+    else TourReverse(tour, to, from);
+}
+
+static void moveSegment(Tour* tour, u32 p, u32 s1, u32 s2, u32 n, u32 c, bool reversed, bool forward) {
+    reverseInFrame(tour, s1, c, forward);
+    forward = (TourNext(tour, p) == c);
+    reverseInFrame(tour, c, n, forward);
+    forward = (TourNext(tour, p) == n);
+    if (!reversed) reverseInFrame(tour, s2, s1, forward);
+}
+
+static inline bool inSegment(const u32* seg, u32 len, u32 city) {
+    for (u32 k = 0; k < len; k++) {
+        if (seg[k] == city) return true;
+    }
+    return false;
+}
+
+//Segments start at a and run len cities along the frame; scanning both frames also covers
+//every segment that ends at a. A new edge always touches a = s1: either c s1 (c a candidate,
+//d after it) or s1 d (d a candidate, c before it).
+static bool improveCityOrOpt(Tour* tour, DistanceOracle* oracle, const CandidateLists* lists, DontLookQueue* queue,
+                             u32 a, LocalSearchStats* stats) {
+    if (tour->count < 2 * OR_OPT_MAX_SEGMENT + 2) return false;
+    const u32* cand = CandidatesOf(lists, a);
+    for (u32 dir = 0; dir < 2; dir++) {
+        bool forward = (dir == 0);
+        u32 seg[OR_OPT_MAX_SEGMENT];
+        u32 p = frameNext(tour, a, !forward);
+        seg[0] = a;
+        for (u32 len = 1; len <= OR_OPT_MAX_SEGMENT; len++) {
+            if (len > 1) seg[len - 1] = frameNext(tour, seg[len - 2], forward);
+            u32 s1 = a, s2 = seg[len - 1];
+            u32 n = frameNext(tour, s2, forward);
+            if (n == p || s2 == p) break;
+            f64 removed = LsDist(oracle, p, s1) + LsDist(oracle, s2, n) - LsDist(oracle, p, n);
+            for (u32 s = 0; s < lists->k; s++) {
+                u32 x = cand[s];
+                f64 dax = LsDist(oracle, s1, x);
+                if (dax >= removed) break;
+                if (inSegment(seg, len, x)) continue;
+                //c = x, d after it: c s1..s2 d
+                u32 d = frameNext(tour, x, forward);
+                if (!inSegment(seg, len, d)) {
+                    f64 delta = dax + LsDist(oracle, s2, d) - LsDist(oracle, x, d) - removed;
+                    if (delta < -LS_EPS) {
+                        moveSegment(tour, p, s1, s2, n, x, false, forward);
+                        QueuePush(queue, p);
+                        QueuePush(queue, n);
+                        QueuePush(queue, s1);
+                        QueuePush(queue, s2);
+                        QueuePush(queue, x);
+                        QueuePush(queue, d);
+                        stats->moves++;
+                        stats->gain -= delta;
+                        return true;
+                    }
+                }
+                //d = x, c before it: c s2..s1 d
+                u32 c = frameNext(tour, x, !forward);
+                if (!inSegment(seg, len, c)) {
+                    f64 delta = LsDist(oracle, c, s2) + dax - LsDist(oracle, c, x) - removed;
+                    if (delta < -LS_EPS) {
+                        moveSegment(tour, p, s1, s2, n, c, true, forward);
+                        QueuePush(queue, p);
+                        QueuePush(queue, n);
+                        QueuePush(queue, s1);
+                        QueuePush(queue, s2);
+                        QueuePush(queue, c);
+                        QueuePush(queue, x);
+                        stats->moves++;
+                        stats->gain -= delta;
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+LocalSearchStats LocalSearchWithQueue(Tour* tour, DistanceOracle* oracle, const CandidateLists* lists,
+                                      DontLookQueue* queue, LocalSearchMove moves) {
+    LocalSearchStats stats = { .moves = 0, .scans = 0, .gain = 0.0 };
+    u32 a;
+    while (QueuePop(queue, &a)) {
+        stats.scans++;
+        if ((moves & LS_MOVE_2OPT) && improveCity2Opt(tour, oracle, lists, queue, a, &stats)) continue;
+        if (moves & LS_MOVE_OR_OPT) improveCityOrOpt(tour, oracle, lists, queue, a, &stats);
+    }
+    return stats;
+}
+
+LocalSearchStats LocalSearch(ScratchArena *arena, Tour* tour, DistanceOracle* oracle, const CandidateLists* lists,
+                             LocalSearchMove moves) {
+    LocalSearchStats stats = { .moves = 0, .scans = 0, .gain = 0.0 };
+    if (tour->count < 4 || !lists->neighbors) return stats;
+    DontLookQueue queue = CreateDontLookQueue(arena, tour->count);
+    if (!queue.ring) return stats;
+    QueueAllCities(&queue, tour);
+    return LocalSearchWithQueue(tour, oracle, lists, &queue, moves);
+}
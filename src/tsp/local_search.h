@@ -0,0 +1,84 @@
+#ifndef tsp_LOCAL_SEARCH_H
+#define tsp_LOCAL_SEARCH_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_oracle.h"
+#include "kd_tree.h"
+#include "tour.h"
+
+//FIFO of "dirty" cities: a city whose don't-look bit is off sits in the queue once. Cities
+//touched by an applied move are pushed back; a city whose scan finds nothing drops out.
+typedef struct {
+    u32* ring;
+    u8* queued;                 //1 while the city is in the ring (its don't-look bit is off)
+    u32 head;
+    u32 size;
+    u32 capacity;
+} DontLookQueue;
+
+typedef struct {
+    u64 moves;                  //improving moves applied
+    u64 scans;                  //cities popped and scanned
+    f64 gain;                   //total length removed
+} LocalSearchStats;
+
+DontLookQueue CreateDontLookQueue(ScratchArena *arena, u32 count);
+//Queues every city in tour order.
+void QueueAllCities(DontLookQueue* queue, const Tour* tour);
+
+static inline void QueuePush(DontLookQueue* queue, u32 city) {
+    if (queue->queued[city]) return;
+    queue->queued[city] = 1;
+    u32 tail = queue->head + queue->size;
+    if (tail >= queue->capacity) tail -= queue->capacity;
+    queue->ring[tail] = city;
+    queue->size++;
+}
+
+static inline bool QueuePop(DontLookQueue* queue, u32* city) {
+    if (queue->size == 0) return false;
+    *city = queue->ring[queue->head];
+    queue->head = (queue->head + 1 == queue->capacity) ? 0 : queue->head + 1;
+    queue->size--;
+    queue->queued[*city] = 0;
+    return true;
+}
+
+//Every move evaluation goes through the oracle, so the searches run on dense and implicit
+//backends alike.
+static inline f64 LsDist(DistanceOracle* oracle, u32 a, u32 b) {
+    return (f64)OracleDistance(oracle, a, b);
+}
+
+typedef enum LocalSearchMove {
+    LS_MOVE_2OPT = 1,
+    LS_MOVE_OR_OPT = 2,         //segments of 1..OR_OPT_MAX_SEGMENT cities, either way round
+    LS_MOVE_OR2OPT = LS_MOVE_2OPT | LS_MOVE_OR_OPT
+} LocalSearchMove;
+
+#define OR_OPT_MAX_SEGMENT 3
+
+//First-improvement search restricted to candidate lists. For each dirty city a, each enabled
+//move type and each orientation, only candidates c with d(a, c) below the length the move
+//removes are tried (the lists are sorted, so the scan stops at the first that is not) and the
+//first move with negative delta is applied. All state comes from the arena before the search
+//starts.
+LocalSearchStats LocalSearch(ScratchArena *arena, Tour* tour, DistanceOracle* oracle, const CandidateLists* lists,
+                             LocalSearchMove moves);
+//Same search driven by a caller-owned queue, for chaining with other improvers.
+LocalSearchStats LocalSearchWithQueue(Tour* tour, DistanceOracle* oracle, const CandidateLists* lists,
+                                      DontLookQueue* queue, LocalSearchMove moves);
+
+static inline LocalSearchStats TwoOpt(ScratchArena *arena, Tour* tour, DistanceOracle* oracle,
+                                      const CandidateLists* lists) {
+    return LocalSearch(arena, tour, oracle, lists, LS_MOVE_2OPT);
+}
+
+//2-opt plus Or-opt: the sequential 3-opt moves that relocate a short segment.
+static inline LocalSearchStats Or2Opt(ScratchArena *arena, Tour* tour, DistanceOracle* oracle,
+                                      const CandidateLists* lists) {
+    return LocalSearch(arena, tour, oracle, lists, LS_MOVE_OR2OPT);
+}
+
+#endif
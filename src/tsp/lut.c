@@ -0,0 +1,120 @@
+#include "lut.h"
+#include "arena_base.h"
+#include "page_arena.h"
+#include "held_karp.h"
+#include "thread_pool.h"
+
+typedef struct {
+    HeldKarpSolver* solvers;        //one per worker
+    LutRecord* records;
+    DistanceMatrix dm;
+    const u16* fragments;
+    const u16* lens;
+    u32 stride;
+} LutJob;
+
+LutTable CreateLutTable(PageArena* arena, u32 capacity) {
+    LutTable lut = { .records = NULL, .count = 0, .capacity = 0 };
+    lut.records = arenaPageAlloc(arena, sizeof(LutRecord) * (usize)capacity, ALIGN_64);
+    if (!lut.records) {
+        LOG_ERROR("Page arena too small for %u LUT records", capacity);
+        return lut;
+    }
+    lut.capacity = capacity;
+    return lut;
+}
+
+static void storeRecord(LutRecord* record, const u16* order, u16 len, f32 cost) {
+    record->cost = cost;
+    record->len = len;
+    record->_pad = 0;
+    record->start = order[0];
+    record->end = order[len - 1];
+    for (u16 k = 0; k < LUT_MAX_FRAGMENT - 2; k++) {
+        record->interior[k] = (k + 2 < len) ? order[k + 1] : 0;
+    }
+}
+
+u32 LutAppend(LutTable* lut, const u16* order, u16 len, f32 cost) {
+    if (len == 0 || len > LUT_MAX_FRAGMENT) {
+        LOG_ERROR("LUT records hold 1 to %u cities, not %u", LUT_MAX_FRAGMENT, len);
+        return LUT_NONE;
+    }
+    if (lut->count == lut->capacity) {
+        LOG_ERROR("LUT full at %u records", lut->capacity);
+        return LUT_NONE;
+    }
+    storeRecord(&lut->records[lut->count], order, len, cost);
+    return lut->count++;
+}
+
+u32 LutRecordOrder(const LutRecord* record, u16* order) {
+    u32 len = record->len;
+    order[0] = record->start;
+    for (u32 k = 1; k + 1 < len; k++) {
+        order[k] = record->interior[k - 1];
+    }
+    if (len > 1) order[len - 1] = record->end;
+    return len;
+}
+
+usize LutBuildBlockSize(u32 threadCount) {
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+    return (usize)threadCount * (HeldKarpBlockSize(LUT_MAX_FRAGMENT) + 64)
+         + ((sizeof(HeldKarpSolver) * threadCount + 63) & ~(usize)63);
+}
+
+static void buildRecordTask(memptr ctx, u32 item, u32 threadIndex) {
+    LutJob* job = (LutJob*)ctx;
+    const u16* fragment = job->fragments + (usize)item * job->stride;
+    u16 len = job->lens[item];
+    LutRecord* record = &job->records[item];
+    if (len == 0 || len > LUT_MAX_FRAGMENT) {
+        *record = (LutRecord){ .cost = -1.0f, .start = 0, .end = 0, .len = 0, ._pad = 0 };
+        return;
+    }
+    u32 cities[LUT_MAX_FRAGMENT], best[LUT_MAX_FRAGMENT];
+    u16 order[LUT_MAX_FRAGMENT];
+    for (u16 k = 0; k < len; k++) {
+        cities[k] = fragment[k];
+    }
+    f32 cost = HeldKarpSolve(&job->solvers[threadIndex], job->dm, cities, len, HK_PATH, best);
+    for (u16 k = 0; k < len; k++) {
+        order[k] = (cost < 0.0f) ? fragment[k] : (u16)best[k];
+    }
+    storeRecord(record, order, len, cost);
+}
+
+u32 LutBuild(LutTable* lut, PageArena* arena, DistanceMatrix dm, const u16* fragments, u32 stride,
+             const u16* lens, u32 count, u32 threadCount) {
+    if (!lut->records || !fragments || !lens || !dm.distances) return LUT_NONE;
+    if (count > lut->capacity - lut->count) {
+        LOG_ERROR("LUT has room for %u more records, asked for %u", lut->capacity - lut->count, count);
+        return LUT_NONE;
+    }
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+
+    usize mark = arenaPageMark(arena);
+    HeldKarpSolver* solvers = arenaPageAlloc(arena, sizeof(HeldKarpSolver) * threadCount, ALIGN_64);
+    bool ready = (solvers != NULL);
+    for (u32 t = 0; ready && t < threadCount; t++) {
+        solvers[t] = CreateHeldKarpSolver(arena, LUT_MAX_FRAGMENT);
+        ready = (solvers[t].table != NULL);
+    }
+    if (!ready) {
+        LOG_ERROR("Page arena too small for %u LUT build solvers", threadCount);
+        arenaPageRewind(arena, mark);
+        return LUT_NONE;
+    }
+
+    //every record is written by exactly one worker, so the table needs no locking
+    u32 first = lut->count;
+    LutJob job = { .solvers = solvers, .records = lut->records + first, .dm = dm, .fragments = fragments,
+                   .lens = lens, .stride = stride };
+    runThreadPoolStealing(threadCount, count, buildRecordTask, &job);
+    lut->count += count;
+    arenaPageRewind(arena, mark);
+    return first;
+}
@@ -0,0 +1,51 @@
+#ifndef tsp_LUT_H
+#define tsp_LUT_H
+
+#include "common_types.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+
+#define LUT_MAX_FRAGMENT 12         //cities per record; keeps a record at 32 bytes
+#define LUT_NONE UINT32_MAX         //index of no record, carried by non-terminal trie nodes
+
+//One stored fragment solved as a path with fixed ends: start and end are the cities it is
+//entered and left through, interior the cities between them in their cheapest order. A
+//negative cost marks a fragment that could not be solved.
+typedef struct {
+    f32 cost;
+    u16 start;
+    u16 end;
+    u16 interior[LUT_MAX_FRAGMENT - 2];
+    u16 len;
+    u16 _pad;
+} LutRecord;
+
+//Records packed back to back in one page arena block and addressed by index, so trie nodes
+//hold 4 bytes instead of a pointer and the table can be walked or copied as a flat array.
+typedef struct {
+    LutRecord* records;
+    u32 count;
+    u32 capacity;
+} LutTable;
+
+LutTable CreateLutTable(PageArena* arena, u32 capacity);
+
+static inline const LutRecord* LutRecordAt(const LutTable* lut, u32 index) {
+    return (index < lut->count) ? &lut->records[index] : NULL;
+}
+
+//Stores a fragment already in its best order; returns its index, LUT_NONE if it does not fit.
+u32 LutAppend(LutTable* lut, const u16* order, u16 len, f32 cost);
+//Writes the record's cities, endpoints included, to order; returns the fragment length.
+u32 LutRecordOrder(const LutRecord* record, u16* order);
+
+//Bytes LutBuild takes from its page arena while it runs: one Held-Karp solver per thread.
+usize LutBuildBlockSize(u32 threadCount);
+//Solves count fragments (fragment f at fragments + f * stride, lens[f] cities) exactly with
+//their first and last city fixed, on threadCount workers (0 uses every hardware thread), and
+//stores them as records first .. first + count - 1. Returns first, LUT_NONE if the table or
+//arena is too small. The solver space is returned to the arena before LutBuild returns.
+u32 LutBuild(LutTable* lut, PageArena* arena, DistanceMatrix dm, const u16* fragments, u32 stride,
+             const u16* lens, u32 count, u32 threadCount);
+
+#endif
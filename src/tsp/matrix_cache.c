@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "matrix_cache.h"
+#include "hash.h"
+#include "dist_kernels.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+#define CACHE_SECTION_ALIGN 64
+
+//size and mtime only; contentHash is left 0.
+static bool statSource(const char* filename, SourceFingerprint* out) {
+    struct stat st;
+    if (stat(filename, &st) != 0 || st.st_size <= 0) {
+        LOG_ERROR("Unable to stat or empty file: %s", filename);
+        return false;
+    }
+    out->size = (u64)st.st_size;
+    out->mtime = (s64)st.st_mtime;
+    out->contentHash = 0;
+    return true;
+}
+
+bool FingerprintSource(const char* filename, SourceFingerprint* out) {
+    s32 fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("File not found: %s", filename);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOG_ERROR("Unable to stat or empty file: %s", filename);
+        close(fd);
+        return false;
+    }
+    usize fileSize = (usize)st.st_size;
+    memptr mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("FAILED TO MAP FILE %s, size: %zu", filename, fileSize);
+        return false;
+    }
+    madvise(mapped, fileSize, MADV_SEQUENTIAL);
+    out->size = (u64)fileSize;
+    out->mtime = (s64)st.st_mtime;
+    out->contentHash = HashBytes(mapped, fileSize, 0);
+    munmap(mapped, fileSize);
+    return true;
+}
+
+static inline u64 alignSection(u64 offset) {
+    return (offset + CACHE_SECTION_ALIGN - 1) & ~(u64)(CACHE_SECTION_ALIGN - 1);
+}
+
+static u64 matrixChecksum(const u32* rowOffset, const f32* distances, u32 count) {
+    u64 h = HashBytes(rowOffset, sizeof(u32) * (usize)count, MATRIX_CACHE_VERSION);
+    return HashBytes(distances, sizeof(f32) * PackedMatrixSize(count), h);
+}
+
+static bool writePadded(FILE* file, const void* data, usize size, u64* written, u64 at) {
+    static const u8 zeros[CACHE_SECTION_ALIGN] = { 0 };
+    while (*written < at) {
+        usize pad = (usize)(at - *written);
+        if (pad > sizeof(zeros)) pad = sizeof(zeros);
+        if (fwrite(zeros, 1, pad, file) != pad) return false;
+        *written += pad;
+    }
+    if (size > 0 && fwrite(data, 1, size, file) != size) return false;
+    *written += size;
+    return true;
+}
+
+MatrixCacheStatus WriteMatrixCache(const char* cachePath, DistanceMatrix dm, u32 count, TspMetric metric,
+                                   const SourceFingerprint* source) {
+    if (!dm.distances || !dm.rowOffset || count < 2) {
+        LOG_ERROR("Refusing to cache an empty distance matrix");
+        return MATRIX_CACHE_ERR_IO;
+    }
+
+    MatrixCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MATRIX_CACHE_MAGIC;
+    header.version = MATRIX_CACHE_VERSION;
+    header.headerSize = sizeof(MatrixCacheHeader);
+    header.count = count;
+    header.metric = (u32)metric;
+    header.source = *source;
+    header.rowOffsetAt = alignSection(sizeof(MatrixCacheHeader));
+    header.distancesAt = alignSection(header.rowOffsetAt + sizeof(u32) * (u64)count);
+    header.fileSize = header.distancesAt + sizeof(f32) * (u64)PackedMatrixSize(count);
+    header.checksum = matrixChecksum(dm.rowOffset, dm.distances, count);
+
+    char tmpPath[4096];
+    if (snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", cachePath) >= (s32)sizeof(tmpPath)) {
+        LOG_ERROR("Cache path too long: %s", cachePath);
+        return MATRIX_CACHE_ERR_IO;
+    }
+    FILE* file = fopen(tmpPath, "wb");
+    if (!file) {
+        LOG_ERROR("Unable to create matrix cache %s", tmpPath);
+        return MATRIX_CACHE_ERR_IO;
+    }
+
+    u64 written = 0;
+    bool ok = writePadded(file, &header, sizeof(header), &written, 0)
+           && writePadded(file, dm.rowOffset, sizeof(u32) * (usize)count, &written, header.rowOffsetAt)
+           && writePadded(file, dm.distances, sizeof(f32) * PackedMatrixSize(count), &written, header.distancesAt);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmpPath, cachePath) != 0) {
+        LOG_ERROR("Failed writing matrix cache %s", cachePath);
+        remove(tmpPath);
+        return MATRIX_CACHE_ERR_IO;
+    }
+    return MATRIX_CACHE_OK;
+}
+
+static inline u32 byteSwap32(u32 v) {
+    return (v >> 24) | ((v >> 8) & 0xFF00u) | ((v << 8) & 0xFF0000u) | (v << 24);
+}
+
+//How much of the fingerprint has to agree with the one the cache was written for.
+typedef enum {
+    SOURCE_MATCH_ALL,           //size, mtime and contentHash
+    SOURCE_MATCH_STAT,          //size and mtime, contentHash not computed
+    SOURCE_MATCH_CONTENT        //contentHash alone, for a source that was touched but not edited
+} SourceMatch;
+
+static bool sourceMatches(const SourceFingerprint* cached, const SourceFingerprint* source, SourceMatch match) {
+    bool stat = (cached->size == source->size && cached->mtime == source->mtime);
+    bool content = (cached->size == source->size && cached->contentHash == source->contentHash);
+    switch (match) {
+        case SOURCE_MATCH_STAT:     return stat;
+        case SOURCE_MATCH_CONTENT:  return content;
+        default:                    return stat && content;
+    }
+}
+
+static MatrixCacheStatus checkHeader(const MatrixCacheHeader* h, usize fileSize, const SourceFingerprint* source,
+                                     SourceMatch match) {
+    if (h->magic == byteSwap32(MATRIX_CACHE_MAGIC)) return MATRIX_CACHE_STALE;
+    if (h->magic != MATRIX_CACHE_MAGIC) return MATRIX_CACHE_CORRUPT;
+    if (h->version != MATRIX_CACHE_VERSION || h->headerSize != sizeof(MatrixCacheHeader)) return MATRIX_CACHE_STALE;
+    if (!sourceMatches(&h->source, source, match)) return MATRIX_CACHE_STALE;
+    if (h->count < 2 || h->metric >= TSP_METRIC_COUNT || PackedMatrixSize(h->count) > UINT32_MAX) {
+        return MATRIX_CACHE_CORRUPT;
+    }
+    u64 rowOffsetAt = alignSection(sizeof(MatrixCacheHeader));
+    u64 distancesAt = alignSection(rowOffsetAt + sizeof(u32) * (u64)h->count);
+    if (h->rowOffsetAt != rowOffsetAt || h->distancesAt != distancesAt ||
+        h->fileSize != distancesAt + sizeof(f32) * (u64)PackedMatrixSize(h->count) || h->fileSize != fileSize) {
+        return MATRIX_CACHE_CORRUPT;
+    }
+    return MATRIX_CACHE_OK;
+}
+
+static CachedMatrix mapCache(const char* cachePath, const SourceFingerprint* source, SourceMatch match,
+                             bool verifyChecksum) {
+    CachedMatrix cached = { .dm = { .distances = NULL, .rowOffset = NULL }, .mapBase = NULL, .mapSize = 0,
+                            .count = 0, .metric = TSP_METRIC_EUC_2D, .status = MATRIX_CACHE_OK, .fromCache = false };
+
+    s32 fd = open(cachePath, O_RDONLY);
+    if (fd < 0) {
+        cached.status = MATRIX_CACHE_MISSING;
+        return cached;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        cached.status = MATRIX_CACHE_ERR_IO;
+        return cached;
+    }
+    if ((usize)st.st_size < sizeof(MatrixCacheHeader)) {
+        close(fd);
+        cached.status = MATRIX_CACHE_CORRUPT;
+        return cached;
+    }
+    usize fileSize = (usize)st.st_size;
+    memptr mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("FAILED TO MAP FILE %s, size: %zu", cachePath, fileSize);
+        cached.status = MATRIX_CACHE_ERR_IO;
+        return cached;
+    }
+
+    const MatrixCacheHeader* header = (const MatrixCacheHeader*)mapped;
+    cached.status = checkHeader(header, fileSize, source, match);
+    if (cached.status != MATRIX_CACHE_OK) {
+        munmap(mapped, fileSize);
+        return cached;
+    }
+    const u8* base = (const u8*)mapped;
+    cached.dm.rowOffset = (u32*)(base + header->rowOffsetAt);
+    cached.dm.distances = (f32*)(base + header->distancesAt);
+    if (verifyChecksum && matrixChecksum(cached.dm.rowOffset, cached.dm.distances, header->count) != header->checksum) {
+        LOG_WARN("Checksum mismatch in matrix cache %s", cachePath);
+        munmap(mapped, fileSize);
+        cached.dm.rowOffset = NULL;
+        cached.dm.distances = NULL;
+        cached.status = MATRIX_CACHE_CORRUPT;
+        return cached;
+    }
+
+    cached.mapBase = mapped;
+    cached.mapSize = fileSize;
+    cached.count = header->count;
+    cached.metric = (TspMetric)header->metric;
+    cached.fromCache = true;
+    return cached;
+}
+
+CachedMatrix MapMatrixCache(const char* cachePath, const SourceFingerprint* source, bool verifyChecksum) {
+    return mapCache(cachePath, source, SOURCE_MATCH_ALL, verifyChecksum);
+}
+
+void UnmapMatrixCache(CachedMatrix* cached) {
+    if (cached->mapBase) {
+        munmap(cached->mapBase, cached->mapSize);
+    }
+    cached->mapBase = NULL;
+    cached->mapSize = 0;
+    cached->dm.distances = NULL;
+    cached->dm.rowOffset = NULL;
+    cached->count = 0;
+}
+
+//Stamps a cache whose contents matched with the source's new size and mtime, so the next run
+//takes the stat-only path again instead of rehashing the source every time.
+static void refreshSource(const char* cachePath, const SourceFingerprint* source) {
+    s32 fd = open(cachePath, O_WRONLY);
+    if (fd < 0) {
+        LOG_WARN("Unable to refresh the source fingerprint in %s", cachePath);
+        return;
+    }
+    off_t at = (off_t)offsetof(MatrixCacheHeader, source);
+    if (pwrite(fd, source, sizeof(*source), at) != (ssize_t)sizeof(*source)) {
+        LOG_WARN("Unable to refresh the source fingerprint in %s", cachePath);
+    }
+    close(fd);
+}
+
+static const char* cacheStatusName(MatrixCacheStatus status) {
+    switch (status) {
+        case MATRIX_CACHE_OK:       return "ok";
+        case MATRIX_CACHE_MISSING:  return "missing";
+        case MATRIX_CACHE_STALE:    return "stale";
+        case MATRIX_CACHE_CORRUPT:  return "corrupt";
+        default:                    return "unreadable";
+    }
+}
+
+CachedMatrix LoadOrBuildMatrix(ScratchArena *arena, const char* tspPath, const char* cachePath, u32 threadCount,
+                               bool verifyChecksum) {
+    CachedMatrix result = { .dm = { .distances = NULL, .rowOffset = NULL }, .mapBase = NULL, .mapSize = 0,
+                            .count = 0, .metric = TSP_METRIC_EUC_2D, .status = MATRIX_CACHE_ERR_IO, .fromCache = false };
+    SourceFingerprint source;
+    if (!statSource(tspPath, &source)) {
+        return result;
+    }
+
+    //Unchanged size and mtime are trusted; the source is only read and hashed when they moved.
+    CachedMatrix cached = mapCache(cachePath, &source, SOURCE_MATCH_STAT, verifyChecksum);
+    if (cached.status == MATRIX_CACHE_STALE) {
+        if (!FingerprintSource(tspPath, &source)) {
+            return result;
+        }
+        cached = mapCache(cachePath, &source, SOURCE_MATCH_CONTENT, verifyChecksum);
+        if (cached.status == MATRIX_CACHE_OK) refreshSource(cachePath, &source);
+    } else if (cached.status != MATRIX_CACHE_OK && !FingerprintSource(tspPath, &source)) {
+        return result;
+    }
+    if (cached.status == MATRIX_CACHE_OK) {
+        return cached;
+    }
+    if (cached.status != MATRIX_CACHE_MISSING) {
+        LOG_INFO("Matrix cache %s is %s, rebuilding from %s", cachePath, cacheStatusName(cached.status), tspPath);
+    }
+
+    TspInstance inst = LoadTspInstanceParallel(arena, tspPath, threadCount);
+    if (inst.status != TSP_LOAD_OK) {
+        return result;
+    }
+    DistanceMatrix dm = BuildDistanceMatrixParallel(arena, &inst, threadCount);
+    if (!dm.distances) {
+        return result;
+    }
+    result.dm = dm;
+    result.count = inst.count;
+    result.metric = inst.metric;
+    result.status = WriteMatrixCache(cachePath, dm, inst.count, inst.metric, &source);
+    return result;
+}
@@ -0,0 +1,73 @@
+#ifndef tsp_MATRIX_CACHE_H
+#define tsp_MATRIX_CACHE_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+
+#define MATRIX_CACHE_MAGIC 0x434D4454u     //"TDMC" little endian
+#define MATRIX_CACHE_VERSION 1u
+
+typedef enum MatrixCacheStatus {
+    MATRIX_CACHE_OK = 0,
+    MATRIX_CACHE_MISSING,       //no cache file
+    MATRIX_CACHE_STALE,         //written for another source file, version or byte order
+    MATRIX_CACHE_CORRUPT,       //truncated, bad header or checksum mismatch
+    MATRIX_CACHE_ERR_IO
+} MatrixCacheStatus;
+
+//Identifies the exact TSPLIB file a cache was built from. size and mtime are cheap to check;
+//contentHash tells a touched but unchanged file from an edited one.
+typedef struct {
+    u64 size;
+    s64 mtime;
+    u64 contentHash;
+} SourceFingerprint;
+
+//On-disk layout: this header, rowOffset[count] and distances[count * (count - 1) / 2], each
+//section starting on a 64 byte file offset so the mapped arrays are cache line aligned.
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 headerSize;
+    u32 count;
+    u32 metric;
+    u32 _pad;
+    SourceFingerprint source;
+    u64 rowOffsetAt;            //file offset of rowOffset
+    u64 distancesAt;            //file offset of distances
+    u64 fileSize;
+    u64 checksum;               //HashBytes of rowOffset and distances
+} MatrixCacheHeader;
+
+//A DistanceMatrix either mapped read-only from a cache file (mapBase != NULL, release with
+//UnmapMatrixCache) or built into the caller's arena.
+typedef struct {
+    DistanceMatrix dm;
+    memptr mapBase;
+    usize mapSize;
+    u32 count;
+    TspMetric metric;
+    MatrixCacheStatus status;
+    bool fromCache;
+} CachedMatrix;
+
+bool FingerprintSource(const char* filename, SourceFingerprint* out);
+
+//Writes through a temporary file renamed into place, so readers never map a half written cache.
+MatrixCacheStatus WriteMatrixCache(const char* cachePath, DistanceMatrix dm, u32 count, TspMetric metric,
+                                   const SourceFingerprint* source);
+//Maps a cache when all of source matches. The checksum pass reads the whole file; skip it with
+//verifyChecksum = false for near-instant startup on trusted caches.
+CachedMatrix MapMatrixCache(const char* cachePath, const SourceFingerprint* source, bool verifyChecksum);
+void UnmapMatrixCache(CachedMatrix* cached);
+
+//Maps cachePath when it is current for tspPath, otherwise loads and builds the matrix into the
+//arena and rewrites the cache for the next run; status then reports whether that write worked.
+//The cache is current when tspPath's size and mtime match, and only when they do not is the
+//file hashed to compare contents. verifyChecksum is passed on to MapMatrixCache.
+CachedMatrix LoadOrBuildMatrix(ScratchArena *arena, const char* tspPath, const char* cachePath, u32 threadCount,
+                               bool verifyChecksum);
+
+#endif
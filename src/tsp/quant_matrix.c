@@ -0,0 +1,169 @@
+#include "quant_matrix.h"
+#include "dist_kernels.h"
+#include "thread_pool.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+#define QUANT_F32_EXACT_LIMIT (1u << 24)
+#define QUANT_GEO_BOUND 20040u      //half the TSPLIB earth circumference, pi * RRR + 1, rounded up
+
+typedef struct {
+    QuantMatrix qm;
+    const Vec2* coords;
+    const f32* weights;             //EXPLICIT instances convert these in place of a kernel
+    TspMetric metric;
+    DistRowKernel kernel;           //NULL when entries may exceed f32 precision
+    DistSoaRowKernel soaKernel;
+    const CoordsSoA* soa;
+    f32* rowBuffers;                //one count-long f32 row per worker
+} QuantFillJob;
+
+//Largest distance the instance can produce. For the planar metrics that is the metric applied
+//across the bounding box diagonal, since every rounding rule is monotone in the true length.
+static bool quantBound(const TspInstance* inst, u32* outBound) {
+    if (inst->metric == TSP_METRIC_EXPLICIT) {
+        usize n = PackedMatrixSize(inst->count);
+        u32 maxW = 0;
+        for (usize k = 0; k < n; k++) {
+            f32 w = inst->weights[k];
+            if (!(w >= 0.0f && w < 4294967296.0f) || (f32)(u32)w != w) {
+                LOG_ERROR("Edge weight %g at packed index %zu is not a u32 integer", (f64)w, k);
+                return false;
+            }
+            if ((u32)w > maxW) maxW = (u32)w;
+        }
+        *outBound = maxW;
+        return true;
+    }
+    if (inst->metric == TSP_METRIC_GEO) {
+        *outBound = QUANT_GEO_BOUND;
+        return true;
+    }
+    if (inst->metric == TSP_METRIC_SQR_EUC_2D || inst->metric >= TSP_METRIC_COUNT) {
+        LOG_ERROR("Metric %d has no integer distances to quantize", inst->metric);
+        return false;
+    }
+
+    const Vec2* coords = inst->coords;
+    f32 lo[2] = { coords[0][0], coords[0][1] };
+    f32 hi[2] = { coords[0][0], coords[0][1] };
+    for (u32 i = 1; i < inst->count; i++) {
+        for (u32 a = 0; a < 2; a++) {
+            if (coords[i][a] < lo[a]) lo[a] = coords[i][a];
+            if (coords[i][a] > hi[a]) hi[a] = coords[i][a];
+        }
+    }
+    *outBound = MetricDistanceInt(inst->metric, lo, hi);
+    return true;
+}
+
+static void quantRowTask(memptr ctx, u32 row, u32 threadIndex) {
+    QuantFillJob* job = (QuantFillJob*)ctx;
+    const QuantMatrix* qm = &job->qm;
+    u32 len = qm->count - row - 1;
+    usize base = qm->rowOffset[row];
+
+    if (!job->weights && !job->kernel) {
+        const f32* a = job->coords[row];
+        for (u32 k = 0; k < len; k++) {
+            qm->d32[base + k] = MetricDistanceInt(job->metric, a, job->coords[row + 1 + k]);
+        }
+        return;
+    }
+
+    const f32* src;
+    if (job->weights) {
+        src = job->weights + base;
+    } else {
+        f32* buf = job->rowBuffers + (usize)threadIndex * qm->count;
+        if (job->soaKernel) {
+            job->soaKernel(job->soa, row, buf);
+        } else {
+            job->kernel(job->coords, qm->count, row, buf);
+        }
+        src = buf;
+    }
+    if (qm->width == QUANT_U16) {
+        u16* out = qm->d16 + base;
+        for (u32 k = 0; k < len; k++) {
+            out[k] = (u16)src[k];
+        }
+    } else {
+        u32* out = qm->d32 + base;
+        for (u32 k = 0; k < len; k++) {
+            out[k] = (u32)src[k];
+        }
+    }
+}
+
+QuantMatrix BuildQuantMatrix(ScratchArena *arena, const TspInstance* inst, u32 threadCount) {
+    QuantMatrix qm = { .d16 = NULL, .d32 = NULL, .rowOffset = NULL, .count = 0, .maxDistance = 0, .width = QUANT_NONE };
+    u32 count = inst->count;
+    if (inst->status != TSP_LOAD_OK || count < 2) {
+        LOG_ERROR("Cannot quantize a failed or trivial instance");
+        return qm;
+    }
+    if (PackedMatrixSize(count) > UINT32_MAX) {
+        LOG_ERROR("%u cities overflow the u32 rowOffset of a packed matrix", count);
+        return qm;
+    }
+    u32 bound;
+    if (!quantBound(inst, &bound)) {
+        return qm;
+    }
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+
+    QuantFillJob job = { .coords = (const Vec2*)inst->coords, .weights = NULL, .metric = inst->metric,
+                         .kernel = NULL, .soaKernel = NULL, .soa = NULL, .rowBuffers = NULL };
+    if (inst->metric == TSP_METRIC_EXPLICIT) {
+        job.weights = inst->weights;
+    } else if (bound < QUANT_F32_EXACT_LIMIT) {
+        //the f32 row kernels, vector ones included, are exact in this range
+        job.kernel = SelectRowKernel(inst->metric);
+        job.soaKernel = SelectSoaRowKernel(inst->metric, DetectSimdLevel());
+        job.rowBuffers = arenaScratchAlloc(arena, sizeof(f32) * (usize)count * threadCount, ALIGN_64);
+        if (!job.rowBuffers) {
+            LOG_ERROR("Arena too small for %u quantization row buffers", threadCount);
+            return qm;
+        }
+    }
+
+    qm.width = (bound <= UINT16_MAX) ? QUANT_U16 : QUANT_U32;
+    qm.rowOffset = arenaScratchAlloc(arena, sizeof(u32) * count, ALIGN_64);
+    if (qm.width == QUANT_U16) {
+        qm.d16 = arenaScratchAlloc(arena, PackedMatrixSize(count) * sizeof(u16) + sizeof(u16), ALIGN_64);
+    } else {
+        qm.d32 = arenaScratchAlloc(arena, PackedMatrixSize(count) * sizeof(u32) + sizeof(u32), ALIGN_64);
+    }
+    if (!qm.rowOffset || (!qm.d16 && !qm.d32)) {
+        LOG_ERROR("Arena too small for a %u city quantized matrix", count);
+        QuantMatrix empty = { .d16 = NULL, .d32 = NULL, .rowOffset = NULL, .count = 0, .maxDistance = 0, .width = QUANT_NONE };
+        return empty;
+    }
+    FillRowOffsets(qm.rowOffset, count);
+    qm.count = count;
+    qm.maxDistance = bound;
+
+    CoordsSoA soa;
+    if (job.soaKernel) {
+        soa = CreateCoordsSoA(arena, job.coords, count);
+        if (soa.x) {
+            job.soa = &soa;
+        } else {
+            job.soaKernel = NULL;
+        }
+    }
+    job.qm = qm;
+    runThreadPoolStealing(threadCount, count - 1, quantRowTask, &job);
+    return qm;
+}
+
+u64 QuantTourCost(const QuantMatrix* qm, const u32* tour, u32 count) {
+    if (count < 2) return 0;
+    u64 total = QuantDistance(qm, tour[count - 1], tour[0]);
+    for (u32 k = 0; k + 1 < count; k++) {
+        total += QuantDistance(qm, tour[k], tour[k + 1]);
+    }
+    return total;
+}
@@ -0,0 +1,40 @@
+#ifndef tsp_QUANT_MATRIX_H
+#define tsp_QUANT_MATRIX_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+
+typedef enum QuantWidth {
+    QUANT_NONE = 0,
+    QUANT_U16 = 2,
+    QUANT_U32 = 4
+} QuantWidth;
+
+//Packed upper triangle of exact integer TSPLIB distances, same rowOffset layout and DM_INDEX
+//as DistanceMatrix, stored in the narrowest width that holds maxDistance. Only one of d16 and
+//d32 is set.
+typedef struct {
+    u16* d16;
+    u32* d32;
+    u32* rowOffset;
+    u32 count;
+    u32 maxDistance;            //upper bound on every stored entry
+    QuantWidth width;
+} QuantMatrix;
+
+//Integer metrics only: EUC_2D, CEIL_2D, ATT, GEO and EXPLICIT instances whose weights are
+//whole numbers. Rows are filled by threadCount workers (0 picks the hardware thread count).
+QuantMatrix BuildQuantMatrix(ScratchArena *arena, const TspInstance* inst, u32 threadCount);
+
+static inline u32 QuantDistance(const QuantMatrix* qm, u32 i, u32 j) {
+    if (i == j) return 0;
+    usize idx = DM_INDEX(*qm, i, j);
+    return (qm->width == QUANT_U16) ? qm->d16[idx] : qm->d32[idx];
+}
+
+//Exact length of the closed tour visiting tour[0 .. count-1].
+u64 QuantTourCost(const QuantMatrix* qm, const u32* tour, u32 count);
+
+#endif
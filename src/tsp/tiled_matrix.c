@@ -0,0 +1,115 @@
+#include "tiled_matrix.h"
+#include "dist_kernels.h"
+#include "thread_pool.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+typedef struct {
+    TiledMatrix tm;
+    const Vec2* coords;
+    const f32* weights;         //EXPLICIT instances read packed weights instead of a kernel
+    DistRowKernel kernel;
+    DistSoaRowKernel soaKernel;
+    const CoordsSoA* soa;
+    f32* rowBuffers;            //one count-long f32 row per worker
+} TileFillJob;
+
+static inline f32* tileAt(const TiledMatrix* tm, u32 ti, u32 tj) {
+    return tm->tiles + ((usize)tm->tileRowOffset[ti] + (tj - ti)) * TILE_ENTRIES;
+}
+
+//Fills tile row ti: for each of its TILE_DIM cities the upper part of the row is computed once
+//and scattered across the tiles, then the lower half of the diagonal tile is mirrored.
+static void tileRowTask(memptr ctx, u32 ti, u32 threadIndex) {
+    TileFillJob* job = (TileFillJob*)ctx;
+    const TiledMatrix* tm = &job->tm;
+    u32 count = tm->count;
+    f32* buf = job->rowBuffers ? job->rowBuffers + (usize)threadIndex * count : NULL;
+
+    for (u32 r = 0; r < TILE_DIM; r++) {
+        u32 i = (ti << TILE_SHIFT) + r;
+        const f32* row = NULL;
+        if (i + 1 < count) {
+            if (job->weights) {
+                row = job->weights + PackedIndex(count, i, i + 1);
+            } else if (job->soaKernel) {
+                job->soaKernel(job->soa, i, buf);
+                row = buf;
+            } else {
+                job->kernel(job->coords, count, i, buf);
+                row = buf;
+            }
+        }
+        //row[k] = d(i, i + 1 + k)
+        for (u32 tj = ti; tj < tm->tilesPerSide; tj++) {
+            f32* out = tileAt(tm, ti, tj) + (r << TILE_SHIFT);
+            for (u32 c = 0; c < TILE_DIM; c++) {
+                u32 j = (tj << TILE_SHIFT) + c;
+                out[c] = (i < count && j > i && j < count) ? row[j - i - 1] : 0.0f;
+            }
+        }
+    }
+
+    f32* diag = tileAt(tm, ti, ti);
+    for (u32 r = 1; r < TILE_DIM; r++) {
+        for (u32 c = 0; c < r; c++) {
+            diag[(r << TILE_SHIFT) + c] = diag[(c << TILE_SHIFT) + r];
+        }
+    }
+}
+
+TiledMatrix BuildTiledMatrix(ScratchArena *arena, const TspInstance* inst, u32 threadCount) {
+    TiledMatrix tm = { .tiles = NULL, .tileRowOffset = NULL, .count = 0, .tilesPerSide = 0 };
+    u32 count = inst->count;
+    if (inst->status != TSP_LOAD_OK || count < 2) {
+        LOG_ERROR("Cannot build a tiled matrix from a failed or trivial instance");
+        return tm;
+    }
+    TileFillJob job = { .coords = (const Vec2*)inst->coords, .weights = NULL, .kernel = NULL,
+                        .soaKernel = NULL, .soa = NULL, .rowBuffers = NULL };
+    if (inst->metric == TSP_METRIC_EXPLICIT) {
+        job.weights = inst->weights;
+    } else {
+        job.kernel = SelectRowKernel(inst->metric);
+        if (!job.kernel || !inst->coords) {
+            LOG_ERROR("No distance kernel for metric %d", inst->metric);
+            return tm;
+        }
+        job.soaKernel = SelectSoaRowKernel(inst->metric, DetectSimdLevel());
+    }
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+
+    u32 side = (count + TILE_MASK) >> TILE_SHIFT;
+    usize tileCount = (usize)side * (side + 1) / 2;
+    tm.tileRowOffset = arenaScratchAlloc(arena, sizeof(u32) * side, ALIGN_64);
+    tm.tiles = arenaScratchAlloc(arena, sizeof(f32) * TILE_ENTRIES * tileCount, ALIGN_64);
+    if (!job.weights) {
+        job.rowBuffers = arenaScratchAlloc(arena, sizeof(f32) * (usize)count * threadCount, ALIGN_64);
+    }
+    if (!tm.tileRowOffset || !tm.tiles || (!job.weights && !job.rowBuffers)) {
+        LOG_ERROR("Arena too small for a %u city tiled matrix", count);
+        TiledMatrix empty = { .tiles = NULL, .tileRowOffset = NULL, .count = 0, .tilesPerSide = 0 };
+        return empty;
+    }
+    u32 offset = 0;
+    for (u32 t = 0; t < side; t++) {
+        tm.tileRowOffset[t] = offset;
+        offset += side - t;
+    }
+    tm.count = count;
+    tm.tilesPerSide = side;
+
+    CoordsSoA soa;
+    if (job.soaKernel) {
+        soa = CreateCoordsSoA(arena, job.coords, count);
+        if (soa.x) {
+            job.soa = &soa;
+        } else {
+            job.soaKernel = NULL;
+        }
+    }
+    job.tm = tm;
+    runThreadPoolStealing(threadCount, side, tileRowTask, &job);
+    return tm;
+}
@@ -0,0 +1,45 @@
+#ifndef tsp_TILED_MATRIX_H
+#define tsp_TILED_MATRIX_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+
+#define TILE_SHIFT 4
+#define TILE_DIM (1u << TILE_SHIFT)
+#define TILE_MASK (TILE_DIM - 1)
+#define TILE_ENTRIES (TILE_DIM * TILE_DIM)
+
+//Blocked alternative to the packed row layout: the upper triangle of TILE_DIM x TILE_DIM tiles,
+//each tile a contiguous 1 KiB row-major block. Pairs whose ids differ by less than a tile in
+//both coordinates share a tile, so a neighborhood of cities touches a handful of cache lines
+//and one page instead of one line per row. Diagonal tiles are stored whole (both halves) and
+//edge tiles are zero padded.
+typedef struct {
+    f32* tiles;
+    u32* tileRowOffset;         //first tile of tile row t, counting tiles
+    u32 count;
+    u32 tilesPerSide;
+} TiledMatrix;
+
+//Branch-free ordering and a closed-form tile row start: random pairs would mispredict a swap
+//branch half the time.
+static inline usize TiledIndex(const TiledMatrix* tm, u32 i, u32 j) {
+    u32 lo = (i < j) ? i : j;
+    u32 hi = (i < j) ? j : i;
+    usize ti = lo >> TILE_SHIFT, tj = hi >> TILE_SHIFT;
+    usize tile = ti * tm->tilesPerSide - ((ti * (ti - 1)) >> 1) + (tj - ti);
+    return tile * TILE_ENTRIES + ((lo & TILE_MASK) << TILE_SHIFT) + (hi & TILE_MASK);
+}
+
+static inline f32 TiledDistance(const TiledMatrix* tm, u32 i, u32 j) {
+    return tm->tiles[TiledIndex(tm, i, j)];
+}
+
+//Same values as BuildDistanceMatrix with 0 on the diagonal, written straight into tiles. Each
+//worker computes whole rows with the metric's row kernel and scatters them across one tile row.
+//threadCount 0 uses every hardware thread.
+TiledMatrix BuildTiledMatrix(ScratchArena *arena, const TspInstance* inst, u32 threadCount);
+
+#endif
@@ -0,0 +1,458 @@
+#include "tour.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+
+f64 TourLength(DistanceMatrix dm, const u32* tour, u32 count) {
+    if (count < 2) return 0.0;
+    f64 total = 0.0;
+    u32 prev = tour[count - 1];
+    for (u32 k = 0; k < count; k++) {
+        u32 city = tour[k];
+        if (city != prev) total += dm.distances[DM_INDEX(dm, prev, city)];
+        prev = city;
+    }
+    return total;
+}
+
+bool IsTourPermutation(ScratchArena *arena, const u32* tour, u32 count) {
+    u64* seen = arenaScratchAlloc(arena, sizeof(u64) * ((count + 63) / 64), ALIGN_64);
+    if (!seen) {
+        LOG_ERROR("Arena too small to check a %u city tour", count);
+        return false;
+    }
+    for (u32 w = 0; w < (count + 63) / 64; w++) {
+        seen[w] = 0;
+    }
+    for (u32 k = 0; k < count; k++) {
+        u32 city = tour[k];
+        if (city >= count || (seen[city >> 6] & (1ULL << (city & 63)))) return false;
+        seen[city >> 6] |= 1ULL << (city & 63);
+    }
+    return true;
+}
+
+#define NO_CITY UINT32_MAX
+
+static u32 integerSqrt(u32 n) {
+    u32 r = 0;
+    while ((u64)(r + 1) * (r + 1) <= n) r++;
+    return r;
+}
+
+static inline usize alignUp64(usize size) {
+    return (size + 63) & ~(usize)63;
+}
+
+static TourKind effectiveKind(TourKind kind, u32 count) {
+    return (kind == TOUR_TWO_LEVEL && count >= TWO_LEVEL_MIN_COUNT) ? TOUR_TWO_LEVEL : TOUR_ARRAY;
+}
+
+usize TourBlockSize(TourKind kind, u32 count) {
+    if (effectiveKind(kind, count) == TOUR_ARRAY) {
+        return 2 * alignUp64(sizeof(u32) * count);
+    }
+    u32 group = integerSqrt(count);
+    u32 segments = (count + group - 1) / group;
+    return alignUp64(sizeof(TourSegment) * segments) + alignUp64(sizeof(TourNode) * count)
+         + alignUp64(sizeof(u32) * count);
+}
+
+//Cuts order into segments of groupSize cities, all unreversed, ranks in order.
+static void layoutTwoLevel(Tour* tour, const u32* order) {
+    u32 n = tour->count, group = tour->groupSize, segCount = tour->segmentCount;
+    for (u32 s = 0; s < segCount; s++) {
+        u32 begin = s * group;
+        u32 end = (begin + group < n) ? begin + group : n;
+        TourSegment* seg = &tour->segments[s];
+        seg->first = order[begin];
+        seg->last = order[end - 1];
+        seg->next = (s + 1 == segCount) ? 0 : s + 1;
+        seg->prev = (s == 0) ? segCount - 1 : s - 1;
+        seg->rank = s;
+        seg->size = end - begin;
+        seg->reversed = 0;
+        seg->_pad = 0;
+        for (u32 p = begin; p < end; p++) {
+            TourNode* node = &tour->nodes[order[p]];
+            node->parent = s;
+            node->id = (s32)(p - begin);
+            node->next = (p + 1 < end) ? order[p + 1] : NO_CITY;
+            node->prev = (p > begin) ? order[p - 1] : NO_CITY;
+        }
+    }
+}
+
+Tour CreateTourInBlock(memptr block, TourKind kind, const u32* order, u32 count) {
+    Tour tour = { .kind = effectiveKind(kind, count), .count = count, .order = NULL, .pos = NULL,
+                  .nodes = NULL, .segments = NULL, .scratch = NULL, .segmentCount = 0, .groupSize = 0 };
+    byte base = (byte)block;
+    if (tour.kind == TOUR_ARRAY) {
+        tour.order = (u32*)base;
+        tour.pos = (u32*)(base + alignUp64(sizeof(u32) * count));
+        for (u32 p = 0; p < count; p++) {
+            tour.order[p] = order[p];
+            tour.pos[order[p]] = p;
+        }
+        return tour;
+    }
+    tour.groupSize = integerSqrt(count);
+    tour.segmentCount = (count + tour.groupSize - 1) / tour.groupSize;
+    tour.segments = (TourSegment*)base;
+    base += alignUp64(sizeof(TourSegment) * tour.segmentCount);
+    tour.nodes = (TourNode*)base;
+    base += alignUp64(sizeof(TourNode) * count);
+    tour.scratch = (u32*)base;
+    layoutTwoLevel(&tour, order);
+    return tour;
+}
+
+Tour CreateTour(ScratchArena *arena, TourKind kind, const u32* order, u32 count) {
+    memptr block = arenaScratchAlloc(arena, TourBlockSize(kind, count), ALIGN_64);
+    if (!block) {
+        LOG_ERROR("Arena too small for a %u city tour", count);
+        Tour empty = { .kind = kind, .count = 0, .order = NULL, .pos = NULL, .nodes = NULL,
+                       .segments = NULL, .scratch = NULL, .segmentCount = 0, .groupSize = 0 };
+        return empty;
+    }
+    return CreateTourInBlock(block, kind, order, count);
+}
+
+Tour CreateTourPaged(PageArena *arena, TourKind kind, const u32* order, u32 count) {
+    memptr block = arenaPageAlloc(arena, TourBlockSize(kind, count), ALIGN_64);
+    if (!block) {
+        LOG_ERROR("Page arena too small for a %u city tour", count);
+        Tour empty = { .kind = kind, .count = 0, .order = NULL, .pos = NULL, .nodes = NULL,
+                       .segments = NULL, .scratch = NULL, .segmentCount = 0, .groupSize = 0 };
+        return empty;
+    }
+    return CreateTourInBlock(block, kind, order, count);
+}
+
+void TourToArray(const Tour* tour, u32* out) {
+    u32 city = 0;
+    for (u32 k = 0; k < tour->count; k++) {
+        out[k] = city;
+        city = TourNext(tour, city);
+    }
+}
+
+static void reversePositions(Tour* tour, u32 i, u32 j, u32 len) {
+    u32* order = tour->order;
+    u32* pos = tour->pos;
+    u32 n = tour->count;
+    for (u32 s = 0; s < len / 2; s++) {
+        u32 a = order[i], b = order[j];
+        order[i] = b;
+        pos[b] = i;
+        order[j] = a;
+        pos[a] = j;
+        i = (i + 1 == n) ? 0 : i + 1;
+        j = (j == 0) ? n - 1 : j - 1;
+    }
+}
+
+//Two-level reversal. A path inside one segment is relinked city by city. Otherwise both
+//ends are first made segment boundaries, moving the smaller side of each cut into the
+//neighboring segment, and the run of whole segments (or its complement) is reversed by
+//relinking segments and toggling their reversal bits.
+
+static inline s32 orientedId(const Tour* tour, u32 city) {
+    const TourNode* node = &tour->nodes[city];
+    return tour->segments[node->parent].reversed ? -node->id : node->id;
+}
+
+static inline u32 tourStartOf(const TourSegment* seg) {
+    return seg->reversed ? seg->last : seg->first;
+}
+
+static inline u32 tourEndOf(const TourSegment* seg) {
+    return seg->reversed ? seg->first : seg->last;
+}
+
+static void renumberSegment(Tour* tour, u32 segIndex) {
+    TourSegment* seg = &tour->segments[segIndex];
+    u32 city = seg->first;
+    for (u32 k = 0; k < seg->size; k++) {
+        tour->nodes[city].id = (s32)k;
+        city = tour->nodes[city].next;
+    }
+}
+
+//Reverses the run x..y of one segment, x not after y along the segment's own links.
+static void reverseInSegment(Tour* tour, u32 x, u32 y) {
+    TourNode* nodes = tour->nodes;
+    TourSegment* seg = &tour->segments[nodes[x].parent];
+    u32 before = (x == seg->first) ? NO_CITY : nodes[x].prev;
+    u32 after = (y == seg->last) ? NO_CITY : nodes[y].next;
+    s32 idSum = nodes[x].id + nodes[y].id;
+    u32 city = x;
+    for (;;) {
+        u32 next = nodes[city].next;
+        nodes[city].next = nodes[city].prev;
+        nodes[city].prev = next;
+        nodes[city].id = idSum - nodes[city].id;
+        if (city == y) break;
+        city = next;
+    }
+    if (before == NO_CITY) seg->first = y;
+    else nodes[before].next = y;
+    nodes[y].prev = before;
+    if (after == NO_CITY) seg->last = x;
+    else nodes[after].prev = x;
+    nodes[x].next = after;
+}
+
+//Reverses the tour-order run from..to that lies inside one segment.
+static void reverseRunInSegment(Tour* tour, u32 from, u32 to) {
+    if (tour->segments[tour->nodes[from].parent].reversed) reverseInSegment(tour, to, from);
+    else reverseInSegment(tour, from, to);
+}
+
+static void appendAtTourEnd(Tour* tour, u32 segIndex, u32 city) {
+    TourSegment* seg = &tour->segments[segIndex];
+    TourNode* nodes = tour->nodes;
+    u32 end = tourEndOf(seg);
+    if (nodes[end].id >= TWO_LEVEL_ID_LIMIT || nodes[end].id <= -TWO_LEVEL_ID_LIMIT) {
+        renumberSegment(tour, segIndex);
+    }
+    if (!seg->reversed) {
+        nodes[end].next = city;
+        nodes[city].prev = end;
+        nodes[city].next = NO_CITY;
+        nodes[city].id = nodes[end].id + 1;
+        seg->last = city;
+    } else {
+        nodes[end].prev = city;
+        nodes[city].next = end;
+        nodes[city].prev = NO_CITY;
+        nodes[city].id = nodes[end].id - 1;
+        seg->first = city;
+    }
+    nodes[city].parent = segIndex;
+    seg->size++;
+}
+
+static void prependAtTourStart(Tour* tour, u32 segIndex, u32 city) {
+    TourSegment* seg = &tour->segments[segIndex];
+    TourNode* nodes = tour->nodes;
+    u32 start = tourStartOf(seg);
+    if (nodes[start].id >= TWO_LEVEL_ID_LIMIT || nodes[start].id <= -TWO_LEVEL_ID_LIMIT) {
+        renumberSegment(tour, segIndex);
+    }
+    if (!seg->reversed) {
+        nodes[start].prev = city;
+        nodes[city].next = start;
+        nodes[city].prev = NO_CITY;
+        nodes[city].id = nodes[start].id - 1;
+        seg->first = city;
+    } else {
+        nodes[start].next = city;
+        nodes[city].prev = start;
+        nodes[city].next = NO_CITY;
+        nodes[city].id = nodes[start].id + 1;
+        seg->last = city;
+    }
+    nodes[city].parent = segIndex;
+    seg->size++;
+}
+
+//Splits the segment of city between its tour-order head (cities before city) and tail (city
+//onward) by moving the head to the end of the previous segment or the tail to the start of the
+//next one. The smaller side moves unless that would put a city in front of keepStart, which
+//must stay the first city of its segment. Returns the segment that grew, or NO_CITY.
+static u32 splitBefore(Tour* tour, u32 city, u32 keepStart) {
+    TourNode* nodes = tour->nodes;
+    u32 segIndex = nodes[city].parent;
+    TourSegment* seg = &tour->segments[segIndex];
+    u32 start = tourStartOf(seg);
+    if (start == city) return NO_CITY;
+    u32 headSize = (u32)(orientedId(tour, city) - orientedId(tour, start));
+    bool moveHead = headSize * 2 <= seg->size;
+    if (start == keepStart) moveHead = false;
+    else if (tourStartOf(&tour->segments[seg->next]) == keepStart) moveHead = true;
+
+    bool reversed = seg->reversed;
+    if (moveHead) {
+        u32 prevSeg = seg->prev;
+        u32 c = start;
+        for (u32 k = 0; k < headSize; k++) {
+            u32 next = reversed ? nodes[c].prev : nodes[c].next;
+            appendAtTourEnd(tour, prevSeg, c);
+            c = next;
+        }
+        if (reversed) seg->last = city;
+        else seg->first = city;
+        seg->size -= headSize;
+        return prevSeg;
+    }
+    u32 nextSeg = seg->next;
+    u32 tailSize = seg->size - headSize;
+    u32 c = tourEndOf(seg);
+    u32 newEnd = reversed ? nodes[city].next : nodes[city].prev;
+    for (u32 k = 0; k < tailSize; k++) {
+        u32 prev = reversed ? nodes[c].next : nodes[c].prev;
+        prependAtTourStart(tour, nextSeg, c);
+        c = prev;
+    }
+    if (reversed) seg->first = newEnd;
+    else seg->last = newEnd;
+    seg->size -= tailSize;
+    return nextSeg;
+}
+
+//Reverses the run of count segments starting at first in tour order; ranks are mirrored.
+static void reverseSegments(Tour* tour, u32 first, u32 last, u32 count) {
+    TourSegment* segs = tour->segments;
+    u32 before = segs[first].prev, after = segs[last].next;
+    u32 rank0 = segs[first].rank;
+    u32 s = first;
+    for (u32 k = 0; k < count; k++) {
+        TourSegment* seg = &segs[s];
+        u32 next = seg->next;
+        seg->next = seg->prev;
+        seg->prev = next;
+        seg->reversed ^= 1;
+        u32 rank = rank0 + count - 1 - k;
+        seg->rank = (rank >= tour->segmentCount) ? rank - tour->segmentCount : rank;
+        s = next;
+    }
+    segs[before].next = last;
+    segs[last].prev = before;
+    segs[first].next = after;
+    segs[after].prev = first;
+}
+
+static bool outgrown(const Tour* tour, u32 segIndex) {
+    return segIndex != NO_CITY && tour->segments[segIndex].size > TWO_LEVEL_REBUILD_FACTOR * tour->groupSize;
+}
+
+static void rebuildIfOutgrown(Tour* tour, u32 segA, u32 segB) {
+    if (!outgrown(tour, segA) && !outgrown(tour, segB)) return;
+    u32 city = 0;
+    for (u32 k = 0; k < tour->count; k++) {
+        tour->scratch[k] = city;
+        city = twoLevelNext(tour, city);
+    }
+    layoutTwoLevel(tour, tour->scratch);
+}
+
+//Length of the tour-order run a..b when it lies in one segment or spans two neighboring ones,
+//UINT32_MAX otherwise.
+static u32 shortRunLength(const Tour* tour, u32 a, u32 b) {
+    u32 sa = tour->nodes[a].parent, sb = tour->nodes[b].parent;
+    if (sa == sb) {
+        s32 ia = orientedId(tour, a), ib = orientedId(tour, b);
+        return (ia <= ib) ? (u32)(ib - ia) + 1 : UINT32_MAX;
+    }
+    const TourSegment* segA = &tour->segments[sa];
+    if (segA->next != sb) return UINT32_MAX;
+    return (u32)(orientedId(tour, tourEndOf(segA)) - orientedId(tour, a))
+         + (u32)(orientedId(tour, b) - orientedId(tour, tourStartOf(&tour->segments[sb]))) + 2;
+}
+
+//Connects a to b, its successor in tour order. Inside one segment that is a link along the
+//segment's orientation; across segments a becomes the tour end of its own and b the start of its.
+static inline void linkInTourOrder(Tour* tour, u32 a, u32 b) {
+    TourNode* nodes = tour->nodes;
+    TourSegment* segA = &tour->segments[nodes[a].parent];
+    if (nodes[a].parent == nodes[b].parent) {
+        if (segA->reversed) {
+            nodes[a].prev = b;
+            nodes[b].next = a;
+        } else {
+            nodes[a].next = b;
+            nodes[b].prev = a;
+        }
+        return;
+    }
+    TourSegment* segB = &tour->segments[nodes[b].parent];
+    if (segA->reversed) segA->first = a;
+    else segA->last = a;
+    if (segB->reversed) segB->last = b;
+    else segB->first = b;
+}
+
+//Reverses a short run that crosses a segment boundary without moving any boundary: the run's
+//slots (segment and id) stay put and the cities are written back into them in reverse order.
+static void reverseBySlots(Tour* tour, u32 from, u32 to, u32 len) {
+    TourNode* nodes = tour->nodes;
+    u32* path = tour->scratch;
+    u32* slotParent = path + len;
+    s32* slotId = (s32*)(path + 2 * len);
+    u32 before = twoLevelPrev(tour, from), after = twoLevelNext(tour, to);
+    u32 city = from;
+    for (u32 k = 0; k < len; k++) {
+        path[k] = city;
+        slotParent[k] = nodes[city].parent;
+        slotId[k] = nodes[city].id;
+        city = twoLevelNext(tour, city);
+    }
+    for (u32 k = 0; k < len; k++) {
+        u32 c = path[len - 1 - k];
+        nodes[c].parent = slotParent[k];
+        nodes[c].id = slotId[k];
+    }
+    linkInTourOrder(tour, before, to);
+    for (u32 k = len - 1; k > 0; k--) {
+        linkInTourOrder(tour, path[k], path[k - 1]);
+    }
+    linkInTourOrder(tour, from, after);
+}
+
+//Reverses a..b in O(len) when it is short; false when the run is too long for that.
+static bool reverseShortRun(Tour* tour, u32 a, u32 b, u32 limit) {
+    u32 len = shortRunLength(tour, a, b);
+    if (len > limit) return false;
+    if (tour->nodes[a].parent == tour->nodes[b].parent) reverseRunInSegment(tour, a, b);
+    else reverseBySlots(tour, a, b, len);
+    return true;
+}
+
+static void twoLevelReverse(Tour* tour, u32 from, u32 to) {
+    if (from == to) return;
+    TourNode* nodes = tour->nodes;
+    u32 a = twoLevelNext(tour, to), b = twoLevelPrev(tour, from);
+    if (a == from) return;              //the whole tour
+    //the slot buffer holds three words per city of the run
+    u32 limit = 2 * tour->groupSize;
+    if (limit > tour->count / 3) limit = tour->count / 3;
+    if (nodes[from].parent == nodes[to].parent && orientedId(tour, from) <= orientedId(tour, to)) {
+        reverseRunInSegment(tour, from, to);
+        return;
+    }
+    if (reverseShortRun(tour, from, to, limit) || reverseShortRun(tour, a, b, limit)) return;
+    if (nodes[a].parent == nodes[b].parent && orientedId(tour, a) <= orientedId(tour, b)) {
+        reverseRunInSegment(tour, a, b);
+        return;
+    }
+
+    u32 grewA = splitBefore(tour, from, NO_CITY);
+    u32 afterTo = twoLevelNext(tour, to);
+    u32 grewB = (afterTo != from) ? splitBefore(tour, afterTo, from) : NO_CITY;
+    u32 first = nodes[from].parent, last = nodes[to].parent;
+    u32 segCount = tour->segmentCount;
+    u32 run = tour->segments[last].rank + segCount - tour->segments[first].rank;
+    run = (run >= segCount ? run - segCount : run) + 1;
+    if (run * 2 <= segCount) {
+        reverseSegments(tour, first, last, run);
+    } else if (run < segCount) {
+        reverseSegments(tour, tour->segments[last].next, tour->segments[first].prev, segCount - run);
+    }
+    rebuildIfOutgrown(tour, grewA, grewB);
+}
+
+void TourReverse(Tour* tour, u32 from, u32 to) {
+    if (tour->kind == TOUR_TWO_LEVEL) {
+        twoLevelReverse(tour, from, to);
+        return;
+    }
+    u32 n = tour->count;
+    u32 i = tour->pos[from], j = tour->pos[to];
+    u32 len = ((j >= i) ? j - i : j + n - i) + 1;
+    if (len * 2 <= n) {
+        reversePositions(tour, i, j, len);
+    } else if (len < n) {
+        //the complement next(to)..prev(from)
+        reversePositions(tour, (j + 1 == n) ? 0 : j + 1, (i == 0) ? n - 1 : i - 1, n - len);
+    }
+}
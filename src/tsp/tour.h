@@ -0,0 +1,130 @@
+#ifndef tsp_TOUR_H
+#define tsp_TOUR_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+
+//Tours are arrays of city ids in visiting order; the closing edge back to tour[0] is implied.
+
+//Closed tour length summed in f64 from the packed matrix.
+f64 TourLength(DistanceMatrix dm, const u32* tour, u32 count);
+//True when tour visits every city in [0, count) exactly once. Uses a scratch bitmap.
+bool IsTourPermutation(ScratchArena *arena, const u32* tour, u32 count);
+
+typedef enum TourKind {
+    TOUR_ARRAY = 0,             //order/pos arrays, O(n) reversal of the shorter side
+    TOUR_TWO_LEVEL              //segments of ~sqrt(n) cities with reversal bits, O(sqrt n) reversal
+} TourKind;
+
+#define TWO_LEVEL_MIN_COUNT 8           //smaller tours always use TOUR_ARRAY
+#define TWO_LEVEL_REBUILD_FACTOR 4      //re-split when a segment outgrows this many group sizes
+#define TWO_LEVEL_ID_LIMIT (1 << 30)    //renumber a segment before its ids drift past this
+
+//City of a two-level tour. Links run along the segment's own orientation and stop at its ends.
+typedef struct {
+    u32 next;
+    u32 prev;
+    u32 parent;
+    s32 id;                     //consecutive, increasing along next
+} TourNode;
+
+//The tour runs first..last through a segment, or last..first when reversed.
+typedef struct {
+    u32 first;
+    u32 last;
+    u32 next;                   //neighboring segments in tour order
+    u32 prev;
+    u32 rank;                   //position in the segment cycle
+    u32 size;
+    u32 reversed;
+    u32 _pad;
+} TourSegment;
+
+//Mutable tour for local search. Moves only use TourNext, TourPrev, TourBetween and
+//TourReverse, so they work the same on every representation and in either orientation.
+typedef struct {
+    TourKind kind;
+    u32 count;
+    u32* order;                 //array: order[p] = city at position p
+    u32* pos;                   //array: pos[city] = position of city
+    TourNode* nodes;            //two-level: one per city
+    TourSegment* segments;
+    u32* scratch;               //two-level: count slots for re-splitting
+    u32 segmentCount;
+    u32 groupSize;
+} Tour;
+
+//Bytes CreateTourInBlock needs: all arrays of a tour share one block.
+usize TourBlockSize(TourKind kind, u32 count);
+//Lays the tour out in block, which must be 64 byte aligned and TourBlockSize bytes long.
+Tour CreateTourInBlock(memptr block, TourKind kind, const u32* order, u32 count);
+Tour CreateTour(ScratchArena *arena, TourKind kind, const u32* order, u32 count);
+Tour CreateTourPaged(PageArena *arena, TourKind kind, const u32* order, u32 count);
+//Writes the tour as a city array, starting at city 0 and following TourNext.
+void TourToArray(const Tour* tour, u32* out);
+
+static inline u32 twoLevelNext(const Tour* tour, u32 city) {
+    const TourNode* node = &tour->nodes[city];
+    const TourSegment* seg = &tour->segments[node->parent];
+    if (!seg->reversed) {
+        if (city != seg->last) return node->next;
+    } else if (city != seg->first) {
+        return node->prev;
+    }
+    const TourSegment* next = &tour->segments[seg->next];
+    return next->reversed ? next->last : next->first;
+}
+
+static inline u32 twoLevelPrev(const Tour* tour, u32 city) {
+    const TourNode* node = &tour->nodes[city];
+    const TourSegment* seg = &tour->segments[node->parent];
+    if (!seg->reversed) {
+        if (city != seg->first) return node->prev;
+    } else if (city != seg->last) {
+        return node->next;
+    }
+    const TourSegment* prev = &tour->segments[seg->prev];
+    return prev->reversed ? prev->first : prev->last;
+}
+
+//Sequence number in tour order from the segment at rank 0: segment rank, then the id as
+//seen through the reversal bit.
+static inline u64 twoLevelSequence(const Tour* tour, u32 city) {
+    const TourNode* node = &tour->nodes[city];
+    const TourSegment* seg = &tour->segments[node->parent];
+    s32 id = seg->reversed ? -node->id : node->id;
+    return ((u64)seg->rank << 32) | ((u32)id ^ 0x80000000u);
+}
+
+static inline u32 TourNext(const Tour* tour, u32 city) {
+    if (tour->kind == TOUR_TWO_LEVEL) return twoLevelNext(tour, city);
+    u32 p = tour->pos[city] + 1;
+    return tour->order[(p == tour->count) ? 0 : p];
+}
+
+static inline u32 TourPrev(const Tour* tour, u32 city) {
+    if (tour->kind == TOUR_TWO_LEVEL) return twoLevelPrev(tour, city);
+    u32 p = tour->pos[city];
+    return tour->order[(p == 0) ? tour->count - 1 : p - 1];
+}
+
+//Position-like key that increases along the tour from a fixed (representation-defined) start.
+static inline u64 TourSequence(const Tour* tour, u32 city) {
+    if (tour->kind == TOUR_TWO_LEVEL) return twoLevelSequence(tour, city);
+    return tour->pos[city];
+}
+
+//True when b lies on the forward path from a to c, ends included.
+static inline bool TourBetween(const Tour* tour, u32 a, u32 b, u32 c) {
+    u64 pa = TourSequence(tour, a), pb = TourSequence(tour, b), pc = TourSequence(tour, c);
+    if (pa <= pc) return pa <= pb && pb <= pc;
+    return pb >= pa || pb <= pc;
+}
+
+//Reverses the forward path from..to. The cyclic sequence that results is the same whichever
+//side is physically reversed, so the shorter side is (for two-level tours, counted in segments).
+void TourReverse(Tour* tour, u32 from, u32 to);
+
+#endif
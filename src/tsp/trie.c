@@ -1,18 +1,147 @@
+#include <string.h>
 #include "trie.h"
 #include "arena_base.h"
 #include "page_arena.h"
 
-TrieNode* searchChildByLabel(TrieNode* node, u16 label) { 
-    TrieChild* children = node->children;
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <emmintrin.h>
+#define FROZEN_HAS_SSE2 1
+#endif
+
+TrieAllocator createTrieAllocator(PageArena* arena) {
+    TrieAllocator alloc = { .arena = arena, .nodeBlock = NULL, .nodeBlockUsed = TRIE_NODE_BLOCK, .epoch = NULL,
+                            .arraysReused = 0, .arraysRetired = 0, .arraysDropped = 0, .nodeCount = 0 };
+    for (u32 c = 0; c <= TRIE_SIZE_CLASSES; c++) {
+        alloc.freeLists[c] = NULL;
+    }
+    return alloc;
+}
+
+TrieAllocator createConcurrentTrieAllocator(PageArena* arena) {
+    TrieAllocator alloc = createTrieAllocator(arena);
+    TrieEpoch* epoch = arenaPageAlloc(arena, sizeof(TrieEpoch), ALIGN_64);
+    if (!epoch) {
+        LOG_ERROR("Page arena too small for trie reader slots");
+        return alloc;
+    }
+    memset(epoch, 0, sizeof(TrieEpoch));
+    epoch->global = 1;
+    alloc.epoch = epoch;
+    return alloc;
+}
+
+TrieNode* createTrieNode(TrieAllocator* alloc, u16 label) {
+    if (alloc->nodeBlockUsed == TRIE_NODE_BLOCK) {
+        alloc->nodeBlock = arenaPageAlloc(alloc->arena, sizeof(TrieNode) * TRIE_NODE_BLOCK, ALIGN_64);
+        if (!alloc->nodeBlock) {
+            LOG_ERROR("Page arena too small for a block of trie nodes");
+            return NULL;
+        }
+        alloc->nodeBlockUsed = 0;
+    }
+    TrieNode* node = &alloc->nodeBlock[alloc->nodeBlockUsed++];
+    alloc->nodeCount++;
+    node->children = (TrieChildren*)node->inlineBlock;
+    node->children->count = 0;
+    node->children->sizeClass = 0;
+    node->children->isInline = 1;
+    node->lutIndex = LUT_NONE;
+    node->label = label;
+    node->isTerminal = 0;
+    return node;
+}
+
+static inline u32 classCapacity(u8 sizeClass) {
+    return (u32)TRIE_INLINE_CHILDREN << sizeClass;
+}
+
+//A freed array keeps the next free array of its class in its first bytes.
+static TrieChildren* allocChildren(TrieAllocator* alloc, u8 sizeClass) {
+    TrieChildren* array = alloc->freeLists[sizeClass];
+    if (array) {
+        memcpy(&alloc->freeLists[sizeClass], array, sizeof(TrieChildren*));
+        alloc->arraysReused++;
+    } else {
+        array = arenaPageAlloc(alloc->arena, sizeof(TrieChildren) + sizeof(TrieChild) * classCapacity(sizeClass),
+                               ALIGN_8);
+        if (!array) return NULL;
+    }
+    array->sizeClass = sizeClass;
+    array->isInline = 0;
+    return array;
+}
+
+static void freeChildren(TrieAllocator* alloc, TrieChildren* array) {
+    u8 sizeClass = array->sizeClass;
+    memcpy(array, &alloc->freeLists[sizeClass], sizeof(TrieChildren*));
+    alloc->freeLists[sizeClass] = array;
+}
+
+static void retireChildren(TrieAllocator* alloc, TrieChildren* array) {
+    TrieEpoch* epoch = alloc->epoch;
+    if (!epoch) {
+        freeChildren(alloc, array);
+        return;
+    }
+    if (++alloc->arraysRetired % TRIE_RECLAIM_BATCH == 0 || epoch->limboCount == TRIE_LIMBO) {
+        reclaimTrieArrays(alloc);
+    }
+    if (epoch->limboCount == TRIE_LIMBO) {
+        //a reader is pinning the oldest epoch; leave that array to the arena rather than wait
+        epoch->limboHead = (epoch->limboHead + 1) % TRIE_LIMBO;
+        epoch->limboCount--;
+        alloc->arraysDropped++;
+    }
+    u32 tail = (epoch->limboHead + epoch->limboCount) % TRIE_LIMBO;
+    epoch->limbo[tail] = (TrieRetired){ .array = array, .epoch = __atomic_load_n(&epoch->global, __ATOMIC_RELAXED) };
+    epoch->limboCount++;
+}
+
+u32 reclaimTrieArrays(TrieAllocator* alloc) {
+    TrieEpoch* epoch = alloc->epoch;
+    if (!epoch) return 0;
+    //Readers entering from here on announce a later epoch than anything in limbo. The fence
+    //pairs with the one in trieReadBegin: a reader whose announcement is missed below is
+    //ordered after the unlinking stores and cannot reach the arrays freed here.
+    __atomic_add_fetch(&epoch->global, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    u64 oldest = UINT64_MAX;
+    for (u32 r = 0; r < TRIE_MAX_READERS; r++) {
+        u64 announced = __atomic_load_n(&epoch->readers[r].epoch, __ATOMIC_ACQUIRE);
+        if (announced && announced < oldest) oldest = announced;
+    }
+    u32 reclaimed = 0;
+    while (epoch->limboCount > 0 && epoch->limbo[epoch->limboHead].epoch < oldest) {
+        freeChildren(alloc, epoch->limbo[epoch->limboHead].array);
+        epoch->limboHead = (epoch->limboHead + 1) % TRIE_LIMBO;
+        epoch->limboCount--;
+        reclaimed++;
+    }
+    return reclaimed;
+}
+
+void trieReadBegin(TrieEpoch* epoch, u32 reader) {
+    u64 current = __atomic_load_n(&epoch->global, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&epoch->readers[reader].epoch, current, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void trieReadEnd(TrieEpoch* epoch, u32 reader) {
+    __atomic_store_n(&epoch->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+TrieNode* searchChildByLabel(TrieNode* node, u16 label) {
+    const TrieChildren* children = __atomic_load_n(&node->children, __ATOMIC_ACQUIRE);
+    const TrieChild* entries = children->entries;
     u16 left = 0;
-    u16 right = node->childCount;
+    u16 right = __atomic_load_n(&children->count, __ATOMIC_ACQUIRE);
 
     while (left < right) {
         u16 mid = left + (right - left) / 2;
-        if(children[mid].label == label) {
-            return children[mid].child;
+        if(entries[mid].label == label) {
+            return entries[mid].child;
         }
-        if(children[mid].label < label) {
+        if(entries[mid].label < label) {
             left = mid + 1;
         } else {
             right = mid;
@@ -21,26 +150,44 @@ TrieNode* searchChildByLabel(TrieNode* node, u16 label) {
     return NULL;
 }
 
-void insertChildSorted(PageArena* arena, TrieNode* node, u16 label, TrieNode* child) {
-    usize newSize = sizeof(TrieChild) * (node->childCount + 1);
-    TrieChild* newChildren = arenaPageAlloc(arena, newSize, ALIGN_8);
-
-    u16 i = 0, j = 0;
-    while (i < node->childCount && node->children[i].label < label) {
-        newChildren[j++] = node->children[i++];
+bool insertChildSorted(TrieAllocator* alloc, TrieNode* node, u16 label, TrieNode* child) {
+    TrieChildren* children = node->children;
+    u16 count = children->count;
+    if (count == UINT16_MAX) {
+        LOG_ERROR("Trie node already holds %u children", count);
+        return false;
     }
+    u16 i = count;
+    while (i > 0 && children->entries[i - 1].label > label) {
+        i--;
+    }
+    bool full = (count == classCapacity(children->sizeClass));
 
-    newChildren[j++] = (TrieChild){ .label = label, .child = child };
-
-    while (i < node->childCount) {
-        newChildren[j++] = node->children[i++];
+    //Without readers any insert that fits is done in place; with them only an append is.
+    if (!full && (i == count || !alloc->epoch)) {
+        memmove(&children->entries[i + 1], &children->entries[i], sizeof(TrieChild) * (count - i));
+        children->entries[i] = (TrieChild){ .label = label, .child = child };
+        __atomic_store_n(&children->count, count + 1, __ATOMIC_RELEASE);
+        return true;
     }
 
-    node->children = newChildren;
-    node->childCount += 1;
+    u8 sizeClass = full ? children->sizeClass + 1 : children->sizeClass;
+    if (sizeClass > TRIE_SIZE_CLASSES) return false;
+    TrieChildren* copy = allocChildren(alloc, sizeClass);
+    if (!copy) {
+        LOG_ERROR("Page arena too small for %u trie children", classCapacity(sizeClass));
+        return false;
+    }
+    memcpy(copy->entries, children->entries, sizeof(TrieChild) * i);
+    copy->entries[i] = (TrieChild){ .label = label, .child = child };
+    memcpy(copy->entries + i + 1, children->entries + i, sizeof(TrieChild) * (count - i));
+    copy->count = count + 1;
+    __atomic_store_n(&node->children, copy, __ATOMIC_RELEASE);
+    if (!children->isInline) retireChildren(alloc, children);
+    return true;
 }
 
-TrieNode* insertTrie(PageArena* arena, TrieNode* root, u16* path, u16 pathLen, memptr lutPtr) {
+TrieNode* insertTrie(TrieAllocator* alloc, TrieNode* root, u16* path, u16 pathLen, u32 lutIndex) {
     TrieNode* node = root;
 
     for (u16 i = 0; i < pathLen; ++i) {
@@ -48,20 +195,13 @@ TrieNode* insertTrie(PageArena* arena, TrieNode* root, u16* path, u16 pathLen, m
 
         TrieNode* next = searchChildByLabel(node, label);
         if(!next) {
-            next = arenaPageAlloc(arena, sizeof(TrieNode), ALIGN_8);
-            *next = (TrieNode) { 
-                .label = label,
-                .isTerminal = 0,
-                .childCount = 0,
-                .children = NULL,
-                .lutPtr = NULL
-            };
-            insertChildSorted(arena, node, label, next);
+            next = createTrieNode(alloc, label);
+            if (!next || !insertChildSorted(alloc, node, label, next)) return NULL;
         }
         node = next;
     }
-    node->isTerminal = 1;
-    node->lutPtr = lutPtr;
+    __atomic_store_n(&node->lutIndex, lutIndex, __ATOMIC_RELAXED);
+    __atomic_store_n(&node->isTerminal, 1, __ATOMIC_RELEASE);
     return node;
 }
 
@@ -73,5 +213,143 @@ TrieNode* searchTrie(TrieNode* root, u16* path, u16 pathLen) {
         node = searchChildByLabel(node, path[i]);
         if (!node) return NULL;
     }
-    return (node->isTerminal) ? node : NULL;
+    return __atomic_load_n(&node->isTerminal, __ATOMIC_ACQUIRE) ? node : NULL;
+}
+
+FrozenTrie freezeTrie(PageArena* arena, const TrieAllocator* alloc, const TrieNode* root) {
+    FrozenTrie trie = { .labels = NULL, .childStart = NULL, .terminal = NULL, .lutIndex = NULL, .nodeCount = 0 };
+    u32 capacity = alloc->nodeCount;
+    usize saved = arenaPageMark(arena);
+    u16* labels = arenaPageAlloc(arena, sizeof(u16) * ((usize)capacity + FROZEN_SCAN), ALIGN_64);
+    u32* childStart = arenaPageAlloc(arena, sizeof(u32) * ((usize)capacity + 1), ALIGN_64);
+    u8* terminal = arenaPageAlloc(arena, capacity, ALIGN_64);
+    u32* lutIndex = arenaPageAlloc(arena, sizeof(u32) * capacity, ALIGN_64);
+    usize start = arenaPageMark(arena);         //the queue sits above this mark, dropped after the walk
+    const TrieNode** queue = arenaPageAlloc(arena, sizeof(TrieNode*) * capacity, ALIGN_8);
+    if (!queue || !labels || !childStart || !terminal || !lutIndex) {
+        LOG_ERROR("Page arena too small to freeze a trie of %u nodes", capacity);
+        arenaPageRewind(arena, start);
+        arenaPageRewind(arena, saved);
+        return trie;
+    }
+
+    //Children are appended in sorted order as their parent is dequeued, so every sibling range
+    //is contiguous, sorted, and starts where the previous node's range ended.
+    queue[0] = root;
+    labels[0] = root->label;
+    u32 tail = 1;
+    for (u32 head = 0; head < tail; head++) {
+        const TrieNode* node = queue[head];
+        childStart[head] = tail;
+        terminal[head] = node->isTerminal;
+        lutIndex[head] = node->lutIndex;
+        const TrieChildren* children = node->children;
+        if (children->count > capacity - tail) {
+            LOG_ERROR("Trie holds more nodes than the %u its allocator counted", capacity);
+            arenaPageRewind(arena, start);
+            arenaPageRewind(arena, saved);
+            return trie;
+        }
+        for (u16 c = 0; c < children->count; c++) {
+            labels[tail] = children->entries[c].label;
+            queue[tail++] = children->entries[c].child;
+        }
+    }
+    childStart[tail] = tail;
+    for (u32 i = tail; i < tail + FROZEN_SCAN; i++) {
+        labels[i] = 0;
+    }
+    arenaPageRewind(arena, saved);              //previous still marks the queue, so this keeps the arrays
+
+    trie.labels = labels;
+    trie.childStart = childStart;
+    trie.terminal = terminal;
+    trie.lutIndex = lutIndex;
+    trie.nodeCount = tail;
+    return trie;
+}
+
+//Index of label within labels[begin, end), FROZEN_MISS if absent. Wide ranges are halved until
+//FROZEN_SCAN candidates remain, then compared in one pass.
+static inline u32 findFrozenChild(const u16* labels, u32 begin, u32 end, u16 label) {
+    while (end - begin > FROZEN_SCAN) {
+        u32 mid = begin + (end - begin) / 2;
+        if (labels[mid] <= label) {
+            begin = mid;
+        } else {
+            end = mid;
+        }
+    }
+#ifdef FROZEN_HAS_SSE2
+    __m128i needle = _mm_set1_epi16((s16)label);
+    __m128i lo = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(labels + begin)), needle);
+    __m128i hi = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(labels + begin + 8)), needle);
+    u32 mask = (u32)_mm_movemask_epi8(_mm_packs_epi16(lo, hi)) & ((1u << (end - begin)) - 1);
+    return mask ? begin + (u32)__builtin_ctz(mask) : FROZEN_MISS;
+#else
+    for (u32 i = begin; i < end; i++) {
+        if (labels[i] == label) return i;
+    }
+    return FROZEN_MISS;
+#endif
+}
+
+u32 searchFrozenTrie(const FrozenTrie* trie, const u16* path, u16 pathLen) {
+    u32 node = 0;
+    for (u16 i = 0; i < pathLen; i++) {
+        node = findFrozenChild(trie->labels, trie->childStart[node], trie->childStart[node + 1], path[i]);
+        if (node == FROZEN_MISS) return FROZEN_MISS;
+    }
+    return trie->terminal[node] ? node : FROZEN_MISS;
+}
+
+void searchFrozenTrieBatch(const FrozenTrie* trie, const u16* paths, u32 pathStride, const u16* pathLens,
+                           u32 count, u32* out) {
+    u32 node[FROZEN_BATCH];
+    u32 begin[FROZEN_BATCH];
+    u32 end[FROZEN_BATCH];
+    u16 depth[FROZEN_BATCH];
+    bool ranged[FROZEN_BATCH];
+    for (u32 base = 0; base < count; base += FROZEN_BATCH) {
+        u32 lanes = (count - base < FROZEN_BATCH) ? count - base : FROZEN_BATCH;
+        u32 active = 0;
+        for (u32 q = 0; q < lanes; q++) {
+            node[q] = 0;
+            depth[q] = 0;
+            ranged[q] = false;
+            if (pathLens[base + q] == 0) {
+                out[base + q] = trie->terminal[0] ? 0 : FROZEN_MISS;
+            } else {
+                active++;
+            }
+        }
+        //A level takes a lane two turns: read the child range of its node and prefetch the labels,
+        //then scan them and prefetch the next node's range. The other lanes run in between, so
+        //both loads are usually in cache by the time they are used.
+        while (active > 0) {
+            for (u32 q = 0; q < lanes; q++) {
+                u16 len = pathLens[base + q];
+                if (depth[q] == len) continue;
+                if (!ranged[q]) {
+                    begin[q] = trie->childStart[node[q]];
+                    end[q] = trie->childStart[node[q] + 1];
+                    __builtin_prefetch(&trie->labels[begin[q] + (end[q] - begin[q]) / 2]);
+                    ranged[q] = true;
+                    continue;
+                }
+                const u16* path = paths + (usize)(base + q) * pathStride;
+                u32 next = findFrozenChild(trie->labels, begin[q], end[q], path[depth[q]]);
+                depth[q]++;
+                ranged[q] = false;
+                if (next == FROZEN_MISS || depth[q] == len) {
+                    out[base + q] = (next != FROZEN_MISS && trie->terminal[next]) ? next : FROZEN_MISS;
+                    depth[q] = len;
+                    active--;
+                    continue;
+                }
+                node[q] = next;
+                __builtin_prefetch(&trie->childStart[next]);
+            }
+        }
+    }
 }
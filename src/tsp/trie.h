@@ -3,26 +3,130 @@
 
 #include "common_types.h"
 #include "page_arena.h"
+#include "lut.h"
+
+#define TRIE_INLINE_CHILDREN 2      //children held in the node itself before an array is needed
+#define TRIE_SIZE_CLASSES 16        //child arrays of TRIE_INLINE_CHILDREN << 1 .. << 16 entries
+#define TRIE_NODE_BLOCK 256         //nodes carved from the arena at once
+#define FROZEN_SCAN 16              //labels compared at once; longer ranges binary search down to this
+#define FROZEN_BATCH 16             //searches kept in flight by searchFrozenTrieBatch
+#define FROZEN_MISS UINT32_MAX
+
+#define TRIE_MAX_READERS 256         //reader slots, one per thread pool worker
+#define TRIE_LIMBO 1024              //retired child arrays waiting out their readers
+#define TRIE_RECLAIM_BATCH 64        //retirements between reclamation passes
 
 struct TrieNode;
 struct TrieChild;
 
+typedef struct TrieChild {
+    u16 label;
+    struct TrieNode* child;
+} TrieChild;
+
+//A node's children with their count, so one pointer load gives a reader a consistent view.
+//Entries below count are never written again while the array is reachable: a new child is
+//either appended into free capacity and then made visible by a release store of count, or
+//the array is copied with the child in place and the copy published by a release store of
+//the node's children pointer.
+typedef struct TrieChildren {
+    u16 count;
+    u8 sizeClass;                   //capacity is TRIE_INLINE_CHILDREN << sizeClass
+    u8 isInline;                    //the block inside the node, never retired
+    TrieChild entries[];
+} TrieChildren;
+
+#define TRIE_INLINE_WORDS ((sizeof(TrieChildren) + sizeof(TrieChild) * TRIE_INLINE_CHILDREN) / sizeof(u64))
+
+//children points at the node's own block until the fan-out passes TRIE_INLINE_CHILDREN, then
+//at an array from the allocator whose capacity doubles as it fills.
 typedef struct TrieNode{
-    struct TrieChild* children;
-    memptr lutPtr;
+    TrieChildren* children;
+    u32 lutIndex;                   //record of the fragment ending here, LUT_NONE if not terminal
     u16 label;
-    u16 childCount;
-    u8 isTerminal;
+    u8 isTerminal;                  //set with a release store after lutIndex
+    u64 inlineBlock[TRIE_INLINE_WORDS];
 } TrieNode;
 
-typedef struct TrieChild {
-    u16 label;
-    TrieNode* child;
-} TrieChild;
+//Reader announcements for epoch reclamation, each on its own cache line. A reader inside a
+//search holds the global epoch it saw on entry, 0 outside one.
+typedef struct {
+    u64 epoch;
+    u8 _pad[56];
+} TrieReaderSlot;
+
+typedef struct {
+    TrieChildren* array;
+    u64 epoch;                      //global epoch when the array was unlinked
+} TrieRetired;
+
+//An array unlinked at epoch e can only still be held by readers that announced e or earlier,
+//so it goes back to the free lists once every active reader announces a later epoch.
+typedef struct {
+    u64 global;
+    u8 _pad[56];
+    TrieReaderSlot readers[TRIE_MAX_READERS];
+    TrieRetired limbo[TRIE_LIMBO];  //writer only, oldest first
+    u32 limboHead;
+    u32 limboCount;
+} TrieEpoch;
+
+//Node pool and per-size-class free lists of child arrays on top of a PageArena. An array
+//outgrown by a node goes to the free list of its class and is handed to the next node that
+//grows into that class, so the arena only sees each capacity once per live array. With an
+//epoch the trie has one writer and any number of wait-free readers: outgrown arrays wait in
+//limbo until no reader can hold them, and a limbo full of arrays pinned by a stalled reader
+//drops the oldest instead of blocking.
+typedef struct {
+    PageArena* arena;
+    TrieNode* nodeBlock;
+    u32 nodeBlockUsed;
+    TrieChildren* freeLists[TRIE_SIZE_CLASSES + 1];
+    TrieEpoch* epoch;               //NULL for a single-threaded trie
+    u64 arraysReused;
+    u64 arraysRetired;
+    u64 arraysDropped;
+    u32 nodeCount;
+} TrieAllocator;
+
+//Read-only copy of a trie in breadth-first order. The children of node i are the nodes
+//childStart[i] .. childStart[i + 1] - 1, so labels doubles as every node's sorted child label
+//array and a level step is one scan of a contiguous u16 range. labels is padded by FROZEN_SCAN
+//entries so vector loads may run past the last node.
+typedef struct {
+    u16* labels;
+    u32* childStart;                //nodeCount + 1 entries
+    u8* terminal;
+    u32* lutIndex;
+    u32 nodeCount;
+} FrozenTrie;
+
+TrieAllocator createTrieAllocator(PageArena* arena);
+//Allocator for a trie read by other threads while this one inserts; epoch is NULL on failure.
+TrieAllocator createConcurrentTrieAllocator(PageArena* arena);
+TrieNode* createTrieNode(TrieAllocator* alloc, u16 label);
 
 TrieNode* searchChildByLabel(TrieNode* node, u16 label);
-void insertChildSorted(PageArena* arena, TrieNode* node, u16 label, TrieNode* child);
-TrieNode* insertTrie(PageArena* arena, TrieNode* root, u16* path, u16 pathLen, memptr lutPtr);
+bool insertChildSorted(TrieAllocator* alloc, TrieNode* node, u16 label, TrieNode* child);
+TrieNode* insertTrie(TrieAllocator* alloc, TrieNode* root, u16* path, u16 pathLen, u32 lutIndex);
 TrieNode* searchTrie(TrieNode* root, u16* path, u16 pathLen);
 
+//Brackets the searches of reader (below TRIE_MAX_READERS) on a concurrently written trie.
+//Both are a few stores, so readers never wait on the writer.
+void trieReadBegin(TrieEpoch* epoch, u32 reader);
+void trieReadEnd(TrieEpoch* epoch, u32 reader);
+//Moves retired arrays no reader can hold back to the free lists; returns how many. Inserts
+//call it every TRIE_RECLAIM_BATCH retirements.
+u32 reclaimTrieArrays(TrieAllocator* alloc);
+
+//Compacts the trie under root into one arena block; the pointer trie is left untouched.
+FrozenTrie freezeTrie(PageArena* arena, const TrieAllocator* alloc, const TrieNode* root);
+//Index of the terminal node for path, FROZEN_MISS otherwise.
+u32 searchFrozenTrie(const FrozenTrie* trie, const u16* path, u16 pathLen);
+//Searches count paths, path q starting at paths + q * pathStride, writing each result to out[q].
+//Up to FROZEN_BATCH searches advance one level per turn, each prefetching its next child range
+//while the others run, so cache misses overlap instead of queueing.
+void searchFrozenTrieBatch(const FrozenTrie* trie, const u16* paths, u32 pathStride, const u16* pathLens,
+                           u32 count, u32* out);
+
 #endif
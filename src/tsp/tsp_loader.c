@@ -0,0 +1,534 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tsp_loader.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "thread_pool.h"
+
+static const f64 pow10Table[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isDigit(char c) {
+    return (u8)(c - '0') < 10;
+}
+
+static inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool isKeywordStart(char c) {
+    return (u8)((c | 0x20) - 'a') < 26;
+}
+
+static inline const char* skipBlank(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) p++;
+    return p;
+}
+
+static inline const char* findLineEnd(const char* p, const char* end) {
+    const char* nl = memchr(p, '\n', (usize)(end - p));
+    return nl ? nl : end;
+}
+
+static bool matchKeyword(const char* p, const char* end, const char* keyword) {
+    usize len = strlen(keyword);
+    return (usize)(end - p) >= len && memcmp(p, keyword, len) == 0;
+}
+
+//True for a line that closes a data section: EOF or the header of another *_SECTION. Any
+//other line starting with a letter is malformed data, not a keyword.
+static bool isSectionEnd(const char* q, const char* eol) {
+    const char* tokenEnd = q;
+    while (tokenEnd < eol && !isBlank(*tokenEnd) && *tokenEnd != ':') tokenEnd++;
+    usize len = (usize)(tokenEnd - q);
+    static const char suffix[] = "_SECTION";
+    usize suffixLen = sizeof(suffix) - 1;
+    if (len == 3 && memcmp(q, "EOF", 3) == 0) return true;
+    return len > suffixLen && memcmp(tokenEnd - suffixLen, suffix, suffixLen) == 0;
+}
+
+static const char* parseU32(const char* p, const char* end, u32* out) {
+    u64 value = 0;
+    const char* start = p;
+    while (p < end && isDigit(*p)) {
+        value = value * 10 + (u64)(*p - '0');
+        if (value > UINT32_MAX) return NULL;
+        p++;
+    }
+    if (p == start) return NULL;
+    *out = (u32)value;
+    return p;
+}
+
+//Decimal mantissa is gathered as an integer (first 19 significant digits) and scaled once
+//by an exact power of ten, so common TSPLIB values like 82966.6667 round the same way
+//strtof would.
+static const char* parseF32(const char* p, const char* end, f32* out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    u64 mantissa = 0;
+    s32 exponent = 0;
+    u32 digits = 0;
+    bool any = false;
+
+    while (p < end && isDigit(*p)) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (u64)(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            exponent++;
+        }
+        any = true;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (u64)(*p - '0');
+                if (mantissa) digits++;
+                exponent--;
+            }
+            any = true;
+            p++;
+        }
+    }
+    if (!any) return NULL;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        s32 sign = 1;
+        if (p < end && (*p == '-' || *p == '+')) {
+            sign = (*p == '-') ? -1 : 1;
+            p++;
+        }
+        if (p >= end || !isDigit(*p)) return NULL;
+        s32 e = 0;
+        while (p < end && isDigit(*p)) {
+            if (e < 1000) e = e * 10 + (*p - '0');
+            p++;
+        }
+        exponent += sign * e;
+    }
+
+    f64 value = (f64)mantissa;
+    if (exponent < 0) {
+        while (exponent < -22) { value /= 1e22; exponent += 22; }
+        value /= pow10Table[-exponent];
+    } else if (exponent > 0) {
+        while (exponent > 22) { value *= 1e22; exponent -= 22; }
+        value *= pow10Table[exponent];
+    }
+    *out = negative ? -(f32)value : (f32)value;
+    return p;
+}
+
+static u32 lineNumberAt(const char* base, const char* at) {
+    u32 line = 1;
+    for (const char* p = base; p < at; p++) {
+        if (*p == '\n') line++;
+    }
+    return line;
+}
+
+typedef struct {
+    const char* name;
+    u32 value;
+} TspKeyword;
+
+static const TspKeyword metricNames[] = {
+    { "EUC_2D",     TSP_METRIC_EUC_2D },
+    { "CEIL_2D",    TSP_METRIC_CEIL_2D },
+    { "ATT",        TSP_METRIC_ATT },
+    { "GEO",        TSP_METRIC_GEO },
+    { "EXPLICIT",   TSP_METRIC_EXPLICIT }
+};
+
+static const TspKeyword formatNames[] = {
+    { "FULL_MATRIX",    TSP_FORMAT_FULL_MATRIX },
+    { "UPPER_ROW",      TSP_FORMAT_UPPER_ROW },
+    { "LOWER_ROW",      TSP_FORMAT_LOWER_ROW },
+    { "UPPER_DIAG_ROW", TSP_FORMAT_UPPER_DIAG_ROW },
+    { "LOWER_DIAG_ROW", TSP_FORMAT_LOWER_DIAG_ROW }
+};
+
+//Returns the value after "KEY :" on a header line.
+static const char* headerValue(const char* key, const char* eol, const char* keyword) {
+    const char* v = skipBlank(key + strlen(keyword), eol);
+    if (v < eol && *v == ':') v++;
+    return skipBlank(v, eol);
+}
+
+static bool matchToken(const char* v, const char* eol, const TspKeyword* table, u32 tableCount, u32* out) {
+    const char* tokenEnd = v;
+    while (tokenEnd < eol && !isBlank(*tokenEnd)) tokenEnd++;
+    usize len = (usize)(tokenEnd - v);
+    for (u32 k = 0; k < tableCount; k++) {
+        if (strlen(table[k].name) == len && memcmp(v, table[k].name, len) == 0) {
+            *out = table[k].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+//Reads "KEY : VALUE" specification lines up to the data section the metric needs:
+//NODE_COORD_SECTION for coordinate metrics, EDGE_WEIGHT_SECTION for EXPLICIT. Returns the
+//first byte of that section or NULL if it was never found or the header is unusable.
+static const char* parseHeader(const char* base, const char* end, TspInstance* inst) {
+    const char* p = base;
+    inst->dimension = 0;
+    inst->metric = TSP_METRIC_EUC_2D;
+    inst->weightFormat = TSP_FORMAT_NONE;
+    while (p < end) {
+        const char* eol = findLineEnd(p, end);
+        const char* key = skipBlank(p, eol);
+        const char* next = (eol < end) ? eol + 1 : end;
+
+        if (matchKeyword(key, eol, "NODE_COORD_SECTION") && inst->metric != TSP_METRIC_EXPLICIT) {
+            return next;
+        }
+        if (matchKeyword(key, eol, "EDGE_WEIGHT_SECTION") && inst->metric == TSP_METRIC_EXPLICIT) {
+            return next;
+        }
+        if (matchKeyword(key, eol, "DIMENSION")) {
+            if (!parseU32(headerValue(key, eol, "DIMENSION"), eol, &inst->dimension)) {
+                LOG_ERROR("Malformed DIMENSION header on line %u", lineNumberAt(base, p));
+                return NULL;
+            }
+        } else if (matchKeyword(key, eol, "EDGE_WEIGHT_TYPE")) {
+            u32 metric;
+            if (!matchToken(headerValue(key, eol, "EDGE_WEIGHT_TYPE"), eol, metricNames, ARRAY_COUNT(metricNames), &metric)) {
+                LOG_ERROR("Unsupported EDGE_WEIGHT_TYPE on line %u", lineNumberAt(base, p));
+                return NULL;
+            }
+            inst->metric = (TspMetric)metric;
+        } else if (matchKeyword(key, eol, "EDGE_WEIGHT_FORMAT")) {
+            u32 format;
+            if (!matchToken(headerValue(key, eol, "EDGE_WEIGHT_FORMAT"), eol, formatNames, ARRAY_COUNT(formatNames), &format)) {
+                LOG_ERROR("Unsupported EDGE_WEIGHT_FORMAT on line %u", lineNumberAt(base, p));
+                return NULL;
+            }
+            inst->weightFormat = (TspWeightFormat)format;
+        } else if (matchKeyword(key, eol, "EOF")) {
+            return NULL;
+        }
+        p = next;
+    }
+    return NULL;
+}
+
+//Next whitespace separated number of an EDGE_WEIGHT_SECTION, which may wrap lines freely.
+static inline const char* nextWeight(const char* p, const char* end, f32* out) {
+    while (p < end && (isBlank(*p) || *p == '\n')) p++;
+    if (p == end || isKeywordStart(*p)) return NULL;
+    p = parseF32(p, end, out);
+    if (p && p < end && !isBlank(*p) && *p != '\n') return NULL;
+    return p;
+}
+
+#define READ_WEIGHT(w) do { const char* at = p; p = nextWeight(p, end, &(w)); if (!p) { p = at; goto malformed; } } while (0)
+
+//Streams the weight section straight into the packed triangle. The row-major upper formats
+//are already in packed order; lower formats scatter into column c of row r's mirror.
+static TspLoadStatus parseWeights(const char* p, const char* end, TspWeightFormat format, u32 n,
+                                  f32* dist, const char** errorAt) {
+    f32 w;
+    const char* start = p;
+    switch (format) {
+        case TSP_FORMAT_FULL_MATRIX:
+            for (u32 r = 0; r < n; r++) {
+                for (u32 c = 0; c <= r; c++) READ_WEIGHT(w);
+                for (u32 c = r + 1; c < n; c++) READ_WEIGHT(*dist++);
+            }
+            break;
+        case TSP_FORMAT_UPPER_ROW:
+            for (u32 r = 0; r + 1 < n; r++) {
+                for (u32 c = r + 1; c < n; c++) READ_WEIGHT(*dist++);
+            }
+            break;
+        case TSP_FORMAT_UPPER_DIAG_ROW:
+            for (u32 r = 0; r < n; r++) {
+                READ_WEIGHT(w);
+                for (u32 c = r + 1; c < n; c++) READ_WEIGHT(*dist++);
+            }
+            break;
+        case TSP_FORMAT_LOWER_ROW:
+            for (u32 r = 1; r < n; r++) {
+                for (u32 c = 0; c < r; c++) READ_WEIGHT(dist[PackedIndex(n, c, r)]);
+            }
+            break;
+        case TSP_FORMAT_LOWER_DIAG_ROW:
+            for (u32 r = 0; r < n; r++) {
+                for (u32 c = 0; c < r; c++) READ_WEIGHT(dist[PackedIndex(n, c, r)]);
+                READ_WEIGHT(w);
+            }
+            break;
+        default:
+            *errorAt = start;
+            return TSP_LOAD_ERR_HEADER;
+    }
+    return TSP_LOAD_OK;
+
+malformed:
+    while (p < end && (isBlank(*p) || *p == '\n')) p++;
+    *errorAt = p;
+    return TSP_LOAD_ERR_PARSE;
+}
+
+#undef READ_WEIGHT
+
+//Parses "index x y" lines in [p, end) into coords[index - 1]. Stops at EOF or another
+//section header, or the end of the range. seen holds one bit per node index, set atomically
+//so chunks parsed in parallel also catch an index repeated in another chunk.
+//On a malformed or repeated line *errorAt points at the start of that line.
+static TspLoadStatus parseCoordLines(const char* p, const char* end, Vec2* coords, u64* seen, u32 dimension,
+                                     u32* outCount, const char** errorAt) {
+    u32 count = 0;
+    while (p < end) {
+        const char* eol = findLineEnd(p, end);
+        const char* q = skipBlank(p, eol);
+
+        if (q == eol) {
+            p = (eol < end) ? eol + 1 : end;
+            continue;
+        }
+        if (isSectionEnd(q, eol)) {
+            break;
+        }
+
+        u32 index;
+        f32 x, y;
+        q = parseU32(q, eol, &index);
+        if (q && q < eol && isBlank(*q)) q = parseF32(skipBlank(q, eol), eol, &x); else q = NULL;
+        if (q && q < eol && isBlank(*q)) q = parseF32(skipBlank(q, eol), eol, &y); else q = NULL;
+        if (q) q = skipBlank(q, eol);
+
+        u64 bit = (q && q == eol && index >= 1 && index <= dimension) ? 1ull << ((index - 1) & 63) : 0;
+        if (!bit || (__atomic_fetch_or(&seen[(index - 1) >> 6], bit, __ATOMIC_RELAXED) & bit)) {
+            *errorAt = p;
+            *outCount = count;
+            return TSP_LOAD_ERR_PARSE;
+        }
+
+        coords[index - 1][0] = x;
+        coords[index - 1][1] = y;
+        count++;
+        p = (eol < end) ? eol + 1 : end;
+    }
+    *outCount = count;
+    return TSP_LOAD_OK;
+}
+
+//Finds the first line in [p, end) that closes the section (EOF or a following section).
+static const char* findSectionEnd(const char* p, const char* end) {
+    while (p < end) {
+        const char* eol = findLineEnd(p, end);
+        const char* q = skipBlank(p, eol);
+        if (q < eol && isSectionEnd(q, eol)) return p;
+        p = (eol < end) ? eol + 1 : end;
+    }
+    return end;
+}
+
+//Moves p forward to the first byte of the next line unless it already starts one.
+static const char* alignToLine(const char* begin, const char* p, const char* end) {
+    if (p <= begin) return begin;
+    if (p[-1] == '\n') return p;
+    const char* eol = findLineEnd(p, end);
+    return (eol < end) ? eol + 1 : end;
+}
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    const char* stop;       //section end (phase 1) or first malformed line (phase 2), NULL if none
+    u32 count;
+} TspChunk;
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    Vec2* coords;
+    u64* seen;
+    u32 dimension;
+    TspChunk chunks[THREAD_POOL_MAX_THREADS];
+} TspParseJob;
+
+static void splitChunks(TspParseJob* job, u32 chunkCount) {
+    usize total = (usize)(job->end - job->begin);
+    const char* prev = job->begin;
+    for (u32 c = 0; c < chunkCount; c++) {
+        const char* next = (c + 1 == chunkCount) ? job->end
+                         : alignToLine(job->begin, job->begin + total * (c + 1) / chunkCount, job->end);
+        if (next < prev) next = prev;
+        job->chunks[c] = (TspChunk){ .begin = prev, .end = next, .stop = NULL, .count = 0 };
+        prev = next;
+    }
+}
+
+static void findSectionEndTask(memptr ctx, u32 threadIndex, u32 threadCount) {
+    (void)threadCount;
+    TspChunk* chunk = &((TspParseJob*)ctx)->chunks[threadIndex];
+    const char* stop = findSectionEnd(chunk->begin, chunk->end);
+    chunk->stop = (stop < chunk->end) ? stop : NULL;
+}
+
+static void parseChunkTask(memptr ctx, u32 threadIndex, u32 threadCount) {
+    (void)threadCount;
+    TspParseJob* job = (TspParseJob*)ctx;
+    TspChunk* chunk = &job->chunks[threadIndex];
+    const char* errorAt = NULL;
+    if (parseCoordLines(chunk->begin, chunk->end, job->coords, job->seen, job->dimension, &chunk->count,
+                        &errorAt) != TSP_LOAD_OK) {
+        chunk->stop = errorAt;
+    }
+}
+
+//Two fork-join phases over line-aligned chunks: the first finds where the coordinate block
+//ends, the second parses it. Every line carries its own node index, so chunks write straight
+//into coords without any ordering between workers.
+static TspLoadStatus parseCoordsParallel(const char* begin, const char* end, Vec2* coords, u64* seen, u32 dimension,
+                                         u32 threadCount, u32* outCount, const char** errorAt) {
+    TspParseJob job = { .begin = begin, .end = end, .coords = coords, .seen = seen, .dimension = dimension };
+
+    splitChunks(&job, threadCount);
+    runThreadPool(threadCount, findSectionEndTask, &job);
+    for (u32 c = 0; c < threadCount; c++) {
+        if (job.chunks[c].stop) {
+            job.end = job.chunks[c].stop;
+            break;
+        }
+    }
+
+    splitChunks(&job, threadCount);
+    runThreadPool(threadCount, parseChunkTask, &job);
+
+    u32 count = 0;
+    for (u32 c = 0; c < threadCount; c++) {
+        if (job.chunks[c].stop) {
+            *errorAt = job.chunks[c].stop;
+            *outCount = count;
+            return TSP_LOAD_ERR_PARSE;
+        }
+        count += job.chunks[c].count;
+    }
+    *outCount = count;
+    return TSP_LOAD_OK;
+}
+
+static TspInstance loadTsp(ScratchArena *arena, const char *filename, u32 threadCount) {
+    TspInstance inst = { .coords = NULL, .weights = NULL, .dimension = 0, .count = 0, .errorLine = 0,
+                         .metric = TSP_METRIC_EUC_2D, .weightFormat = TSP_FORMAT_NONE, .status = TSP_LOAD_OK };
+
+    s32 fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("File not found: %s", filename);
+        inst.status = TSP_LOAD_ERR_OPEN;
+        return inst;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOG_ERROR("Unable to stat or empty file: %s", filename);
+        close(fd);
+        inst.status = TSP_LOAD_ERR_OPEN;
+        return inst;
+    }
+    usize fileSize = (usize)st.st_size;
+    memptr mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("FAILED TO MAP FILE %s, size: %zu", filename, fileSize);
+        inst.status = TSP_LOAD_ERR_MAP;
+        return inst;
+    }
+    madvise(mapped, fileSize, MADV_SEQUENTIAL);
+
+    const char* base = (const char*)mapped;
+    const char* end = base + fileSize;
+
+    const char* section = parseHeader(base, end, &inst);
+    if (!section || inst.dimension == 0) {
+        LOG_ERROR("%s: missing DIMENSION header or data section", filename);
+        inst.status = TSP_LOAD_ERR_HEADER;
+        munmap(mapped, fileSize);
+        return inst;
+    }
+
+    const char* errorAt = NULL;
+    if (inst.metric == TSP_METRIC_EXPLICIT) {
+        inst.weights = arenaScratchAlloc(arena, PackedMatrixSize(inst.dimension) * sizeof(f32) + sizeof(f32), ALIGN_64);
+        if (!inst.weights) {
+            LOG_ERROR("%s: arena too small for %u x %u edge weights", filename, inst.dimension, inst.dimension);
+            inst.status = TSP_LOAD_ERR_ALLOC;
+            munmap(mapped, fileSize);
+            return inst;
+        }
+        inst.status = parseWeights(section, end, inst.weightFormat, inst.dimension, inst.weights, &errorAt);
+        if (inst.status != TSP_LOAD_OK) {
+            inst.weights = NULL;
+            inst.errorLine = lineNumberAt(base, errorAt);
+            LOG_ERROR("%s:%u: malformed or missing EDGE_WEIGHT_SECTION entry", filename, inst.errorLine);
+        } else {
+            inst.count = inst.dimension;
+        }
+        munmap(mapped, fileSize);
+        return inst;
+    }
+
+    //every index 1..DIMENSION must appear exactly once; the bitmap stays behind in the arena
+    Vec2* coords = arenaScratchAlloc(arena, sizeof(*coords) * inst.dimension, ALIGN_16);
+    u64* seen = arenaScratchAlloc(arena, sizeof(u64) * ((inst.dimension + 63) / 64), ALIGN_64);
+    if (!coords || !seen) {
+        LOG_ERROR("%s: arena too small for %u coordinates", filename, inst.dimension);
+        inst.status = TSP_LOAD_ERR_ALLOC;
+        munmap(mapped, fileSize);
+        return inst;
+    }
+    memset(seen, 0, sizeof(u64) * ((inst.dimension + 63) / 64));
+
+    if (threadCount > 1) {
+        inst.status = parseCoordsParallel(section, end, coords, seen, inst.dimension, threadCount, &inst.count, &errorAt);
+    } else {
+        inst.status = parseCoordLines(section, end, coords, seen, inst.dimension, &inst.count, &errorAt);
+    }
+    if (inst.status != TSP_LOAD_OK) {
+        inst.errorLine = lineNumberAt(base, errorAt);
+        LOG_ERROR("%s:%u: malformed or repeated coordinate line (expected \"index x y\" with an unseen "
+                  "1 <= index <= %u)", filename, inst.errorLine, inst.dimension);
+        munmap(mapped, fileSize);
+        return inst;
+    }
+    if (inst.count != inst.dimension) {
+        u32 missing = 0;
+        while (seen[missing >> 6] & (1ull << (missing & 63))) missing++;
+        LOG_ERROR("%s: DIMENSION is %u but node %u has no coordinate line", filename, inst.dimension, missing + 1);
+        inst.status = TSP_LOAD_ERR_PARSE;
+        munmap(mapped, fileSize);
+        return inst;
+    }
+
+    munmap(mapped, fileSize);
+    inst.coords = coords;
+    return inst;
+}
+
+TspInstance LoadTspInstance(ScratchArena *arena, const char *filename) {
+    return loadTsp(arena, filename, 1);
+}
+
+TspInstance LoadTspInstanceParallel(ScratchArena *arena, const char *filename, u32 threadCount) {
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+    return loadTsp(arena, filename, threadCount);
+}
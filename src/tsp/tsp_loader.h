@@ -0,0 +1,57 @@
+#ifndef tsp_TSP_LOADER_H
+#define tsp_TSP_LOADER_H
+
+#include "common_types.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+
+typedef enum TspLoadStatus {
+    TSP_LOAD_OK = 0,
+    TSP_LOAD_ERR_OPEN,
+    TSP_LOAD_ERR_MAP,
+    TSP_LOAD_ERR_HEADER,
+    TSP_LOAD_ERR_PARSE,
+    TSP_LOAD_ERR_ALLOC
+} TspLoadStatus;
+
+typedef enum TspMetric {
+    TSP_METRIC_EUC_2D = 0,      //nint(sqrt(dx*dx + dy*dy)), TSPLIB default
+    TSP_METRIC_CEIL_2D,
+    TSP_METRIC_ATT,             //pseudo-Euclidean
+    TSP_METRIC_GEO,
+    TSP_METRIC_EXPLICIT,
+    TSP_METRIC_SQR_EUC_2D,      //squared Euclidean, the CreateDistanceMatrix legacy metric
+    TSP_METRIC_COUNT
+} TspMetric;
+
+typedef enum TspWeightFormat {
+    TSP_FORMAT_NONE = 0,
+    TSP_FORMAT_FULL_MATRIX,
+    TSP_FORMAT_UPPER_ROW,
+    TSP_FORMAT_LOWER_ROW,
+    TSP_FORMAT_UPPER_DIAG_ROW,
+    TSP_FORMAT_LOWER_DIAG_ROW
+} TspWeightFormat;
+
+typedef struct {
+    Vec2* coords;               //NODE_COORD_SECTION, NULL for EXPLICIT instances
+    f32* weights;               //EDGE_WEIGHT_SECTION already in packed DistanceMatrix order, else NULL
+    u32 dimension;              //DIMENSION header, number of slots in coords
+    u32 count;                  //node lines actually parsed (dimension for EXPLICIT)
+    u32 errorLine;              //1-based file line of the first malformed or repeated line, 0 if none
+                                //(also 0 when a node index never appears)
+    TspMetric metric;
+    TspWeightFormat weightFormat;
+    TspLoadStatus status;
+} TspInstance;
+
+//Single pass loader: maps the file read-only, reads the specification header and parses
+//NODE_COORD_SECTION straight into a Vec2 array allocated from the arena. EXPLICIT instances
+//have EDGE_WEIGHT_SECTION written directly into the packed upper-triangular layout used by
+//DistanceMatrix.distances. On failure status/errorLine describe the problem.
+TspInstance LoadTspInstance(ScratchArena *arena, const char *filename);
+//Same result as LoadTspInstance with NODE_COORD_SECTION split into line-aligned chunks parsed
+//by threadCount workers (0 picks the hardware thread count).
+TspInstance LoadTspInstanceParallel(ScratchArena *arena, const char *filename, u32 threadCount);
+
+#endif
@@ -0,0 +1,145 @@
+#include "window_opt.h"
+#include "arena_base.h"
+#include "page_arena.h"
+#include "thread_pool.h"
+
+#define WINDOW_EPS 1e-7
+
+typedef struct {
+    HeldKarpSolver* solvers;        //one per worker
+    DistanceMatrix dm;
+    const u32* cities;
+    u32* order;
+    f32* cost;
+    const u32* length;
+    const u32* misses;
+    u32 window;
+} WindowJob;
+
+static inline usize alignUp64(usize size) {
+    return (size + 63) & ~(usize)63;
+}
+
+static inline u32 maxWindows(u32 count, u32 window) {
+    return count / (window - 1) + 1;
+}
+
+static u32 clampWindow(u32 count, u32 window) {
+    if (window > HK_MAX_CITIES) {
+        LOG_WARN("Window of %u cities clamped to %u", window, HK_MAX_CITIES);
+        window = HK_MAX_CITIES;
+    }
+    return (window > count) ? count : window;
+}
+
+usize WindowOptBlockSize(u32 count, u32 window, u32 threadCount) {
+    window = clampWindow(count, window);
+    if (window < 4) return 0;
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+    usize windows = maxWindows(count, window);
+    return (usize)threadCount * (HeldKarpBlockSize(window) + 64) + alignUp64(sizeof(HeldKarpSolver) * threadCount)
+         + 2 * alignUp64(sizeof(u32) * windows * window) + 3 * alignUp64(sizeof(u32) * windows);
+}
+
+static void solveWindowTask(memptr ctx, u32 item, u32 threadIndex) {
+    WindowJob* job = (WindowJob*)ctx;
+    u32 w = job->misses[item];
+    usize base = (usize)w * job->window;
+    job->cost[w] = HeldKarpSolve(&job->solvers[threadIndex], job->dm, job->cities + base, job->length[w],
+                                 HK_PATH, job->order + base);
+}
+
+static f64 pathLength(DistanceMatrix dm, const u32* path, u32 len) {
+    f64 length = 0.0;
+    for (u32 k = 0; k + 1 < len; k++) {
+        length += dm.distances[DM_INDEX(dm, path[k], path[k + 1])];
+    }
+    return length;
+}
+
+WindowOptStats WindowOptimize(PageArena *arena, u32* tour, u32 count, DistanceMatrix dm, u32 window,
+                              const FragmentMemo* memo, u32 threadCount) {
+    WindowOptStats stats = { .rounds = 0, .windows = 0, .cacheHits = 0, .solved = 0, .improved = 0, .gain = 0.0 };
+    window = clampWindow(count, window);
+    if (!tour || !dm.distances || window < 4) return stats;
+    if (threadCount == 0) threadCount = hardwareThreadCount();
+    if (threadCount > THREAD_POOL_MAX_THREADS) threadCount = THREAD_POOL_MAX_THREADS;
+
+    usize mark = arenaPageMark(arena);
+    u32 windowCap = maxWindows(count, window);
+    HeldKarpSolver* solvers = arenaPageAlloc(arena, sizeof(HeldKarpSolver) * threadCount, ALIGN_64);
+    u32* cities = arenaPageAlloc(arena, sizeof(u32) * windowCap * window, ALIGN_64);
+    u32* order = arenaPageAlloc(arena, sizeof(u32) * windowCap * window, ALIGN_64);
+    f32* cost = arenaPageAlloc(arena, sizeof(f32) * windowCap, ALIGN_64);
+    u32* length = arenaPageAlloc(arena, sizeof(u32) * windowCap, ALIGN_64);
+    u32* misses = arenaPageAlloc(arena, sizeof(u32) * windowCap, ALIGN_64);
+    bool ready = solvers && cities && order && cost && length && misses;
+    for (u32 t = 0; ready && t < threadCount; t++) {
+        solvers[t] = CreateHeldKarpSolver(arena, window);
+        ready = (solvers[t].table != NULL);
+    }
+    if (!ready) {
+        LOG_ERROR("Page arena too small for %u window solvers of %u cities", threadCount, window);
+        arenaPageRewind(arena, mark);
+        return stats;
+    }
+
+    WindowJob job = { .solvers = solvers, .dm = dm, .cities = cities, .order = order, .cost = cost,
+                      .length = length, .misses = misses, .window = window };
+    u32 step = window - 1;
+    u32 quietRounds = 0;
+    for (u32 round = 0; round < WINDOW_OPT_MAX_ROUNDS && quietRounds < 2; round++) {
+        u32 offset = (round & 1) ? step / 2 : 0;
+        u32 windowCount = (count + step - 1) / step;
+        u32 missCount = 0;
+
+        //phase 1: cut the cycle, answer what the memo already knows
+        for (u32 w = 0; w < windowCount; w++) {
+            u32 first = offset + w * step;
+            u32 len = (w + 1 < windowCount) ? window : count - w * step + 1;
+            u32* path = cities + (usize)w * window;
+            for (u32 k = 0; k < len; k++) {
+                path[k] = tour[(first + k) % count];
+            }
+            length[w] = len;
+            if (memo && memo->lookup(memo->ctx, path, len, &cost[w], order + (usize)w * window)) {
+                stats.cacheHits++;
+            } else {
+                misses[missCount++] = w;
+            }
+        }
+
+        //phase 2: windows share only fixed end cities, so misses solve independently
+        runThreadPoolStealing(threadCount, missCount, solveWindowTask, &job);
+
+        //phase 3: remember new solutions, splice in the improvements
+        u32 improved = 0;
+        for (u32 m = 0; memo && m < missCount; m++) {
+            u32 w = misses[m];
+            if (cost[w] >= 0.0f) memo->insert(memo->ctx, cities + (usize)w * window, length[w], cost[w],
+                                              order + (usize)w * window);
+        }
+        for (u32 w = 0; w < windowCount; w++) {
+            if (cost[w] < 0.0f) continue;
+            const u32* path = cities + (usize)w * window;
+            const u32* best = order + (usize)w * window;
+            f64 delta = pathLength(dm, path, length[w]) - pathLength(dm, best, length[w]);
+            if (delta <= WINDOW_EPS) continue;
+            u32 first = offset + w * step;
+            for (u32 k = 1; k + 1 < length[w]; k++) {
+                tour[(first + k) % count] = best[k];
+            }
+            improved++;
+            stats.gain += delta;
+        }
+
+        stats.rounds++;
+        stats.windows += windowCount;
+        stats.solved += missCount;
+        stats.improved += improved;
+        quietRounds = improved ? 0 : quietRounds + 1;
+    }
+    arenaPageRewind(arena, mark);
+    return stats;
+}
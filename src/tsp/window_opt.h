@@ -0,0 +1,34 @@
+#ifndef tsp_WINDOW_OPT_H
+#define tsp_WINDOW_OPT_H
+
+#include "common_types.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "held_karp.h"
+#include "fragment_cache.h"
+
+#define WINDOW_OPT_MAX_ROUNDS 64
+
+typedef struct {
+    u32 rounds;
+    u32 windows;
+    u32 cacheHits;
+    u32 solved;
+    u32 improved;
+    f64 gain;
+} WindowOptStats;
+
+//Bytes WindowOptimize takes from its page arena: one Held-Karp solver per thread plus the
+//window buffers of one round.
+usize WindowOptBlockSize(u32 count, u32 window, u32 threadCount);
+
+//Exact re-optimization of a tour array in place. A round cuts the cycle into windows of
+//window cities that share only their end cities, so each window's interior can be replaced
+//by its optimal fixed-end path independently of the others. A round runs in three phases:
+//serial memo lookups, Held-Karp over the misses on threadCount workers (0 uses every hardware
+//thread), then serial memo inserts and splicing. Rounds alternate between two offsets half a
+//window apart and stop once both come back without an improvement. memo may be NULL.
+WindowOptStats WindowOptimize(PageArena *arena, u32* tour, u32 count, DistanceMatrix dm, u32 window,
+                              const FragmentMemo* memo, u32 threadCount);
+
+#endif
@@ -3,9 +3,28 @@ echo "##########################################################"
 echo "#                 Compiling All Tests....                #"
 echo "##########################################################"
 
-clang -std=c99 -Wall -Werror tests/test_scratch_arena.c build/*.o -o test_lib/scratch_arena_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory
-clang -std=c99 -Wall -Werror tests/test_dist_matrix.c build/*.o -o test_lib/dist_matrix_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory
-clang -std=c99 -Wall -Werror tests/test_page_arena.c build/*.o -o test_lib/page_arena_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory
+clang -std=c99 -pthread -Wall -Werror tests/test_scratch_arena.c build/*.o -o test_lib/scratch_arena_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_dist_matrix.c build/*.o -o test_lib/dist_matrix_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_page_arena.c build/*.o -o test_lib/page_arena_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_tsp_loader.c build/*.o -o test_lib/tsp_loader_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_dist_kernels.c build/*.o -o test_lib/dist_kernels_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_dist_oracle.c build/*.o -o test_lib/dist_oracle_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_kd_tree.c build/*.o -o test_lib/kd_tree_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_matrix_cache.c build/*.o -o test_lib/matrix_cache_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_quant_matrix.c build/*.o -o test_lib/quant_matrix_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_tiled_matrix.c build/*.o -o test_lib/tiled_matrix_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_hilbert.c build/*.o -o test_lib/hilbert_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_construct.c build/*.o -o test_lib/construct_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_tour.c build/*.o -o test_lib/tour_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_local_search.c build/*.o -o test_lib/local_search_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_lin_kernighan.c build/*.o -o test_lib/lin_kernighan_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_held_karp.c build/*.o -o test_lib/held_karp_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_window_opt.c build/*.o -o test_lib/window_opt_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_fragment_cache.c build/*.o -o test_lib/fragment_cache_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_concurrent_cache.c build/*.o -o test_lib/concurrent_cache_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_trie.c build/*.o -o test_lib/trie_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_lut.c build/*.o -o test_lib/lut_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
+clang -std=c99 -pthread -Wall -Werror tests/test_thread_pool.c build/*.o -o test_lib/thread_pool_tests -Iinclude -Isrc -Isrc/tsp -Isrc/memory -Isrc/thread -lm
 
 if [ $? -eq 0 ]; then
     echo "[X] Tests compilation complete...."
@@ -0,0 +1,90 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "test_helpers.h"
+#include "concurrent_cache.h"
+
+#define ARENA_SIZE MiB(16)
+#define MAX_LEN 10
+#define KEY_SPACE 2048
+#define STRESS_THREADS 32
+#define STRESS_OPS 20000
+
+mu_suite_start();
+s32 tests_run = 0;
+
+//Key k: 3 to MAX_LEN cities, value k, optimal order the key reversed. A torn read would pair
+//one key's cities with another's value or order.
+static u32 makeKey(u32 k, u32* key, u32* order) {
+    u32 len = 3 + k % (MAX_LEN - 2);
+    for (u32 i = 0; i < len; i++) key[i] = k * 31 + i;
+    for (u32 i = 0; i < len; i++) order[i] = key[len - 1 - i];
+    return len;
+}
+
+//counters->count tallies hits.
+static void stressTask(memptr ctx, u32 threadIndex, StressCounters* counters) {
+    ConcurrentCache* cache = (ConcurrentCache*)ctx;
+    u32 state = 977 * (threadIndex + 1);
+    u32 key[MAX_LEN], order[MAX_LEN], got[MAX_LEN];
+    for (u32 op = 0; op < STRESS_OPS; op++) {
+        u32 k = rng(&state) % KEY_SPACE;
+        u32 len = makeKey(k, key, order);
+        f32 cost;
+        if (ConcurrentCacheLookup(cache, key, len, &cost, got)) {
+            counters->count++;
+            bool ok = (cost == (f32)k);
+            for (u32 i = 0; i < len; i++) ok &= (got[i] == order[i]);
+            if (!ok) counters->errors++;
+        } else {
+            ConcurrentCacheInsert(cache, key, len, (f32)k, order);
+        }
+    }
+}
+
+char* test_stress_32_threads() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    ConcurrentCache cache = CreateConcurrentCache(&arena, 512, MAX_LEN);
+    mu_assert(cache.slots && cache.capacity == 512, "Cache allocated.");
+    StressCounters total = runStress(STRESS_THREADS, stressTask, &cache);
+    u32 hits = total.count;
+    mu_assert(total.errors == 0, "No lookup returned a torn or foreign entry.");
+    mu_assert(hits > 0 && cache.inserts > 0, "Threads shared entries.");
+    mu_assert(cache.evictions > 0, "Key space larger than the cache forces evictions.");
+    mu_assert(cache.inserts <= (u64)STRESS_THREADS * STRESS_OPS - hits, "Every insert followed a miss.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" 32 threads hammer inserts and lookups without torn reads.");
+    return NULL;
+}
+
+char* test_clock_keeps_hot_entry() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    ConcurrentCache cache = CreateConcurrentCache(&arena, CONCURRENT_PROBE, MAX_LEN);
+    u32 key[MAX_LEN], order[MAX_LEN], hot[MAX_LEN], hotOrder[MAX_LEN];
+    u32 hotLen = makeKey(KEY_SPACE, hot, hotOrder);
+    f32 cost;
+    ConcurrentCacheInsert(&cache, hot, hotLen, 1.0f, hotOrder);
+    for (u32 k = 0; k < 100; k++) {
+        mu_assert(ConcurrentCacheLookup(&cache, hot, hotLen, &cost, NULL) && cost == 1.0f,
+                  "Entry hit between inserts is never the clock victim.");
+        u32 len = makeKey(k, key, order);
+        mu_assert(ConcurrentCacheInsert(&cache, key, len, (f32)k, order), "Insert claims a slot.");
+    }
+    mu_assert(cache.evictions == 100 - (CONCURRENT_PROBE - 1), "Memory stays bounded by eviction.");
+    u32 len = makeKey(99, key, order);
+    mu_assert(ConcurrentCacheLookup(&cache, key, len, &cost, NULL) && cost == 99.0f, "Newest entry is present.");
+    len = makeKey(0, key, order);
+    mu_assert(!ConcurrentCacheLookup(&cache, key, len, &cost, NULL), "Oldest cold entry was evicted.");
+    mu_assert(!ConcurrentCacheInsert(&cache, key, MAX_LEN + 1, 0.0f, NULL), "Overlong keys are refused.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Clock eviction keeps the hot entry in a full window.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_stress_32_threads);
+    mu_run_test(test_clock_keeps_hot_entry);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
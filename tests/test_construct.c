@@ -0,0 +1,82 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "tour.h"
+#include "construct.h"
+
+#define ARENA_SIZE MiB(256)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+char* test_all_methods_valid() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    f64 lengths[CONSTRUCT_METHOD_COUNT];
+    for (u32 m = 0; m < CONSTRUCT_METHOD_COUNT; m++) {
+        u32* tour = ConstructTour(&arena, (ConstructMethod)m, (const Vec2*)inst.coords, inst.count, &oracle, 2);
+        mu_assert(tour != NULL, "Constructor should return a tour.");
+        mu_assert(IsTourPermutation(&arena, tour, inst.count), "Tour visits every city once.");
+        lengths[m] = TourLength(dm, tour, inst.count);
+    }
+    mu_assert(lengths[CONSTRUCT_GREEDY_EDGE] < lengths[CONSTRUCT_NEAREST_NEIGHBOR], "Greedy beats nearest neighbor.");
+    mu_assert(lengths[CONSTRUCT_NEAREST_NEIGHBOR] < lengths[CONSTRUCT_SPACE_FILLING], "Nearest neighbor beats the curve.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Every constructor yields a valid tour.");
+    return NULL;
+}
+
+char* test_nearest_neighbor_steps() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    const Vec2* coords = (const Vec2*)inst.coords;
+    u32 n = 400;
+    u32* tour = NearestNeighborTour(&arena, coords, n, 17);
+    mu_assert(tour[0] == 17, "Tour starts at the requested city.");
+    bool* visited = arenaScratchAlloc(&arena, sizeof(bool) * n, ALIGN_64);
+    for (u32 i = 0; i < n; i++) visited[i] = false;
+    for (u32 k = 0; k + 1 < n; k++) {
+        visited[tour[k]] = true;
+        f64 step = MetricDistance(TSP_METRIC_SQR_EUC_2D, coords[tour[k]], coords[tour[k + 1]]);
+        for (u32 j = 0; j < n; j++) {
+            if (visited[j]) continue;
+            mu_assert(step <= MetricDistance(TSP_METRIC_SQR_EUC_2D, coords[tour[k]], coords[j]),
+                      "Each step goes to the nearest unvisited city.");
+        }
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Nearest neighbor always takes the closest city.");
+    return NULL;
+}
+
+char* test_tiny_instances() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/geo5.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    for (u32 m = 0; m < CONSTRUCT_METHOD_COUNT; m++) {
+        for (u32 n = 1; n <= inst.count; n++) {
+            u32* tour = ConstructTour(&arena, (ConstructMethod)m, (const Vec2*)inst.coords, n, &oracle, 1);
+            mu_assert(tour && IsTourPermutation(&arena, tour, n), "Tiny tours are valid.");
+        }
+    }
+    u32 bad[3] = { 0, 2, 2 };
+    mu_assert(!IsTourPermutation(&arena, bad, 3), "Repeated city is rejected.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Tiny instances construct.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_all_methods_valid);
+    mu_run_test(test_nearest_neighbor_steps);
+    mu_run_test(test_tiny_instances);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,260 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+
+#define ARENA_SIZE MiB(4)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+static const f32 explicitPacked[] = { 3, 4, 2, 7, 4, 6, 3, 5, 8, 6 };
+
+static s32 matrixEquals(DistanceMatrix dm, u32 count, const f32* expected) {
+    u32 k = 0;
+    for (u32 i = 0; i < count; i++) {
+        for (u32 j = i + 1; j < count; j++) {
+            if (dm.distances[DM_INDEX(dm, i, j)] != expected[k]) return 0;
+            if (dm.distances[DM_INDEX(dm, j, i)] != expected[k]) return 0;
+            k++;
+        }
+    }
+    return 1;
+}
+
+static char* checkExplicit(const char* filename, TspWeightFormat format) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, filename);
+    mu_assert(inst.status == TSP_LOAD_OK, "Explicit instance should load.");
+    mu_assert(inst.metric == TSP_METRIC_EXPLICIT, "Metric should be EXPLICIT.");
+    mu_assert(inst.weightFormat == format, "Weight format should come from the header.");
+    mu_assert(inst.coords == NULL && inst.weights != NULL, "Explicit instances carry weights only.");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    mu_assert(dm.distances == inst.weights, "Explicit weights should be adopted without a copy.");
+    mu_assert(matrixEquals(dm, 5, explicitPacked), "Explicit weights should land in packed order.");
+    destroyScratchArena(&arena);
+    return NULL;
+}
+
+char* test_explicit_full_matrix() {
+    char* msg = checkExplicit("test_data/explicit_full.tsp", TSP_FORMAT_FULL_MATRIX);
+    if (msg) return msg;
+    PASS_TEST(" FULL_MATRIX packed in place.");
+    return NULL;
+}
+
+char* test_explicit_upper_row() {
+    char* msg = checkExplicit("test_data/explicit_upper.tsp", TSP_FORMAT_UPPER_ROW);
+    if (msg) return msg;
+    PASS_TEST(" UPPER_ROW packed in place.");
+    return NULL;
+}
+
+char* test_explicit_lower_diag_row() {
+    char* msg = checkExplicit("test_data/explicit_lower_diag.tsp", TSP_FORMAT_LOWER_DIAG_ROW);
+    if (msg) return msg;
+    PASS_TEST(" LOWER_DIAG_ROW packed in place.");
+    return NULL;
+}
+
+char* test_explicit_short_section() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/explicit_short.tsp");
+    mu_assert(inst.status == TSP_LOAD_ERR_PARSE, "Short weight section should fail.");
+    mu_assert(inst.errorLine == 9, "Error should point at the line that ended the section.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Short EDGE_WEIGHT_SECTION reported.");
+    return NULL;
+}
+
+char* test_att_kernel() {
+    static const f32 expected[] = { 1495, 381, 2012, 1157, 990, 1135, 637, 583, 2207, 1633, 778, 1163, 886, 2550, 1686 };
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/att6.tsp");
+    mu_assert(inst.metric == TSP_METRIC_ATT, "Metric should be ATT.");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    mu_assert(matrixEquals(dm, 6, expected), "ATT distances should follow TSPLIB pseudo-Euclidean rounding.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" ATT kernel.");
+    return NULL;
+}
+
+char* test_geo_kernel() {
+    static const f32 expected[] = { 509, 501, 312, 1019, 126, 474, 1526, 541, 1516, 1157 };
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/geo5.tsp");
+    mu_assert(inst.metric == TSP_METRIC_GEO, "Metric should be GEO.");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    mu_assert(matrixEquals(dm, 5, expected), "GEO distances should match ulysses16.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" GEO kernel.");
+    return NULL;
+}
+
+char* test_ceil_kernel() {
+    static const f32 expected[] = { 5, 2, 8, 4, 7, 8 };
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ceil4.tsp");
+    mu_assert(inst.metric == TSP_METRIC_CEIL_2D, "Metric should be CEIL_2D.");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    mu_assert(matrixEquals(dm, 4, expected), "CEIL_2D distances should round up.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" CEIL_2D kernel.");
+    return NULL;
+}
+
+char* test_euc_kernel_matches_pair() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    mu_assert(inst.metric == TSP_METRIC_EUC_2D, "Canada is EUC_2D.");
+    inst.count = 500;
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    mu_assert(dm.distances != NULL, "Matrix should build.");
+    for (u32 i = 0; i < inst.count; i += 7) {
+        for (u32 j = i + 1; j < inst.count; j += 3) {
+            f32 d = MetricDistance(TSP_METRIC_EUC_2D, inst.coords[i], inst.coords[j]);
+            mu_assert(dm.distances[DM_INDEX(dm, i, j)] == d, "Row kernel should match pair distance.");
+            mu_assert(d == (f32)(s32)d, "EUC_2D distances are integers.");
+        }
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" EUC_2D row kernel matches pair kernel.");
+    return NULL;
+}
+
+char* test_legacy_squared_matrix() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/fake.tsp");
+    DistanceMatrix dm = CreateDistanceMatrix(&arena, inst.coords, inst.count);
+    f32 dx = inst.coords[9][0] - inst.coords[0][0];
+    f32 dy = inst.coords[9][1] - inst.coords[0][1];
+    f32 dx2 = dx * dx;
+    f32 dy2 = dy * dy;
+    mu_assert(dm.distances[DM_INDEX(dm, 0, 9)] == dx2 + dy2, "Legacy matrix keeps squared distances.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Legacy squared matrix unchanged.");
+    return NULL;
+}
+
+char* test_simd_matches_scalar() {
+    ScratchArena arena = createScratchArena(MiB(8));
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    u32 count = 1537;
+    CoordsSoA soa = CreateCoordsSoA(&arena, inst.coords, count);
+    f32* expected = arenaScratchAlloc(&arena, sizeof(f32) * count, ALIGN_64);
+    f32* actual = arenaScratchAlloc(&arena, sizeof(f32) * (count + 16), ALIGN_64);
+    TspMetric metrics[] = { TSP_METRIC_SQR_EUC_2D, TSP_METRIC_EUC_2D, TSP_METRIC_CEIL_2D };
+    DistSimdLevel top = DetectSimdLevel();
+
+    for (u32 m = 0; m < ARRAY_COUNT(metrics); m++) {
+        DistRowKernel scalar = SelectRowKernel(metrics[m]);
+        for (u32 level = DIST_SIMD_SCALAR; level <= top; level++) {
+            DistSoaRowKernel kernel = SelectSoaRowKernel(metrics[m], (DistSimdLevel)level);
+            mu_assert(kernel != NULL, "Coordinate metrics should have a SoA kernel.");
+            for (u32 row = 0; row + 1 < count; row += 13) {
+                u32 shift = row % 8;
+                u32 len = count - row - 1;
+                scalar(inst.coords, count, row, expected);
+                kernel(&soa, row, actual + shift);
+                mu_assert(memcmp(expected, actual + shift, sizeof(f32) * len) == 0, "Vector row should match scalar bit for bit.");
+            }
+        }
+    }
+    mu_assert(SelectSoaRowKernel(TSP_METRIC_GEO, top) == NULL, "GEO has no SoA kernel.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" SIMD kernels match scalar bit for bit up to level %d.", top);
+    return NULL;
+}
+
+char* test_simd_large_distances() {
+    ScratchArena arena = createScratchArena(MiB(1));
+    u32 count = 40;
+    Vec2* coords = arenaScratchAlloc(&arena, sizeof(Vec2) * count, ALIGN_64);
+    for (u32 i = 0; i < count; i++) {
+        coords[i][0] = (i % 3 == 0) ? 3.0e9f : (f32)(i * 1000);
+        coords[i][1] = (i % 5 == 0) ? 1.5e9f : (f32)(i * 7);
+    }
+    CoordsSoA soa = CreateCoordsSoA(&arena, coords, count);
+    f32* expected = arenaScratchAlloc(&arena, sizeof(f32) * count, ALIGN_64);
+    f32* actual = arenaScratchAlloc(&arena, sizeof(f32) * count, ALIGN_64);
+    TspMetric metrics[] = { TSP_METRIC_EUC_2D, TSP_METRIC_CEIL_2D };
+    DistSimdLevel top = DetectSimdLevel();
+
+    for (u32 m = 0; m < ARRAY_COUNT(metrics); m++) {
+        DistRowKernel scalar = SelectRowKernel(metrics[m]);
+        for (u32 level = DIST_SIMD_SCALAR; level <= top; level++) {
+            DistSoaRowKernel kernel = SelectSoaRowKernel(metrics[m], (DistSimdLevel)level);
+            for (u32 row = 0; row + 1 < count; row++) {
+                scalar(coords, count, row, expected);
+                kernel(&soa, row, actual);
+                mu_assert(memcmp(expected, actual, sizeof(f32) * (count - row - 1)) == 0, "Vector row past 2^31 should match scalar.");
+            }
+        }
+    }
+    SelectSoaRowKernel(TSP_METRIC_EUC_2D, top)(&soa, 0, actual);
+    mu_assert(actual[0] > 2147483648.0f, "Rounded EUC_2D length past 2^31 should stay positive.");
+    mu_assert(actual[0] == (f32)MetricDistanceInt(TSP_METRIC_EUC_2D, coords[0], coords[1]), "Vector length should equal the integer distance.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" SIMD kernels stay exact for distances past 2^31.");
+    return NULL;
+}
+
+char* test_built_matrix_matches_scalar() {
+    ScratchArena arena = createScratchArena(MiB(64));
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    inst.count = 2001;
+    DistanceMatrix fast = BuildDistanceMatrix(&arena, &inst);
+    DistanceMatrix slow = fast;
+    slow.distances = arenaScratchAlloc(&arena, PackedMatrixSize(inst.count) * sizeof(f32), ALIGN_64);
+    FillDistanceRows(&arena, slow, inst.coords, inst.count, inst.metric, DIST_SIMD_SCALAR);
+    mu_assert(memcmp(fast.distances, slow.distances, PackedMatrixSize(inst.count) * sizeof(f32)) == 0, "Dispatched build should equal scalar build.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Dispatched matrix build matches scalar.");
+    return NULL;
+}
+
+char* test_parallel_build_matches_serial() {
+    ScratchArena arena = createScratchArena(MiB(128));
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    inst.count = 1999;
+    usize bytes = PackedMatrixSize(inst.count) * sizeof(f32);
+    DistanceMatrix serial = BuildDistanceMatrix(&arena, &inst);
+    u32 threadCounts[] = { 2, 3, 8 };
+    TspMetric metrics[] = { TSP_METRIC_EUC_2D, TSP_METRIC_ATT };
+    for (u32 m = 0; m < ARRAY_COUNT(metrics); m++) {
+        inst.metric = metrics[m];
+        serial = BuildDistanceMatrix(&arena, &inst);
+        for (u32 t = 0; t < ARRAY_COUNT(threadCounts); t++) {
+            DistanceMatrix par = BuildDistanceMatrixParallel(&arena, &inst, threadCounts[t]);
+            mu_assert(par.distances != NULL, "Parallel build should succeed.");
+            mu_assert(memcmp(par.distances, serial.distances, bytes) == 0, "Parallel build should equal serial build.");
+        }
+    }
+    DistanceMatrix legacy = CreateDistanceMatrix(&arena, inst.coords, inst.count);
+    DistanceMatrix legacyPar = CreateDistanceMatrixParallel(&arena, inst.coords, inst.count, 4);
+    mu_assert(memcmp(legacy.distances, legacyPar.distances, bytes) == 0, "Parallel legacy build should equal serial.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Parallel load-balanced build matches serial.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_explicit_full_matrix);
+    mu_run_test(test_explicit_upper_row);
+    mu_run_test(test_explicit_lower_diag_row);
+    mu_run_test(test_explicit_short_section);
+    mu_run_test(test_att_kernel);
+    mu_run_test(test_geo_kernel);
+    mu_run_test(test_ceil_kernel);
+    mu_run_test(test_euc_kernel_matches_pair);
+    mu_run_test(test_legacy_squared_matrix);
+    mu_run_test(test_simd_matches_scalar);
+    mu_run_test(test_simd_large_distances);
+    mu_run_test(test_built_matrix_matches_scalar);
+    mu_run_test(test_parallel_build_matches_serial);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,84 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "dist_oracle.h"
+
+#define ARENA_SIZE MiB(32)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+char* test_implicit_matches_dense() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    inst.count = 1200;
+    DistanceOracle dense = CreateDistanceOracle(&arena, &inst, DIST_BACKEND_DENSE, 1);
+    DistanceOracle implicit = CreateDistanceOracle(&arena, &inst, DIST_BACKEND_IMPLICIT, 1);
+    mu_assert(dense.backend == DIST_BACKEND_DENSE && dense.count == 1200, "Dense oracle should build.");
+    mu_assert(implicit.backend == DIST_BACKEND_IMPLICIT && implicit.cache != NULL, "Implicit oracle should carry a cache.");
+    u32 state = 12345;
+    for (u32 k = 0; k < 20000; k++) {
+        state = state * 1664525u + 1013904223u;
+        u32 i = (state >> 8) % inst.count;
+        state = state * 1664525u + 1013904223u;
+        u32 j = (state >> 8) % inst.count;
+        mu_assert(OracleDistance(&dense, i, j) == OracleDistance(&implicit, i, j), "Backends should agree on every pair.");
+        mu_assert(OracleDistance(&implicit, i, j) == OracleDistance(&implicit, j, i), "Implicit distances are symmetric.");
+    }
+    mu_assert(OracleDistance(&implicit, 7, 7) == 0.0f, "Self distance is zero.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Implicit backend matches dense backend.");
+    return NULL;
+}
+
+char* test_cache_hits() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/geo5.tsp");
+    DistanceOracle oracle = CreateImplicitOracle(&arena, &inst, 100);
+    mu_assert(oracle.cacheMask == 127, "Cache slots should round up to a power of two.");
+    f32 first = OracleDistance(&oracle, 0, 1);
+    f32 second = OracleDistance(&oracle, 1, 0);
+    mu_assert(first == 509.0f && second == first, "Cached value should be returned for the mirrored pair.");
+    mu_assert(oracle.cacheMisses == 1 && oracle.cacheHits == 1, "Second lookup should hit the cache.");
+    DistanceOracle fork = ForkDistanceOracle(&arena, &oracle);
+    mu_assert(fork.cache != oracle.cache, "Forked oracle owns its cache.");
+    mu_assert(OracleDistance(&fork, 0, 1) == 509.0f && fork.cacheMisses == 1, "Fork starts cold.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Pair cache hits and forks.");
+    return NULL;
+}
+
+char* test_uncached_implicit() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/att6.tsp");
+    DistanceOracle oracle = CreateImplicitOracle(&arena, &inst, 0);
+    mu_assert(oracle.cache == NULL, "Zero slots disables the cache.");
+    mu_assert(OracleDistance(&oracle, 0, 1) == 1495.0f, "Uncached lookups compute directly.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Uncached implicit lookups.");
+    return NULL;
+}
+
+char* test_explicit_stays_dense() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/explicit_full.tsp");
+    DistanceOracle oracle = CreateDistanceOracle(&arena, &inst, DIST_BACKEND_IMPLICIT, 1);
+    mu_assert(oracle.backend == DIST_BACKEND_DENSE, "Explicit weights have no implicit form.");
+    mu_assert(OracleDistance(&oracle, 4, 2) == 8.0f, "Dense lookup of explicit weight.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Explicit instance falls back to dense.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_implicit_matches_dense);
+    mu_run_test(test_cache_hits);
+    mu_run_test(test_uncached_implicit);
+    mu_run_test(test_explicit_stays_dense);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
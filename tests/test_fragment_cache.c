@@ -0,0 +1,90 @@
+#include "minunit.h"
+#include "test_helpers.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "fragment_cache.h"
+
+#define ARENA_SIZE MiB(64)
+#define KEYS 20000
+#define MAX_LEN 12
+
+mu_suite_start();
+s32 tests_run = 0;
+
+//Key k: length 2 + k % (MAX_LEN - 1), cities derived from k so keys differ only late too.
+static u32 makeKey(u32 k, u32* key) {
+    u32 len = 2 + k % (MAX_LEN - 1);
+    u32 state = k / (MAX_LEN - 1);
+    for (u32 i = 0; i < len; i++) {
+        key[i] = (i + 1 < len) ? i : 70000 + rng(&state) % 100000;
+    }
+    return len;
+}
+
+char* test_u32_roundtrip_and_growth() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    FragmentCache cache = CreateFragmentCache(&arena, 10, FRAGMENT_KEY_U32);
+    mu_assert(cache.capacity == FRAGMENT_MIN_CAPACITY, "Capacity rounds up to the minimum power of two.");
+
+    u32 key[MAX_LEN], order[MAX_LEN], got[MAX_LEN];
+    u32 stored = 0;
+    for (u32 k = 0; k < KEYS; k++) {
+        u32 len = makeKey(k, key);
+        for (u32 i = 0; i < len; i++) order[i] = key[len - 1 - i];
+        f32 cost;
+        if (FragmentCacheLookup(&cache, key, len, &cost, NULL)) continue;     //generator repeats a few keys
+        mu_assert(FragmentCacheInsert(&cache, key, len, (f32)k, order), "Insert succeeds.");
+        stored++;
+    }
+    mu_assert(cache.size == stored && cache.grows > 0, "Table grew to hold every key.");
+    mu_assert((cache.capacity & (cache.capacity - 1)) == 0, "Capacity stays a power of two.");
+    mu_assert((u64)cache.size * FRAGMENT_LOAD_DEN <= (u64)cache.capacity * FRAGMENT_LOAD_NUM, "Load stays bounded.");
+
+    u64 lookups = cache.lookups, hits = cache.hits;
+    for (u32 k = 0; k < KEYS; k++) {
+        u32 len = makeKey(k, key);
+        f32 cost = -1.0f;
+        mu_assert(FragmentCacheLookup(&cache, key, len, &cost, got), "Every key survives growth.");
+        mu_assert(got[0] == key[len - 1] && got[len - 1] == key[0], "Stored order comes back.");
+        mu_assert(cost >= 0.0f && (u32)cost <= k, "First value for a key is kept.");
+    }
+    key[0] = 999999;
+    f32 cost;
+    mu_assert(!FragmentCacheLookup(&cache, key, 5, &cost, NULL), "Unknown key misses.");
+    mu_assert(cache.lookups - lookups == KEYS + 1 && cache.hits - hits == KEYS, "Counters track lookups and hits.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" u32 keys survive growth with their orders.");
+    return NULL;
+}
+
+char* test_u16_keys_and_memo() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    FragmentCache cache = CreateFragmentCache(&arena, 64, FRAGMENT_KEY_U16);
+    u16 shortKey[3] = { 4, 5, 6 }, longKey[4] = { 4, 5, 6, 7 };
+    FragmentCacheInsert(&cache, shortKey, 3, 1.5f, NULL);
+    FragmentCacheInsert(&cache, longKey, 4, 2.5f, NULL);
+    f32 cost = 0.0f;
+    mu_assert(FragmentCacheLookup(&cache, shortKey, 3, &cost, NULL) && cost == 1.5f, "Prefix key is distinct.");
+    mu_assert(FragmentCacheLookup(&cache, longKey, 4, &cost, NULL) && cost == 2.5f, "Longer key is distinct.");
+
+    FragmentMemo memo = FragmentCacheMemo(&cache);
+    u32 path[4] = { 10, 20, 30, 40 }, order[4] = { 10, 30, 20, 40 }, got[4];
+    memo.insert(memo.ctx, path, 4, 7.0f, order);
+    mu_assert(memo.lookup(memo.ctx, path, 4, &cost, got) && cost == 7.0f && got[1] == 30,
+              "Memo adapter narrows u32 windows into a u16 cache.");
+    u32 wide[3] = { 1, 70000, 2 };
+    memo.insert(memo.ctx, wide, 3, 1.0f, wide);
+    mu_assert(!memo.lookup(memo.ctx, wide, 3, &cost, got) && cache.size == 3, "Cities above u16 are declined.");
+    mu_assert(FragmentCacheHitRate(&cache) > 0.5, "Hit rate reflects the lookups.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" u16 keys and the window memo adapter.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_u32_roundtrip_and_growth);
+    mu_run_test(test_u16_keys_and_memo);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,118 @@
+#include "minunit.h"
+#include "test_helpers.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "construct.h"
+#include "held_karp.h"
+
+#define ARENA_SIZE MiB(64)
+#define N 9
+
+mu_suite_start();
+s32 tests_run = 0;
+
+static f32 orderLength(const f32* dist, u32 count, const u32* order, HeldKarpShape shape) {
+    f32 length = 0.0f;
+    for (u32 k = 0; k + 1 < count; k++) {
+        length += dist[order[k] * count + order[k + 1]];
+    }
+    if (shape == HK_CYCLE) length += dist[order[count - 1] * count + order[0]];
+    return length;
+}
+
+//Reference: every permutation of the cities between the fixed ends.
+static void bruteForce(const f32* dist, u32 count, HeldKarpShape shape, u32* perm, u32 k, u32 last, f32* best) {
+    if (k == last) {
+        f32 length = orderLength(dist, count, perm, shape);
+        if (length < *best) *best = length;
+        return;
+    }
+    for (u32 s = k; s < last; s++) {
+        u32 t = perm[k]; perm[k] = perm[s]; perm[s] = t;
+        bruteForce(dist, count, shape, perm, k + 1, last, best);
+        t = perm[k]; perm[k] = perm[s]; perm[s] = t;
+    }
+}
+
+static bool validOrder(const u32* order, u32 count, HeldKarpShape shape) {
+    u32 seen[HK_MAX_CITIES] = { 0 };
+    for (u32 k = 0; k < count; k++) {
+        if (order[k] >= count || seen[order[k]]++) return false;
+    }
+    return order[0] == 0 && (shape == HK_CYCLE || order[count - 1] == count - 1);
+}
+
+char* test_matches_brute_force() {
+    memMap* map = initMemMap(MiB(4));
+    PageArena* arena = createPageArena(map, MiB(2));
+    HeldKarpSolver hk = CreateHeldKarpSolver(arena, N);
+    mu_assert(hk.table && arena->offset >= HeldKarpBlockSize(N), "Solver lives in one page block.");
+
+    u32 state = 7;
+    f32 dist[N * N];
+    u32 order[N], perm[N];
+    for (u32 trial = 0; trial < 12; trial++) {
+        u32 count = 2 + trial % (N - 1);
+        for (u32 i = 0; i < count * count; i++) {
+            dist[i] = (f32)(rng(&state) % 1000);    //asymmetric on purpose
+        }
+        for (u32 shape = HK_PATH; shape <= HK_CYCLE; shape++) {
+            f32 best = HK_INF;
+            for (u32 k = 0; k < count; k++) perm[k] = k;
+            bruteForce(dist, count, (HeldKarpShape)shape, perm, 1, (shape == HK_PATH) ? count - 1 : count, &best);
+            for (s32 level = DIST_SIMD_SCALAR; level <= (s32)hk.level; level++) {
+                hk.level = (DistSimdLevel)level;
+                f32 length = HeldKarpSolveDense(&hk, dist, count, (HeldKarpShape)shape, order);
+                mu_assert(length == best, "Held-Karp finds the brute force optimum.");
+                mu_assert(validOrder(order, count, (HeldKarpShape)shape), "Order keeps the fixed ends.");
+                mu_assert(orderLength(dist, count, order, (HeldKarpShape)shape) == best, "Order has the optimal length.");
+            }
+            hk.level = DetectSimdLevel();
+        }
+    }
+    releasePages(map);
+    PASS_TEST(" Held-Karp matches brute force on every SIMD level.");
+    return NULL;
+}
+
+char* test_window_of_tour() {
+    ScratchArena scratch = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&scratch, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&scratch, &inst);
+    u32* start = NearestNeighborTour(&scratch, (const Vec2*)inst.coords, inst.count, 0);
+    memMap* map = initMemMap(MiB(64));
+    PageArena* arena = createPageArena(map, HeldKarpBlockSize(16) + KiB(4));
+    HeldKarpSolver hk = CreateHeldKarpSolver(arena, 16);
+
+    u32 order[16];
+    f32 before = 0.0f;
+    for (u32 k = 0; k + 1 < 16; k++) {
+        before += dm.distances[DM_INDEX(dm, start[100 + k], start[101 + k])];
+    }
+    f32 after = HeldKarpSolve(&hk, dm, start + 100, 16, HK_PATH, order);
+    mu_assert(after > 0.0f && after <= before, "Exact window is no longer than the nearest neighbor path.");
+    mu_assert(order[0] == start[100] && order[15] == start[115], "Window ends stay in place.");
+    f32 check = 0.0f;
+    for (u32 k = 0; k + 1 < 16; k++) {
+        check += dm.distances[DM_INDEX(dm, order[k], order[k + 1])];
+    }
+    mu_assert(check > after - 0.5f && check < after + 0.5f, "Returned order has the returned length.");
+    mu_assert(HeldKarpSolve(&hk, dm, start, 17, HK_PATH, order) < 0.0f, "Oversized window is refused.");
+
+    releasePages(map);
+    destroyScratchArena(&scratch);
+    PASS_TEST(" Held-Karp re-optimizes a tour window.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_matches_brute_force);
+    mu_run_test(test_window_of_tour);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
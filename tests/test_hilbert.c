@@ -0,0 +1,126 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "hilbert.h"
+
+#define ARENA_SIZE MiB(256)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+char* test_hilbert_key() {
+    mu_assert(HilbertKey(0, 0, 1) == 0 && HilbertKey(0, 1, 1) == 1, "Order 1 curve starts up the left side.");
+    mu_assert(HilbertKey(1, 1, 1) == 2 && HilbertKey(1, 0, 1) == 3, "Order 1 curve ends bottom right.");
+    //consecutive keys on an order 4 grid are always adjacent cells
+    u32 cell[256][2];
+    for (u32 x = 0; x < 16; x++) {
+        for (u32 y = 0; y < 16; y++) {
+            u32 d = HilbertKey(x, y, 4);
+            mu_assert(d < 256, "Key stays on the grid.");
+            cell[d][0] = x;
+            cell[d][1] = y;
+        }
+    }
+    for (u32 d = 1; d < 256; d++) {
+        u32 dx = (cell[d][0] > cell[d - 1][0]) ? cell[d][0] - cell[d - 1][0] : cell[d - 1][0] - cell[d][0];
+        u32 dy = (cell[d][1] > cell[d - 1][1]) ? cell[d][1] - cell[d - 1][1] : cell[d - 1][1] - cell[d][1];
+        mu_assert(dx + dy == 1, "Curve moves one cell per step.");
+    }
+    PASS_TEST(" Hilbert keys trace a continuous curve.");
+    return NULL;
+}
+
+static f64 successorLength(const Vec2* coords, u32 count) {
+    f64 total = 0.0;
+    for (u32 i = 0; i + 1 < count; i++) {
+        total += MetricDistance(TSP_METRIC_EUC_2D, coords[i], coords[i + 1]);
+    }
+    return total;
+}
+
+char* test_renumbered_instance() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    CityPermutation perm;
+    TspInstance hil = LoadTspInstanceHilbert(&arena, "test_data/ca4663.tsp", 2, &perm);
+    mu_assert(hil.status == TSP_LOAD_OK && perm.count == inst.count, "Hilbert load should succeed.");
+    for (u32 n = 0; n < perm.count; n++) {
+        mu_assert(perm.toNew[perm.toOld[n]] == n, "toNew inverts toOld.");
+        mu_assert(hil.coords[n][0] == inst.coords[perm.toOld[n]][0] &&
+                  hil.coords[n][1] == inst.coords[perm.toOld[n]][1], "Coordinates follow the permutation.");
+    }
+    mu_assert(successorLength((const Vec2*)hil.coords, hil.count) * 4 < successorLength((const Vec2*)inst.coords, inst.count),
+              "Consecutive ids are far closer after renumbering.");
+
+    DistanceMatrix original = BuildDistanceMatrix(&arena, &inst);
+    DistanceMatrix renumbered = BuildDistanceMatrix(&arena, &hil);
+    for (u32 i = 0; i < inst.count; i += 13) {
+        for (u32 j = i + 1; j < inst.count; j += 17) {
+            u32 ni = perm.toNew[i], nj = perm.toNew[j];
+            mu_assert(original.distances[DM_INDEX(original, i, j)] == renumbered.distances[DM_INDEX(renumbered, ni, nj)],
+                      "Rebuilt matrix holds the same distances under new ids.");
+        }
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Renumbered instance and matrix.");
+    return NULL;
+}
+
+char* test_tour_translation() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    CityPermutation perm;
+    TspInstance hil = LoadTspInstanceHilbert(&arena, "test_data/ca4663.tsp", 1, &perm);
+    u32* tour = arenaScratchAlloc(&arena, sizeof(u32) * hil.count, ALIGN_64);
+    u32* original = arenaScratchAlloc(&arena, sizeof(u32) * hil.count, ALIGN_64);
+    for (u32 k = 0; k < hil.count; k++) tour[k] = k;
+    TourToOriginal(&perm, tour, original, hil.count);
+    for (u32 k = 0; k < hil.count; k++) {
+        mu_assert(original[k] == perm.toOld[k], "Tour maps back to file ids.");
+    }
+    TourToRenumbered(&perm, original, original, hil.count);
+    for (u32 k = 0; k < hil.count; k++) {
+        mu_assert(original[k] == k, "Round trip in place restores the tour.");
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Tours translate between numberings.");
+    return NULL;
+}
+
+char* test_explicit_renumbering() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/explicit_full.tsp");
+    CityPermutation perm = IdentityPermutation(&arena, inst.count);
+    for (u32 n = 0; n < inst.count; n++) {
+        perm.toOld[n] = inst.count - 1 - n;
+        perm.toNew[inst.count - 1 - n] = n;
+    }
+    TspInstance reversed = RenumberInstance(&arena, &inst, &perm);
+    DistanceMatrix a = BuildDistanceMatrix(&arena, &inst);
+    DistanceMatrix b = BuildDistanceMatrix(&arena, &reversed);
+    for (u32 i = 0; i < inst.count; i++) {
+        for (u32 j = i + 1; j < inst.count; j++) {
+            mu_assert(a.distances[DM_INDEX(a, i, j)] == b.distances[DM_INDEX(b, perm.toNew[i], perm.toNew[j])],
+                      "Explicit weights are rewritten in the new order.");
+        }
+    }
+
+    CityPermutation identity;
+    TspInstance loaded = LoadTspInstanceHilbert(&arena, "test_data/explicit_full.tsp", 1, &identity);
+    mu_assert(loaded.status == TSP_LOAD_OK && identity.toOld[3] == 3, "Explicit instances keep file order.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Explicit weights renumber.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_hilbert_key);
+    mu_run_test(test_renumbered_instance);
+    mu_run_test(test_tour_translation);
+    mu_run_test(test_explicit_renumbering);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
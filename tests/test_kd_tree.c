@@ -0,0 +1,185 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "kd_tree.h"
+
+#define ARENA_SIZE MiB(32)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+//Brute-force reference with the same ordering rule as the tree: squared distance, then id.
+static void bruteNearest(const Vec2* coords, u32 count, u32 city, u32 k, u32* outIds) {
+    f32 best[CANDIDATE_MAX_K];
+    u32 found = 0;
+    for (u32 j = 0; j < count; j++) {
+        if (j == city) continue;
+        f32 dx = coords[j][0] - coords[city][0];
+        f32 dy = coords[j][1] - coords[city][1];
+        f32 dx2 = dx * dx;
+        f32 dy2 = dy * dy;
+        f32 d = dx2 + dy2;
+        if (found == k && (d > best[k - 1] || (d == best[k - 1] && j > outIds[k - 1]))) continue;
+        if (found < k) found++;
+        u32 slot = found - 1;
+        while (slot > 0 && (d < best[slot - 1] || (d == best[slot - 1] && j < outIds[slot - 1]))) {
+            best[slot] = best[slot - 1];
+            outIds[slot] = outIds[slot - 1];
+            slot--;
+        }
+        best[slot] = d;
+        outIds[slot] = j;
+    }
+}
+
+char* test_tree_partitions_all_cities() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    KdTree tree = BuildKdTree(&arena, (const Vec2*)inst.coords, inst.count);
+    mu_assert(tree.nodes != NULL && tree.count == inst.count, "Tree should build over every city.");
+
+    u32* seen = arenaScratchAlloc(&arena, sizeof(u32) * inst.count, ALIGN_64);
+    for (u32 i = 0; i < inst.count; i++) seen[i] = 0;
+    for (u32 i = 0; i < inst.count; i++) {
+        seen[tree.index[i]]++;
+        mu_assert(tree.points[i][0] == inst.coords[tree.index[i]][0], "Points follow tree order.");
+    }
+    for (u32 i = 0; i < inst.count; i++) {
+        mu_assert(seen[i] == 1, "Tree index is a permutation.");
+    }
+    for (u32 n = 0; n < tree.nodeCount; n++) {
+        KdNode* node = &tree.nodes[n];
+        if (node->left == KD_NO_CHILD) {
+            mu_assert(node->end - node->begin <= KD_LEAF_SIZE, "Leaves hold at most KD_LEAF_SIZE cities.");
+            continue;
+        }
+        for (u32 i = node->begin; i < tree.nodes[node->left].end; i++) {
+            mu_assert(tree.points[i][node->axis] <= node->split, "Left side lies below the split.");
+        }
+        for (u32 i = tree.nodes[node->right].begin; i < node->end; i++) {
+            mu_assert(tree.points[i][node->axis] >= node->split, "Right side lies above the split.");
+        }
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" K-d tree partitions every city.");
+    return NULL;
+}
+
+char* test_candidates_match_brute_force() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    u32 k = 10;
+    CandidateLists lists = BuildCandidateLists(&arena, (const Vec2*)inst.coords, inst.count, k, 1);
+    mu_assert(lists.neighbors != NULL && lists.k == k && lists.count == inst.count, "Lists should build.");
+    mu_assert(lists.stride == 16, "Stride rounds up to a cache line of u32.");
+    mu_assert(((usize)lists.neighbors & 63) == 0, "Lists are cache line aligned.");
+
+    u32 expected[CANDIDATE_MAX_K];
+    for (u32 city = 0; city < inst.count; city += 7) {
+        bruteNearest((const Vec2*)inst.coords, inst.count, city, k, expected);
+        const u32* got = CandidatesOf(&lists, city);
+        for (u32 s = 0; s < k; s++) {
+            mu_assert(got[s] == expected[s], "Candidate list should match brute force.");
+        }
+        mu_assert(got[k] == KD_NO_CHILD, "Padding slots are marked empty.");
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Candidate lists match brute force.");
+    return NULL;
+}
+
+char* test_parallel_matches_serial() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    CandidateLists serial = BuildCandidateLists(&arena, (const Vec2*)inst.coords, inst.count, 20, 1);
+    CandidateLists parallel = BuildCandidateLists(&arena, (const Vec2*)inst.coords, inst.count, 20, 4);
+    mu_assert(serial.stride == 32 && parallel.stride == 32, "k of 20 uses two cache lines.");
+    for (usize i = 0; i < (usize)inst.count * serial.stride; i++) {
+        mu_assert(serial.neighbors[i] == parallel.neighbors[i], "Parallel lists equal serial lists.");
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Parallel candidate build matches serial.");
+    return NULL;
+}
+
+char* test_small_instance_clamps_k() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/geo5.tsp");
+    CandidateLists lists = BuildCandidateLists(&arena, (const Vec2*)inst.coords, inst.count, 10, 2);
+    mu_assert(lists.k == inst.count - 1, "k clamps to the other cities.");
+    for (u32 city = 0; city < inst.count; city++) {
+        const u32* got = CandidatesOf(&lists, city);
+        for (u32 s = 0; s < lists.k; s++) {
+            mu_assert(got[s] != city && got[s] < inst.count, "A city is never its own candidate.");
+        }
+    }
+
+    KdTree tree = BuildKdTree(&arena, (const Vec2*)inst.coords, inst.count);
+    f32 query[2] = { inst.coords[2][0], inst.coords[2][1] };
+    u32 ids[4];
+    f32 dist2[4];
+    mu_assert(KdNearest(&tree, query, 4, KD_NO_CHILD, ids, dist2) == 4, "Query returns k hits.");
+    mu_assert(ids[0] == 2 && dist2[0] == 0.0f, "Query point itself comes first when not excluded.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Small instance clamps k.");
+    return NULL;
+}
+
+char* test_removal() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    const Vec2* coords = (const Vec2*)inst.coords;
+    KdTree tree = BuildKdTree(&arena, coords, inst.count);
+    bool* removed = arenaScratchAlloc(&arena, sizeof(bool) * inst.count, ALIGN_64);
+    for (u32 i = 0; i < inst.count; i++) removed[i] = false;
+
+    //remove two thirds of the cities, some twice, and check nearest queries against a scan
+    for (u32 i = 0; i < inst.count; i++) {
+        if (i % 3 != 0) {
+            KdRemove(&tree, i);
+            removed[i] = true;
+        }
+        if (i % 7 == 1) {
+            KdRemove(&tree, i);
+            removed[i] = true;
+        }
+    }
+    u32 live = 0;
+    for (u32 i = 0; i < inst.count; i++) live += !removed[i];
+    mu_assert(tree.liveCount == live && tree.live[0] == live, "Live counts track removals.");
+
+    for (u32 q = 0; q < inst.count; q += 11) {
+        u32 got;
+        f32 gotD;
+        mu_assert(KdNearest(&tree, coords[q], 1, KD_NO_CHILD, &got, &gotD) == 1, "Live cities remain.");
+        mu_assert(!removed[got], "Removed cities are never returned.");
+        for (u32 j = 0; j < inst.count; j++) {
+            if (removed[j]) continue;
+            f32 dx = coords[j][0] - coords[q][0];
+            f32 dy = coords[j][1] - coords[q][1];
+            f32 dx2 = dx * dx;
+            f32 dy2 = dy * dy;
+            mu_assert(gotD <= dx2 + dy2, "Nearest live city is returned.");
+        }
+    }
+    for (u32 i = 0; i < inst.count; i++) KdRemove(&tree, i);
+    u32 none;
+    mu_assert(tree.liveCount == 0 && KdNearest(&tree, coords[0], 1, KD_NO_CHILD, &none, NULL) == 0,
+              "Empty tree answers nothing.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Removal keeps queries exact.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_tree_partitions_all_cities);
+    mu_run_test(test_candidates_match_brute_force);
+    mu_run_test(test_parallel_matches_serial);
+    mu_run_test(test_small_instance_clamps_k);
+    mu_run_test(test_removal);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
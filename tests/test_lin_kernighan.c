@@ -0,0 +1,90 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "tour.h"
+#include "construct.h"
+#include "local_search.h"
+#include "lin_kernighan.h"
+
+#define ARENA_SIZE MiB(256)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+typedef struct {
+    ScratchArena arena;
+    TspInstance inst;
+    DistanceMatrix dm;
+    DistanceOracle oracle;
+    CandidateLists lists;
+    u32* start;
+} Fixture;
+
+static Fixture loadFixture(const char* filename) {
+    Fixture f;
+    f.arena = createScratchArena(ARENA_SIZE);
+    f.inst = LoadTspInstance(&f.arena, filename);
+    f.dm = BuildDistanceMatrix(&f.arena, &f.inst);
+    f.oracle = CreateDenseOracle(f.dm, f.inst.count, f.inst.metric);
+    f.lists = BuildCandidateLists(&f.arena, (const Vec2*)f.inst.coords, f.inst.count, 8, 1);
+    f.start = GreedyEdgeTour(&f.arena, (const Vec2*)f.inst.coords, f.inst.count, &f.oracle, 1);
+    return f;
+}
+
+static f64 lengthOf(Fixture* f, const Tour* tour, bool* valid) {
+    u32* result = arenaScratchAlloc(&f->arena, sizeof(u32) * tour->count, ALIGN_64);
+    TourToArray(tour, result);
+    *valid = IsTourPermutation(&f->arena, result, tour->count);
+    return TourLength(f->dm, result, tour->count);
+}
+
+char* test_lk_beats_or2opt() {
+    Fixture f = loadFixture("test_data/ca4663.tsp");
+    f64 before = TourLength(f.dm, f.start, f.inst.count);
+    Tour lk = CreateTour(&f.arena, TOUR_ARRAY, f.start, f.inst.count);
+    Tour or2 = CreateTour(&f.arena, TOUR_ARRAY, f.start, f.inst.count);
+    LocalSearchStats stats = LinKernighan(&f.arena, &lk, &f.oracle, &f.lists);
+    Or2Opt(&f.arena, &or2, &f.oracle, &f.lists);
+
+    bool valid = false;
+    f64 after = lengthOf(&f, &lk, &valid);
+    mu_assert(valid, "LK keeps a valid tour.");
+    mu_assert(before - after > stats.gain - 1.0 && before - after < stats.gain + 1.0, "Reported gain matches.");
+    f64 or2Length = lengthOf(&f, &or2, &valid);
+    mu_assert(after < or2Length, "LK goes deeper than 2-opt plus Or-opt.");
+    destroyScratchArena(&f.arena);
+    PASS_TEST(" Lin-Kernighan beats Or-2opt.");
+    return NULL;
+}
+
+char* test_iterated_lk_rolls_back() {
+    Fixture f = loadFixture("test_data/ca4663.tsp");
+    Tour lk = CreateTour(&f.arena, TOUR_ARRAY, f.start, f.inst.count);
+    Tour ilk = CreateTour(&f.arena, TOUR_ARRAY, f.start, f.inst.count);
+    LinKernighan(&f.arena, &lk, &f.oracle, &f.lists);
+    LocalSearchStats stats = IteratedLinKernighan(&f.arena, &ilk, &f.oracle, &f.lists, 500, 7);
+
+    bool valid = false;
+    f64 before = TourLength(f.dm, f.start, f.inst.count);
+    f64 lkLength = lengthOf(&f, &lk, &valid);
+    f64 after = lengthOf(&f, &ilk, &valid);
+    mu_assert(valid, "Iterated LK keeps a valid tour.");
+    //rejected kicks must be rolled back exactly or the tally drifts from the real length
+    mu_assert(before - after > stats.gain - 1.0 && before - after < stats.gain + 1.0, "Reported gain matches.");
+    mu_assert(after < lkLength, "Kicks improve on plain LK.");
+    destroyScratchArena(&f.arena);
+    PASS_TEST(" Iterated LK keeps only improving kicks.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_lk_beats_or2opt);
+    mu_run_test(test_iterated_lk_rolls_back);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
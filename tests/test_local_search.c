@@ -0,0 +1,143 @@
+#include <string.h>
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "kd_tree.h"
+#include "tour.h"
+#include "construct.h"
+#include "local_search.h"
+
+#define ARENA_SIZE MiB(256)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+typedef struct {
+    ScratchArena arena;
+    TspInstance inst;
+    DistanceMatrix dm;
+    DistanceOracle oracle;
+    CandidateLists lists;
+} Fixture;
+
+static Fixture loadFixture(const char* filename, u32 k) {
+    Fixture f;
+    f.arena = createScratchArena(ARENA_SIZE);
+    f.inst = LoadTspInstance(&f.arena, filename);
+    f.dm = BuildDistanceMatrix(&f.arena, &f.inst);
+    f.oracle = CreateDenseOracle(f.dm, f.inst.count, f.inst.metric);
+    f.lists = BuildCandidateLists(&f.arena, (const Vec2*)f.inst.coords, f.inst.count, k, 1);
+    return f;
+}
+
+char* test_two_opt_improves() {
+    Fixture f = loadFixture("test_data/ca4663.tsp", 8);
+    u32* start = SpaceFillingCurveTour(&f.arena, (const Vec2*)f.inst.coords, f.inst.count);
+    f64 before = TourLength(f.dm, start, f.inst.count);
+    Tour tour = CreateTour(&f.arena, TOUR_ARRAY, start, f.inst.count);
+    LocalSearchStats stats = TwoOpt(&f.arena, &tour, &f.oracle, &f.lists);
+
+    u32* result = arenaScratchAlloc(&f.arena, sizeof(u32) * f.inst.count, ALIGN_64);
+    TourToArray(&tour, result);
+    f64 after = TourLength(f.dm, result, f.inst.count);
+    mu_assert(IsTourPermutation(&f.arena, result, f.inst.count), "2-opt keeps a valid tour.");
+    mu_assert(stats.moves > 0 && after < before * 0.9, "2-opt removes a good share of the curve tour.");
+    mu_assert(before - after > stats.gain - 1.0 && before - after < stats.gain + 1.0, "Reported gain matches.");
+
+    LocalSearchStats again = TwoOpt(&f.arena, &tour, &f.oracle, &f.lists);
+    //don't-look bits only requeue move endpoints, so a full rescan may still find a stray move
+    mu_assert(again.scans >= f.inst.count && again.moves * 20 < stats.moves, "Result is close to a local optimum.");
+    destroyScratchArena(&f.arena);
+    PASS_TEST(" 2-opt converges on candidate lists.");
+    return NULL;
+}
+
+char* test_two_opt_tiny() {
+    Fixture f = loadFixture("test_data/geo5.tsp", 4);
+    u32 order[5] = { 0, 2, 4, 1, 3 };
+    Tour tour = CreateTour(&f.arena, TOUR_ARRAY, order, 5);
+    TwoOpt(&f.arena, &tour, &f.oracle, &f.lists);
+    u32 result[5];
+    TourToArray(&tour, result);
+    mu_assert(IsTourPermutation(&f.arena, result, 5), "Tiny tour stays valid.");
+    mu_assert(TourLength(f.dm, result, 5) <= TourLength(f.dm, order, 5), "Tiny tour never gets longer.");
+    destroyScratchArena(&f.arena);
+    PASS_TEST(" 2-opt on a tiny instance.");
+    return NULL;
+}
+
+//Or-opt alone exercises segment moves in both frames; the tour must stay valid and the
+//reported gain must match the actual change.
+char* test_or_opt_gain_matches() {
+    Fixture f = loadFixture("test_data/ca4663.tsp", 8);
+    u32* start = SpaceFillingCurveTour(&f.arena, (const Vec2*)f.inst.coords, f.inst.count);
+    f64 before = TourLength(f.dm, start, f.inst.count);
+    Tour tour = CreateTour(&f.arena, TOUR_ARRAY, start, f.inst.count);
+    LocalSearchStats stats = LocalSearch(&f.arena, &tour, &f.oracle, &f.lists, LS_MOVE_OR_OPT);
+
+    u32* result = arenaScratchAlloc(&f.arena, sizeof(u32) * f.inst.count, ALIGN_64);
+    TourToArray(&tour, result);
+    f64 after = TourLength(f.dm, result, f.inst.count);
+    mu_assert(IsTourPermutation(&f.arena, result, f.inst.count), "Or-opt keeps a valid tour.");
+    mu_assert(stats.moves > 0 && after < before, "Or-opt improves the curve tour.");
+    mu_assert(before - after > stats.gain - 1.0 && before - after < stats.gain + 1.0, "Reported gain matches.");
+    destroyScratchArena(&f.arena);
+    PASS_TEST(" Or-opt segment moves are exact.");
+    return NULL;
+}
+
+char* test_or2opt_beats_two_opt() {
+    Fixture f = loadFixture("test_data/ca4663.tsp", 10);
+    u32* start = GreedyEdgeTour(&f.arena, (const Vec2*)f.inst.coords, f.inst.count, &f.oracle, 1);
+    Tour two = CreateTour(&f.arena, TOUR_ARRAY, start, f.inst.count);
+    Tour both = CreateTour(&f.arena, TOUR_ARRAY, start, f.inst.count);
+    TwoOpt(&f.arena, &two, &f.oracle, &f.lists);
+    Or2Opt(&f.arena, &both, &f.oracle, &f.lists);
+
+    u32* result = arenaScratchAlloc(&f.arena, sizeof(u32) * f.inst.count, ALIGN_64);
+    TourToArray(&two, result);
+    f64 twoLength = TourLength(f.dm, result, f.inst.count);
+    TourToArray(&both, result);
+    f64 bothLength = TourLength(f.dm, result, f.inst.count);
+    mu_assert(IsTourPermutation(&f.arena, result, f.inst.count), "Or-2opt keeps a valid tour.");
+    mu_assert(bothLength < twoLength, "Adding Or-opt moves shortens the 2-opt result.");
+    destroyScratchArena(&f.arena);
+    PASS_TEST(" Or-2opt beats 2-opt from the same start.");
+    return NULL;
+}
+
+char* test_implicit_oracle_matches_dense() {
+    Fixture f = loadFixture("test_data/ca4663.tsp", 10);
+    DistanceOracle implicit = CreateImplicitOracle(&f.arena, &f.inst, ORACLE_DEFAULT_CACHE_SLOTS);
+    u32* start = GreedyEdgeTour(&f.arena, (const Vec2*)f.inst.coords, f.inst.count, &f.oracle, 1);
+    u32* implicitStart = GreedyEdgeTour(&f.arena, (const Vec2*)f.inst.coords, f.inst.count, &implicit, 1);
+    mu_assert(memcmp(start, implicitStart, sizeof(u32) * f.inst.count) == 0, "Greedy edge agrees across backends.");
+    Tour dense = CreateTour(&f.arena, TOUR_ARRAY, start, f.inst.count);
+    Tour computed = CreateTour(&f.arena, TOUR_ARRAY, start, f.inst.count);
+    LocalSearchStats denseStats = Or2Opt(&f.arena, &dense, &f.oracle, &f.lists);
+    LocalSearchStats computedStats = Or2Opt(&f.arena, &computed, &implicit, &f.lists);
+
+    u32* a = arenaScratchAlloc(&f.arena, sizeof(u32) * f.inst.count, ALIGN_64);
+    u32* b = arenaScratchAlloc(&f.arena, sizeof(u32) * f.inst.count, ALIGN_64);
+    TourToArray(&dense, a);
+    TourToArray(&computed, b);
+    mu_assert(denseStats.moves == computedStats.moves, "Both backends apply the same moves.");
+    mu_assert(memcmp(a, b, sizeof(u32) * f.inst.count) == 0, "Both backends reach the same tour.");
+    destroyScratchArena(&f.arena);
+    PASS_TEST(" Local search runs unchanged on the implicit oracle.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_two_opt_improves);
+    mu_run_test(test_two_opt_tiny);
+    mu_run_test(test_or_opt_gain_matches);
+    mu_run_test(test_or2opt_beats_two_opt);
+    mu_run_test(test_implicit_oracle_matches_dense);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
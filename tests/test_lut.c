@@ -0,0 +1,169 @@
+#include <math.h>
+#include <string.h>
+#include "minunit.h"
+#include "test_helpers.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "trie.h"
+#include "lut.h"
+
+#define ARENA_SIZE MiB(16)
+#define CITIES 40
+#define FRAGMENTS 300
+#define MAX_LEN 8
+
+mu_suite_start();
+s32 tests_run = 0;
+
+static f32 pathCost(DistanceMatrix dm, const u16* path, u32 len) {
+    f32 cost = 0.0f;
+    for (u32 k = 0; k + 1 < len; k++) {
+        cost += dm.distances[DM_INDEX(dm, path[k], path[k + 1])];
+    }
+    return cost;
+}
+
+//Reference: every permutation of the cities between the fixed ends.
+static void bruteForce(DistanceMatrix dm, u16* path, u32 len, u32 k, f32* best) {
+    if (k + 1 >= len) {
+        f32 cost = pathCost(dm, path, len);
+        if (cost < *best) *best = cost;
+        return;
+    }
+    for (u32 s = k; s + 1 < len; s++) {
+        u16 t = path[k]; path[k] = path[s]; path[s] = t;
+        bruteForce(dm, path, len, k + 1, best);
+        t = path[k]; path[k] = path[s]; path[s] = t;
+    }
+}
+
+//Fragment f: 1 to MAX_LEN distinct cities.
+static u16 makeFragment(u32 f, u16* path) {
+    u32 state = 31 * f + 5;
+    u16 len = (u16)(1 + f % MAX_LEN);
+    for (u16 k = 0; k < len; k++) {
+        bool fresh;
+        do {
+            path[k] = (u16)(rng(&state) % CITIES);
+            fresh = true;
+            for (u16 i = 0; i < k; i++) fresh &= (path[i] != path[k]);
+        } while (!fresh);
+    }
+    return len;
+}
+
+static DistanceMatrix randomMatrix(ScratchArena* arena) {
+    Vec2* coords = arenaScratchAlloc(arena, sizeof(Vec2) * CITIES, ALIGN_64);
+    u32 state = 99;
+    for (u32 i = 0; i < CITIES; i++) {
+        coords[i][0] = (f32)(rng(&state) % 1000);
+        coords[i][1] = (f32)(rng(&state) % 1000);
+    }
+    return CreateDistanceMatrix(arena, coords, CITIES);
+}
+
+char* test_records_are_packed() {
+    memMap* map = initMemMap(MiB(4));
+    PageArena* arena = createPageArena(map, MiB(1));
+    LutTable lut = CreateLutTable(arena, 2);
+    mu_assert(sizeof(LutRecord) == 32, "Records are 32 bytes, two to a cache line.");
+    mu_assert(lut.records && ((usize)lut.records & 63) == 0, "Table is cache line aligned.");
+
+    u16 path[5] = { 9, 4, 7, 1, 3 }, back[LUT_MAX_FRAGMENT];
+    mu_assert(LutAppend(&lut, path, 5, 12.5f) == 0, "First record gets index 0.");
+    mu_assert(LutAppend(&lut, path, 1, 0.0f) == 1, "Single city fragments are stored.");
+    mu_assert(LutAppend(&lut, path, 2, 1.0f) == LUT_NONE, "Full table refuses records.");
+    mu_assert(LutAppend(&lut, path, LUT_MAX_FRAGMENT + 1, 1.0f) == LUT_NONE, "Overlong fragments are refused.");
+
+    const LutRecord* record = LutRecordAt(&lut, 0);
+    mu_assert(record->start == 9 && record->end == 3 && record->cost == 12.5f, "Endpoints and cost kept.");
+    mu_assert(LutRecordOrder(record, back) == 5 && memcmp(back, path, sizeof(path)) == 0, "Order round trips.");
+    mu_assert(LutRecordOrder(LutRecordAt(&lut, 1), back) == 1 && back[0] == 9, "Single city round trips.");
+    mu_assert(!LutRecordAt(&lut, 2), "Indexes past the table have no record.");
+    releasePages(map);
+    PASS_TEST(" LUT records pack into 32 bytes and round trip.");
+    return NULL;
+}
+
+char* test_build_matches_brute_force() {
+    ScratchArena scratch = createScratchArena(ARENA_SIZE);
+    DistanceMatrix dm = randomMatrix(&scratch);
+    memMap* map = initMemMap(MiB(32));
+    PageArena* arena = createPageArena(map, MiB(8));
+    LutTable parallel = CreateLutTable(arena, FRAGMENTS);
+    LutTable serial = CreateLutTable(arena, FRAGMENTS);
+
+    u16 fragments[FRAGMENTS][MAX_LEN];
+    u16 lens[FRAGMENTS];
+    for (u32 f = 0; f < FRAGMENTS; f++) lens[f] = makeFragment(f, fragments[f]);
+    usize mark = arena->offset;
+    mu_assert(LutBuild(&parallel, arena, dm, fragments[0], MAX_LEN, lens, FRAGMENTS, 4) == 0, "Build fills from 0.");
+    mu_assert(arena->offset == mark, "Solver space goes back to the arena.");
+    mu_assert(LutBuild(&serial, arena, dm, fragments[0], MAX_LEN, lens, FRAGMENTS, 1) == 0, "Serial build.");
+    mu_assert(memcmp(parallel.records, serial.records, sizeof(LutRecord) * FRAGMENTS) == 0,
+              "Worker count does not change any record.");
+    mu_assert(LutBuild(&parallel, arena, dm, fragments[0], MAX_LEN, lens, 1, 1) == LUT_NONE, "Full table refuses.");
+
+    u16 order[LUT_MAX_FRAGMENT];
+    for (u32 f = 0; f < FRAGMENTS; f++) {
+        const LutRecord* record = LutRecordAt(&parallel, f);
+        u32 len = LutRecordOrder(record, order);
+        mu_assert(len == lens[f], "Record keeps the fragment length.");
+        mu_assert(order[0] == fragments[f][0] && order[len - 1] == fragments[f][len - 1], "Endpoints stay fixed.");
+        u32 seen = 0;
+        for (u32 k = 0; k < len; k++) {
+            for (u32 i = 0; i < len; i++) seen += (order[k] == fragments[f][i]);
+        }
+        mu_assert(seen == len, "Order is a permutation of the fragment.");
+        f32 best = 1e30f;
+        bruteForce(dm, fragments[f], len, 1, &best);
+        mu_assert(record->cost >= best - 1e-3f && record->cost <= best + 1e-3f, "Cost is the optimum.");
+        mu_assert(fabsf(pathCost(dm, order, len) - record->cost) < 1e-3f, "Order realises the cost.");
+    }
+    releasePages(map);
+    destroyScratchArena(&scratch);
+    PASS_TEST(" Parallel LUT build matches brute force.");
+    return NULL;
+}
+
+char* test_trie_addresses_records() {
+    ScratchArena scratch = createScratchArena(ARENA_SIZE);
+    DistanceMatrix dm = randomMatrix(&scratch);
+    memMap* map = initMemMap(MiB(32));
+    PageArena* arena = createPageArena(map, MiB(8));
+    LutTable lut = CreateLutTable(arena, FRAGMENTS);
+    TrieAllocator alloc = createTrieAllocator(arena);
+    TrieNode* root = createTrieNode(&alloc, 0);
+
+    u16 fragments[FRAGMENTS][MAX_LEN];
+    u16 lens[FRAGMENTS];
+    for (u32 f = 0; f < FRAGMENTS; f++) lens[f] = makeFragment(f, fragments[f]);
+    u32 first = LutBuild(&lut, arena, dm, fragments[0], MAX_LEN, lens, FRAGMENTS, 0);
+    mu_assert(first == 0, "Build succeeds on every hardware thread.");
+    for (u32 f = 0; f < FRAGMENTS; f++) insertTrie(&alloc, root, fragments[f], lens[f], first + f);
+
+    FrozenTrie frozen = freezeTrie(arena, &alloc, root);
+    for (u32 f = 0; f < FRAGMENTS; f++) {
+        TrieNode* leaf = searchTrie(root, fragments[f], lens[f]);
+        u32 node = searchFrozenTrie(&frozen, fragments[f], lens[f]);
+        const LutRecord* record = LutRecordAt(&lut, leaf->lutIndex);
+        mu_assert(record && record->start == fragments[f][0] && record->len == lens[f], "Leaf leads to its record.");
+        mu_assert(frozen.lutIndex[node] == leaf->lutIndex, "Frozen trie carries the same index.");
+    }
+    mu_assert(root->lutIndex == LUT_NONE, "Inner nodes hold no record.");
+    releasePages(map);
+    destroyScratchArena(&scratch);
+    PASS_TEST(" Trie leaves address LUT records by index.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_records_are_packed);
+    mu_run_test(test_build_matches_brute_force);
+    mu_run_test(test_trie_addresses_records);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
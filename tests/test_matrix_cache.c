@@ -0,0 +1,149 @@
+#include <string.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "matrix_cache.h"
+#include "hash.h"
+
+#define ARENA_SIZE MiB(128)
+#define CACHE_PATH "test_lib/ca4663.dmc"
+#define COPY_PATH "test_lib/geo5_copy.tsp"
+#define COPY_CACHE_PATH "test_lib/geo5_copy.dmc"
+
+mu_suite_start();
+s32 tests_run = 0;
+
+static bool copyFile(const char* from, const char* to) {
+    FILE* in = fopen(from, "rb");
+    FILE* out = fopen(to, "wb");
+    if (!in || !out) return false;
+    char buf[4096];
+    usize n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        fwrite(buf, 1, n, out);
+    }
+    fclose(in);
+    fclose(out);
+    return true;
+}
+
+char* test_hash_bytes() {
+    const char text[] = "the quick brown fox jumps over the lazy dog, twice over";
+    u64 a = HashBytes(text, sizeof(text), 0);
+    mu_assert(a == HashBytes(text, sizeof(text), 0), "Hash is deterministic.");
+    mu_assert(a != HashBytes(text, sizeof(text), 1), "Seed changes the hash.");
+    mu_assert(a != HashBytes(text, sizeof(text) - 1, 0), "Length changes the hash.");
+    char flipped[sizeof(text)];
+    memcpy(flipped, text, sizeof(text));
+    flipped[41] ^= 1;
+    mu_assert(a != HashBytes(flipped, sizeof(flipped), 0), "A single bit flip changes the hash.");
+    PASS_TEST(" Word-at-a-time hash.");
+    return NULL;
+}
+
+char* test_write_and_map() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    SourceFingerprint source;
+    mu_assert(FingerprintSource("test_data/ca4663.tsp", &source), "Fingerprint the source.");
+    mu_assert(WriteMatrixCache(CACHE_PATH, dm, inst.count, inst.metric, &source) == MATRIX_CACHE_OK, "Cache written.");
+
+    CachedMatrix cached = MapMatrixCache(CACHE_PATH, &source, true);
+    mu_assert(cached.status == MATRIX_CACHE_OK && cached.fromCache, "Cache maps back.");
+    mu_assert(cached.count == inst.count && cached.metric == inst.metric, "Header round trips.");
+    mu_assert(((usize)cached.dm.distances & 63) == 0 && ((usize)cached.dm.rowOffset & 63) == 0, "Sections are aligned.");
+    mu_assert(memcmp(cached.dm.rowOffset, dm.rowOffset, sizeof(u32) * inst.count) == 0, "rowOffset round trips.");
+    mu_assert(memcmp(cached.dm.distances, dm.distances, sizeof(f32) * PackedMatrixSize(inst.count)) == 0,
+              "Distances round trip.");
+    UnmapMatrixCache(&cached);
+    mu_assert(cached.dm.distances == NULL, "Unmap clears the matrix.");
+
+    SourceFingerprint other = source;
+    other.contentHash ^= 1;
+    cached = MapMatrixCache(CACHE_PATH, &other, false);
+    mu_assert(cached.status == MATRIX_CACHE_STALE && cached.mapBase == NULL, "Changed source makes the cache stale.");
+    cached = MapMatrixCache("test_lib/no_such.dmc", &source, false);
+    mu_assert(cached.status == MATRIX_CACHE_MISSING, "Missing cache reported.");
+    remove(CACHE_PATH);
+    destroyScratchArena(&arena);
+    PASS_TEST(" Cache write and map round trip.");
+    return NULL;
+}
+
+char* test_corruption_detected() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    mu_assert(copyFile("test_data/geo5.tsp", COPY_PATH), "Copy source.");
+    remove(COPY_CACHE_PATH);
+    CachedMatrix built = LoadOrBuildMatrix(&arena, COPY_PATH, COPY_CACHE_PATH, 1, true);
+    mu_assert(built.status == MATRIX_CACHE_OK && !built.fromCache, "First run builds and writes.");
+
+    SourceFingerprint source;
+    FingerprintSource(COPY_PATH, &source);
+    FILE* file = fopen(COPY_CACHE_PATH, "r+b");
+    fseek(file, -2, SEEK_END);
+    fputc(0x55, file);
+    fclose(file);
+    CachedMatrix cached = MapMatrixCache(COPY_CACHE_PATH, &source, false);
+    mu_assert(cached.status == MATRIX_CACHE_OK, "Unverified map skips the checksum.");
+    UnmapMatrixCache(&cached);
+    cached = MapMatrixCache(COPY_CACHE_PATH, &source, true);
+    mu_assert(cached.status == MATRIX_CACHE_CORRUPT, "Flipped payload fails the checksum.");
+
+    CachedMatrix rebuilt = LoadOrBuildMatrix(&arena, COPY_PATH, COPY_CACHE_PATH, 1, true);
+    mu_assert(rebuilt.status == MATRIX_CACHE_OK && !rebuilt.fromCache, "Corrupt cache is rebuilt.");
+    CachedMatrix reused = LoadOrBuildMatrix(&arena, COPY_PATH, COPY_CACHE_PATH, 1, true);
+    mu_assert(reused.fromCache && reused.count == 5, "Rebuilt cache is used next time.");
+    mu_assert(reused.dm.distances[DM_INDEX(reused.dm, 0, 1)] == built.dm.distances[DM_INDEX(built.dm, 0, 1)],
+              "Cached distances match the build.");
+    UnmapMatrixCache(&reused);
+
+    struct utimbuf touched = { .actime = 1000000000, .modtime = 1000000000 };
+    mu_assert(utime(COPY_PATH, &touched) == 0, "Touch source.");
+    CachedMatrix afterTouch = LoadOrBuildMatrix(&arena, COPY_PATH, COPY_CACHE_PATH, 1, false);
+    mu_assert(afterTouch.status == MATRIX_CACHE_OK && afterTouch.fromCache, "Touched but unchanged source keeps the cache.");
+    UnmapMatrixCache(&afterTouch);
+    struct stat st;
+    MatrixCacheHeader header;
+    file = fopen(COPY_CACHE_PATH, "rb");
+    mu_assert(file && fread(&header, sizeof(header), 1, file) == 1, "Read cache header.");
+    fclose(file);
+    mu_assert(stat(COPY_PATH, &st) == 0 && header.source.mtime == (s64)st.st_mtime &&
+              header.source.size == (u64)st.st_size, "Content match restamps the header for the stat-only path.");
+    CachedMatrix secondLoad = LoadOrBuildMatrix(&arena, COPY_PATH, COPY_CACHE_PATH, 1, false);
+    mu_assert(secondLoad.fromCache, "Second load after a touch maps the cache.");
+    UnmapMatrixCache(&secondLoad);
+
+    file = fopen(COPY_PATH, "ab");
+    fputs("EOF\n", file);
+    fclose(file);
+    CachedMatrix afterEdit = LoadOrBuildMatrix(&arena, COPY_PATH, COPY_CACHE_PATH, 1, true);
+    mu_assert(afterEdit.status == MATRIX_CACHE_OK && !afterEdit.fromCache, "Edited source invalidates the cache.");
+
+    file = fopen(COPY_CACHE_PATH, "wb");
+    fputs("short", file);
+    fclose(file);
+    FingerprintSource(COPY_PATH, &source);
+    cached = MapMatrixCache(COPY_CACHE_PATH, &source, true);
+    mu_assert(cached.status == MATRIX_CACHE_CORRUPT, "Truncated cache is corrupt.");
+
+    remove(COPY_PATH);
+    remove(COPY_CACHE_PATH);
+    destroyScratchArena(&arena);
+    PASS_TEST(" Stale and corrupt caches detected.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_hash_bytes);
+    mu_run_test(test_write_and_map);
+    mu_run_test(test_corruption_detected);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -3,6 +3,7 @@
 #include <setjmp.h> 
 #include "arena_base.h"
 #include "page_arena.h"
+#include "test_helpers.h"
 
 static sigjmp_buf jump_env;
 
@@ -11,6 +12,10 @@ s32 tests_run = 0;
 
 #define ARENA_SIZE MiB(10)
 #define MEM_MAP_SIZE MiB(64)
+#define STRESS_MAP_SIZE MiB(256)
+#define STRESS_THREADS 16
+#define STRESS_ROUNDS 300
+#define STRESS_LIVE 4
 
 void segv_handler(s32 sig) {
     siglongjmp(jump_env, 1);
@@ -365,7 +370,129 @@ char* test_zero_alloc() {
     PASS_TEST("Zero allocation handled");
     return NULL;
 }
-    
+
+char* test_pop_reclaims_pages() {
+    memMap* map = initMemMap(MEM_MAP_SIZE);
+    for (u32 i = 0; i < 1000; i++) {
+        PageArena* arena = createPageArena(map, ARENA_SIZE);
+        mu_assert(isArenaValid(arena), "arena creation failed on reclaim test\n");
+        arenaPagePop(map);
+        mu_assert(map->slotsClaimed == 0, "popped arena did not give its slot back\n");
+    }
+    PageArena* outer = createPageArena(map, ARENA_SIZE);
+    for (u32 i = 0; i < 1000; i++) {
+        PageArena* inner = createPageArena(map, ARENA_SIZE);
+        mu_assert(inner == outer + 1, "nested arena did not reuse its slot\n");
+        releasePageArena(inner);
+        mu_assert(map->slotsClaimed == 1 && map->arenaCurrent == outer, "nested release did not unlink its slot\n");
+    }
+    arenaPagePop(map);
+    mu_assert(map->offset == 0 && map->arenaCount == 0, "popped arenas give their pages back\n");
+    mu_assert(map->slotsClaimed == 0 && map->arenaCurrent == NULL, "popped arenas give their slots back\n");
+    releasePages(map);
+    map = NULL;
+    PASS_TEST("Create and pop reuse the same pages");
+    return NULL;
+}
+
+char* test_mark_rewind_nests() {
+    memMap* map = initMemMap(MEM_MAP_SIZE);
+    PageArena* arena = createPageArena(map, ARENA_SIZE);
+    arenaPageAlloc(arena, 100, ALIGN_8);
+    usize start = arena->offset;
+    usize outer = arenaPageMark(arena);
+    arenaPageAlloc(arena, 200, ALIGN_64);
+    usize middle = arena->offset;
+    usize inner = arenaPageMark(arena);
+    arenaPageAlloc(arena, 300, ALIGN_16);
+    arenaPageRewind(arena, inner);
+    mu_assert(arena->offset == middle && arena->previous == start, "inner rewind did not restore the outer mark\n");
+    arenaPageRewind(arena, outer);
+    mu_assert(arena->offset == start && arena->previous == 0, "outer rewind did not restore the arena\n");
+    releasePages(map);
+    map = NULL;
+    PASS_TEST("Page arena marks nest");
+    return NULL;
+}
+
+char* test_metadata_grows() {
+    memMap* map = initMemMap(MEM_MAP_SIZE);
+    u32 count = 8 * map->firstChunkSlots;
+    PageArena* previous = NULL;
+    for (u32 i = 0; i < count; i++) {
+        PageArena* arena = createPageArena(map, 64);
+        mu_assert(isArenaValid(arena), "arena beyond the metadata page failed\n");
+        mu_assert(((usize)arena & (ALIGN_64 - 1)) == 0, "arena handle not on its own cache line\n");
+        mu_assert(arena->arenaPrevious == previous, "chain broken across metadata blocks\n");
+        previous = arena;
+    }
+    mu_assert(map->arenaCount == count && map->metaChunks[3] != NULL, "metadata did not grow past one page\n");
+    for (u32 i = 0; i < count; i++) {
+        arenaPagePop(map);
+    }
+    mu_assert(map->offset == 0 && map->arenaCount == 0, "map not empty after popping every arena\n");
+    releasePages(map);
+    map = NULL;
+    PASS_TEST("Arena metadata grows past the metadata page");
+    return NULL;
+}
+
+//Every byte of an arena carries its thread's tag, so two arenas sharing pages show up on release.
+static bool releaseChecked(PageArena* arena, u8 tag) {
+    bool intact = true;
+    for (usize i = 0; i < arena->size; i++) {
+        intact &= (arena->base[i] == tag);
+    }
+    releasePageArena(arena);
+    return intact;
+}
+
+static void stressTask(memptr ctx, u32 threadIndex, StressCounters* counters) {
+    memMap* map = (memMap*)ctx;
+    PageArena* live[STRESS_LIVE];
+    u32 liveCount = 0;
+    u32 state = 7 * threadIndex + 3;
+    u8 tag = (u8)(threadIndex + 1);
+    for (u32 r = 0; r < STRESS_ROUNDS; r++) {
+        if (liveCount == STRESS_LIVE || (liveCount > 0 && rng(&state) % 3 == 0)) {
+            u32 pick = rng(&state) % liveCount;
+            if (!releaseChecked(live[pick], tag)) counters->errors++;
+            live[pick] = live[--liveCount];
+            continue;
+        }
+        usize size = (1 + rng(&state) % 3) * 4096 - rng(&state) % 512;
+        PageArena* arena = createPageArena(map, size);
+        if (!isArenaValid(arena) || arena->size != size || ((usize)arena & (ALIGN_64 - 1))) {
+            counters->errors++;
+            continue;
+        }
+        memset(arena->base, tag, size);
+        live[liveCount++] = arena;
+        counters->count++;
+    }
+    while (liveCount > 0) {
+        if (!releaseChecked(live[--liveCount], tag)) counters->errors++;
+    }
+}
+
+char* test_threaded_create_release() {
+    memMap* map = initMemMap(STRESS_MAP_SIZE);
+    StressCounters total = runStress(STRESS_THREADS, stressTask, map);
+    u32 created = total.count;
+    mu_assert(total.errors == 0, "arenas overlapped or failed under concurrent create and release\n");
+    mu_assert(map->slotsClaimed <= created && map->arenaCount == 0, "arena bookkeeping lost an update\n");
+    mu_assert(map->offset <= map->size, "map offset ran past the mapping\n");
+    u32 chained = 0;
+    for (PageArena* a = map->arenaCurrent; a && chained <= created; a = a->arenaPrevious) {
+        mu_assert(a->slot < map->slotsClaimed && !a->base, "chain holds a handed back or live slot\n");
+        chained++;
+    }
+    mu_assert(chained <= map->slotsClaimed, "arena chain lost a concurrent push\n");
+    releasePages(map);
+    map = NULL;
+    PASS_TEST("Arenas created and released from 16 threads at once");
+    return NULL;
+}
 
 static char* all_tests() {
     mu_run_test(test_create_memMap);
@@ -386,6 +513,10 @@ static char* all_tests() {
     mu_run_test(test_arena_page_bound);
     mu_run_test(test_pop_without_create);
     mu_run_test(test_zero_alloc);
+    mu_run_test(test_pop_reclaims_pages);
+    mu_run_test(test_mark_rewind_nests);
+    mu_run_test(test_metadata_grows);
+    mu_run_test(test_threaded_create_release);
     return NULL;
 }
 
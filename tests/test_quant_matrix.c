@@ -0,0 +1,93 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "quant_matrix.h"
+
+#define ARENA_SIZE MiB(256)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+char* test_matches_float_matrix() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    QuantMatrix qm = BuildQuantMatrix(&arena, &inst, 1);
+    mu_assert(qm.width != QUANT_NONE && qm.count == inst.count, "Quantized matrix should build.");
+    for (u32 i = 0; i < inst.count; i += 3) {
+        for (u32 j = 0; j < inst.count; j += 5) {
+            u32 expected = (i == j) ? 0 : (u32)dm.distances[DM_INDEX(dm, i, j)];
+            mu_assert(QuantDistance(&qm, i, j) == expected, "Entries match the f32 matrix.");
+            mu_assert(expected <= qm.maxDistance, "Bound covers every entry.");
+        }
+    }
+
+    QuantMatrix parallel = BuildQuantMatrix(&arena, &inst, 4);
+    mu_assert(parallel.width == qm.width, "Width does not depend on threads.");
+    for (usize k = 0; k < PackedMatrixSize(inst.count); k++) {
+        u32 a = (qm.width == QUANT_U16) ? qm.d16[k] : qm.d32[k];
+        u32 b = (qm.width == QUANT_U16) ? parallel.d16[k] : parallel.d32[k];
+        mu_assert(a == b, "Parallel build equals serial build.");
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Quantized matrix matches f32 matrix.");
+    return NULL;
+}
+
+char* test_exact_tour_cost() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    QuantMatrix qm = BuildQuantMatrix(&arena, &inst, 2);
+    u32* tour = arenaScratchAlloc(&arena, sizeof(u32) * inst.count, ALIGN_64);
+    for (u32 i = 0; i < inst.count; i++) tour[i] = inst.count - 1 - i;
+
+    u64 expected = MetricDistanceInt(inst.metric, inst.coords[tour[inst.count - 1]], inst.coords[tour[0]]);
+    for (u32 k = 0; k + 1 < inst.count; k++) {
+        expected += MetricDistanceInt(inst.metric, inst.coords[tour[k]], inst.coords[tour[k + 1]]);
+    }
+    mu_assert(QuantTourCost(&qm, tour, inst.count) == expected, "Tour cost is the exact integer sum.");
+    mu_assert(QuantTourCost(&qm, tour, 1) == 0, "Single city tour is free.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Exact integer tour cost.");
+    return NULL;
+}
+
+char* test_width_selection() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance geo = LoadTspInstance(&arena, "test_data/geo5.tsp");
+    QuantMatrix qm = BuildQuantMatrix(&arena, &geo, 1);
+    mu_assert(qm.width == QUANT_U16 && qm.d16 != NULL && qm.d32 == NULL, "GEO always fits u16.");
+    mu_assert(QuantDistance(&qm, 0, 1) == 509, "GEO distance quantized exactly.");
+
+    TspInstance explicitInst = LoadTspInstance(&arena, "test_data/explicit_full.tsp");
+    qm = BuildQuantMatrix(&arena, &explicitInst, 1);
+    mu_assert(qm.width == QUANT_U16 && QuantDistance(&qm, 4, 2) == 8, "Explicit weights quantize.");
+
+    //16777217 is past f32 precision, so this pair must take the integer path
+    Vec2 far[3] = { { 0.0f, 0.0f }, { 16777216.0f, 5793.0f }, { 1.0f, 1.0f } };
+    TspInstance synthetic = { .coords = far, .weights = NULL, .dimension = 3, .count = 3, .errorLine = 0,
+                              .metric = TSP_METRIC_EUC_2D, .weightFormat = TSP_FORMAT_NONE, .status = TSP_LOAD_OK };
+    qm = BuildQuantMatrix(&arena, &synthetic, 1);
+    mu_assert(qm.width == QUANT_U32 && qm.d32 != NULL, "Large distances need u32.");
+    mu_assert(QuantDistance(&qm, 0, 1) == 16777217u, "Distances past 2^24 stay exact.");
+    mu_assert(QuantDistance(&qm, 2, 0) == 1, "Small distances in a u32 matrix.");
+
+    synthetic.metric = TSP_METRIC_SQR_EUC_2D;
+    qm = BuildQuantMatrix(&arena, &synthetic, 1);
+    mu_assert(qm.width == QUANT_NONE && qm.rowOffset == NULL, "Squared Euclidean is not quantized.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Width chosen from the distance bound.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_matches_float_matrix);
+    mu_run_test(test_exact_tour_cost);
+    mu_run_test(test_width_selection);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
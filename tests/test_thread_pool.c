@@ -0,0 +1,92 @@
+#include "minunit.h"
+#include "thread_pool.h"
+
+mu_suite_start();
+s32 tests_run = 0;
+
+typedef struct {
+    u32 hits[THREAD_POOL_MAX_THREADS];
+    u32 seenCount;
+} PoolProbe;
+
+static void probeTask(memptr ctx, u32 threadIndex, u32 threadCount) {
+    PoolProbe* probe = (PoolProbe*)ctx;
+    probe->hits[threadIndex]++;
+    if (threadIndex == 0) probe->seenCount = threadCount;
+}
+
+char* test_every_worker_runs_once() {
+    PoolProbe probe = {0};
+    runThreadPool(8, probeTask, &probe);
+    mu_assert(probe.seenCount == 8, "Workers should see the requested thread count.");
+    for (u32 t = 0; t < 8; t++) {
+        mu_assert(probe.hits[t] == 1, "Each worker index should run exactly once.");
+    }
+    PASS_TEST(" Every worker ran once.");
+    return NULL;
+}
+
+char* test_zero_threads_runs_caller() {
+    PoolProbe probe = {0};
+    runThreadPool(0, probeTask, &probe);
+    mu_assert(probe.seenCount == 1 && probe.hits[0] == 1, "Zero threads should run on the caller only.");
+    PASS_TEST(" Zero thread request runs inline.");
+    return NULL;
+}
+
+char* test_hardware_threads() {
+    mu_assert(hardwareThreadCount() >= 1, "At least one hardware thread.");
+    PASS_TEST(" Hardware thread count sane.");
+    return NULL;
+}
+
+#define STEAL_ITEMS 5000
+
+typedef struct {
+    u32 runs[STEAL_ITEMS];
+    u64 checksum;
+} StealProbe;
+
+static void stealTask(memptr ctx, u32 item, u32 threadIndex) {
+    StealProbe* probe = (StealProbe*)ctx;
+    u64 acc = 0;
+    //skewed cost: late items are much heavier, so the first workers must steal
+    for (u32 k = 0; k < item * 4; k++) acc += k ^ item;
+    __atomic_fetch_add(&probe->runs[item], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&probe->checksum, acc & 1, __ATOMIC_RELAXED);
+}
+
+char* test_stealing_runs_every_item_once() {
+    static StealProbe probe;
+    u32 threadCounts[] = { 1, 2, 5, 16 };
+    for (u32 t = 0; t < ARRAY_COUNT(threadCounts); t++) {
+        memset(&probe, 0, sizeof(probe));
+        runThreadPoolStealing(threadCounts[t], STEAL_ITEMS, stealTask, &probe);
+        for (u32 i = 0; i < STEAL_ITEMS; i++) {
+            mu_assert(probe.runs[i] == 1, "Each item should run exactly once.");
+        }
+    }
+    PASS_TEST(" Work stealing ran every item once.");
+    return NULL;
+}
+
+char* test_stealing_more_threads_than_items() {
+    static StealProbe probe;
+    memset(&probe, 0, sizeof(probe));
+    runThreadPoolStealing(32, 3, stealTask, &probe);
+    mu_assert(probe.runs[0] == 1 && probe.runs[1] == 1 && probe.runs[2] == 1, "Small item counts still run once.");
+    mu_assert(probe.runs[3] == 0, "No item beyond the count should run.");
+    PASS_TEST(" Stealing with fewer items than threads.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_every_worker_runs_once);
+    mu_run_test(test_zero_threads_runs_caller);
+    mu_run_test(test_hardware_threads);
+    mu_run_test(test_stealing_runs_every_item_once);
+    mu_run_test(test_stealing_more_threads_than_items);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
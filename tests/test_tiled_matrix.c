@@ -0,0 +1,67 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "tiled_matrix.h"
+
+#define ARENA_SIZE MiB(256)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+static bool sameAsPacked(const TiledMatrix* tm, DistanceMatrix dm, u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        if (TiledDistance(tm, i, i) != 0.0f) return false;
+        for (u32 j = i + 1; j < count; j++) {
+            f32 expected = dm.distances[DM_INDEX(dm, i, j)];
+            if (TiledDistance(tm, i, j) != expected || TiledDistance(tm, j, i) != expected) return false;
+        }
+    }
+    return true;
+}
+
+char* test_matches_packed() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &inst);
+    TiledMatrix tm = BuildTiledMatrix(&arena, &inst, 1);
+    mu_assert(tm.tiles != NULL && tm.count == inst.count, "Tiled matrix should build.");
+    mu_assert(tm.tilesPerSide == (inst.count + TILE_MASK) / TILE_DIM, "Partial edge tile is counted.");
+    mu_assert(((usize)tm.tiles & 63) == 0, "Tiles are cache line aligned.");
+    mu_assert(sameAsPacked(&tm, dm, inst.count), "Every pair matches the packed layout.");
+
+    TiledMatrix parallel = BuildTiledMatrix(&arena, &inst, 4);
+    usize entries = (usize)tm.tilesPerSide * (tm.tilesPerSide + 1) / 2 * TILE_ENTRIES;
+    for (usize k = 0; k < entries; k++) {
+        mu_assert(tm.tiles[k] == parallel.tiles[k], "Parallel build equals serial build.");
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Tiled layout matches packed layout.");
+    return NULL;
+}
+
+char* test_small_and_explicit() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance geo = LoadTspInstance(&arena, "test_data/geo5.tsp");
+    TiledMatrix tm = BuildTiledMatrix(&arena, &geo, 2);
+    mu_assert(tm.tilesPerSide == 1, "Five cities fit one tile.");
+    mu_assert(TiledDistance(&tm, 1, 0) == 509.0f && TiledDistance(&tm, 3, 3) == 0.0f, "GEO tile values.");
+
+    TspInstance explicitInst = LoadTspInstance(&arena, "test_data/explicit_upper.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&arena, &explicitInst);
+    tm = BuildTiledMatrix(&arena, &explicitInst, 1);
+    mu_assert(sameAsPacked(&tm, dm, explicitInst.count), "Explicit weights tile.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Small and explicit tiled matrices.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_matches_packed);
+    mu_run_test(test_small_and_explicit);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
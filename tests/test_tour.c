@@ -0,0 +1,152 @@
+#include "minunit.h"
+#include "test_helpers.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "tour.h"
+
+#define ARENA_SIZE MiB(8)
+#define N 97
+
+mu_suite_start();
+s32 tests_run = 0;
+
+//Reference: reverse the forward path from..to directly in a plain array.
+static void naiveReverse(u32* order, u32 n, u32 from, u32 to) {
+    u32 i = 0, j = 0;
+    for (u32 p = 0; p < n; p++) {
+        if (order[p] == from) i = p;
+        if (order[p] == to) j = p;
+    }
+    u32 len = ((j >= i) ? j - i : j + n - i) + 1;
+    for (u32 s = 0; s < len / 2; s++) {
+        u32 t = order[i]; order[i] = order[j]; order[j] = t;
+        i = (i + 1) % n;
+        j = (j + n - 1) % n;
+    }
+}
+
+//Same cyclic sequence in either direction. A mirrored match flips the reference array so it
+//keeps the tour's orientation: "forward path" always means the tour's forward direction.
+static bool sameCycle(const Tour* tour, u32* order, u32 n) {
+    u32 p = 0;
+    while (order[p] != 0) p++;
+    bool forward = true, backward = true;
+    u32 city = 0;
+    for (u32 k = 0; k < n; k++) {
+        if (order[(p + k) % n] != city) forward = false;
+        if (order[(p + n - k) % n] != city) backward = false;
+        city = TourNext(tour, city);
+    }
+    if (!forward && backward) {
+        for (u32 s = 0; s < n / 2; s++) {
+            u32 t = order[s]; order[s] = order[n - 1 - s]; order[n - 1 - s] = t;
+        }
+    }
+    return forward || backward;
+}
+
+//Random reversals against the naive array. maxSpan > 0 keeps to within maxSpan steps of from,
+//the pattern local search produces; 0 picks both ends uniformly.
+static char* checkReversals(TourKind kind, u32 n, u32 iterations, u32 maxSpan) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    u32* order = arenaScratchAlloc(&arena, sizeof(u32) * n, ALIGN_64);
+    for (u32 i = 0; i < n; i++) order[i] = (u32)(((u64)i * 31) % n);
+    Tour tour = CreateTour(&arena, kind, order, n);
+    mu_assert(tour.kind == kind && tour.count == n, "Tour should build.");
+
+    u32 state = 99;
+    for (u32 it = 0; it < iterations; it++) {
+        u32 from = rng(&state) % n, to = rng(&state) % n;
+        if (maxSpan > 0) {
+            to = from;
+            for (u32 s = rng(&state) % maxSpan; s > 0; s--) to = TourNext(&tour, to);
+        }
+        TourReverse(&tour, from, to);
+        naiveReverse(order, n, from, to);
+        mu_assert(sameCycle(&tour, order, n), "Reversal matches the naive array.");
+        for (u32 c = 0; c < n; c++) {
+            mu_assert(TourPrev(&tour, TourNext(&tour, c)) == c, "Prev inverts next.");
+        }
+    }
+    destroyScratchArena(&arena);
+    return NULL;
+}
+
+char* test_reverse_matches_naive() {
+    char* message = checkReversals(TOUR_ARRAY, N, 2000, 0);
+    if (message) return message;
+    PASS_TEST(" Reversal matches naive reversal.");
+    return NULL;
+}
+
+char* test_two_level_reverse_matches_naive() {
+    char* message = checkReversals(TOUR_TWO_LEVEL, N, 4000, 0);
+    if (message) return message;
+    message = checkReversals(TOUR_TWO_LEVEL, 1000, 3000, 60);
+    if (message) return message;
+    //small enough that segments of 2 cities split and outgrow often
+    message = checkReversals(TOUR_TWO_LEVEL, 9, 2000, 0);
+    if (message) return message;
+    PASS_TEST(" Two-level reversal matches naive reversal.");
+    return NULL;
+}
+
+static char* checkBetween(TourKind kind) {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    u32 order[N];
+    for (u32 i = 0; i < N; i++) order[i] = i;
+    Tour tour = CreateTour(&arena, kind, order, N);
+    TourReverse(&tour, 70, 20);     //long path, the complement gets reversed
+    TourReverse(&tour, 5, 12);
+    u32 state = 5;
+    for (u32 it = 0; it < 5000; it++) {
+        u32 a = rng(&state) % N, b = rng(&state) % N, c = rng(&state) % N;
+        bool expected = false;
+        for (u32 x = a;; x = TourNext(&tour, x)) {
+            if (x == b) expected = true;
+            if (x == c) break;
+        }
+        mu_assert(TourBetween(&tour, a, b, c) == expected, "Between follows the forward path.");
+    }
+    u32 out[N];
+    TourToArray(&tour, out);
+    mu_assert(out[0] == 0 && IsTourPermutation(&arena, out, N), "Array export starts at city 0.");
+    destroyScratchArena(&arena);
+    return NULL;
+}
+
+char* test_between() {
+    char* message = checkBetween(TOUR_ARRAY);
+    if (message) return message;
+    message = checkBetween(TOUR_TWO_LEVEL);
+    if (message) return message;
+    PASS_TEST(" Between queries.");
+    return NULL;
+}
+
+char* test_paged_block() {
+    memMap* map = initMemMap(MiB(4));
+    PageArena* arena = createPageArena(map, MiB(1));
+    u32 order[N];
+    for (u32 i = 0; i < N; i++) order[i] = N - 1 - i;
+    Tour tour = CreateTourPaged(arena, TOUR_TWO_LEVEL, order, N);
+    mu_assert(tour.nodes && arena->offset >= TourBlockSize(TOUR_TWO_LEVEL, N), "Tour lives in one page block.");
+    mu_assert((byte)tour.nodes > (byte)tour.segments && (byte)tour.scratch > (byte)tour.nodes,
+              "Segments, nodes and scratch are laid out in order.");
+    mu_assert(TourNext(&tour, 5) == 4 && TourPrev(&tour, 5) == 6, "Paged tour follows the order.");
+    releasePages(map);
+    PASS_TEST(" Two-level tour in a page arena block.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_reverse_matches_naive);
+    mu_run_test(test_two_level_reverse_matches_naive);
+    mu_run_test(test_between);
+    mu_run_test(test_paged_block);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
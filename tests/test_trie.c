@@ -0,0 +1,232 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "page_arena.h"
+#include "test_helpers.h"
+#include "trie.h"
+
+#define MEM_MAP_SIZE MiB(64)
+#define ARENA_SIZE MiB(32)
+#define FRAGMENTS 5000
+#define FRAGMENT_LEN 6
+#define STRESS_THREADS 8
+#define STRESS_FRAGMENTS 20000
+#define STRESS_LEN 4
+
+mu_suite_start();
+s32 tests_run = 0;
+
+//Few first labels and a wide label range further down, so fan-out goes from thousands to one.
+static void makeFragment(u32 f, u16* path) {
+    u32 state = f + 1;
+    path[0] = (u16)(f % 3000);
+    for (u32 i = 1; i < FRAGMENT_LEN; i++) {
+        path[i] = (u16)(rng(&state) % ((i == 1) ? 8 : 60000));
+    }
+}
+
+static bool sortedChildren(const TrieNode* node) {
+    for (u16 i = 1; i < node->children->count; i++) {
+        if (node->children->entries[i - 1].label >= node->children->entries[i].label) return false;
+    }
+    return true;
+}
+
+char* test_insert_and_search() {
+    memMap* map = initMemMap(MEM_MAP_SIZE);
+    PageArena* arena = createPageArena(map, ARENA_SIZE);
+    TrieAllocator alloc = createTrieAllocator(arena);
+    TrieNode* root = createTrieNode(&alloc, 0);
+
+    u16 path[FRAGMENT_LEN];
+    for (u32 f = 0; f < FRAGMENTS; f++) {
+        makeFragment(f, path);
+        TrieNode* leaf = insertTrie(&alloc, root, path, FRAGMENT_LEN, f);
+        mu_assert(leaf && leaf->isTerminal, "Insert reaches a terminal node.");
+    }
+    mu_assert(root->children->count == 3000 && sortedChildren(root), "Root children stay sorted and unique.");
+    for (u32 f = 0; f < FRAGMENTS; f++) {
+        makeFragment(f, path);
+        TrieNode* leaf = searchTrie(root, path, FRAGMENT_LEN);
+        mu_assert(leaf && leaf->lutIndex == f, "Every fragment is found with its payload.");
+        mu_assert(!searchTrie(root, path, FRAGMENT_LEN - 1), "Proper prefixes are not terminal.");
+    }
+    path[0] = 3001;
+    mu_assert(!searchTrie(root, path, FRAGMENT_LEN), "Absent fragment misses.");
+    releasePages(map);
+    PASS_TEST(" Trie insert and search over mixed fan-out.");
+    return NULL;
+}
+
+char* test_child_arrays_are_reused() {
+    memMap* map = initMemMap(MEM_MAP_SIZE);
+    PageArena* arena = createPageArena(map, ARENA_SIZE);
+    TrieAllocator alloc = createTrieAllocator(arena);
+    TrieNode* root = createTrieNode(&alloc, 0);
+
+    //100 nodes each growing to 40 children: every outgrown array is recycled by the next node
+    u16 path[2];
+    for (u16 a = 0; a < 100; a++) {
+        for (u16 b = 0; b < 40; b++) {
+            path[0] = a;
+            path[1] = (u16)(39 - b);
+            mu_assert(insertTrie(&alloc, root, path, 2, LUT_NONE), "Insert succeeds.");
+        }
+    }
+    mu_assert(alloc.arraysReused > 0, "Outgrown child arrays come back from the free lists.");
+    TrieNode* small = createTrieNode(&alloc, 7);
+    mu_assert(small->children->isInline && small->children->sizeClass == 0, "New nodes start inline.");
+
+    //live arrays: 100 nodes at 64 slots plus the root at 128, nodes in blocks of TRIE_NODE_BLOCK
+    usize live = sizeof(TrieChild) * (100 * 64 + 128) + sizeof(TrieChildren) * 101
+               + sizeof(TrieNode) * TRIE_NODE_BLOCK * 17;
+    mu_assert(arena->offset < 2 * live, "Arena use stays linear in the live children.");
+    releasePages(map);
+    PASS_TEST(" Child arrays grow geometrically and are recycled.");
+    return NULL;
+}
+
+char* test_frozen_matches_pointer_trie() {
+    memMap* map = initMemMap(MEM_MAP_SIZE);
+    PageArena* arena = createPageArena(map, ARENA_SIZE);
+    TrieAllocator alloc = createTrieAllocator(arena);
+    TrieNode* root = createTrieNode(&alloc, 0);
+
+    //Every other fragment stored; the rest probe misses that share prefixes with stored ones.
+    u16 paths[FRAGMENTS][FRAGMENT_LEN];
+    u16 lens[FRAGMENTS];
+    for (u32 f = 0; f < FRAGMENTS; f++) {
+        makeFragment(f, paths[f]);
+        lens[f] = (u16)(FRAGMENT_LEN - f % 3);
+        if (f % 2 == 0) insertTrie(&alloc, root, paths[f], lens[f], f);
+    }
+    FrozenTrie frozen = freezeTrie(arena, &alloc, root);
+    mu_assert(frozen.labels && frozen.nodeCount == alloc.nodeCount, "Freeze keeps every node.");
+    mu_assert(frozen.childStart[1] - frozen.childStart[0] == root->children->count, "Root range holds its children.");
+    for (u32 i = 0; i < frozen.nodeCount; i++) {
+        for (u32 c = frozen.childStart[i] + 1; c < frozen.childStart[i + 1]; c++) {
+            mu_assert(frozen.labels[c - 1] < frozen.labels[c], "Sibling labels stay sorted.");
+        }
+    }
+
+    u32 batch[FRAGMENTS];
+    searchFrozenTrieBatch(&frozen, paths[0], FRAGMENT_LEN, lens, FRAGMENTS, batch);
+    for (u32 f = 0; f < FRAGMENTS; f++) {
+        TrieNode* leaf = searchTrie(root, paths[f], lens[f]);
+        u32 index = searchFrozenTrie(&frozen, paths[f], lens[f]);
+        mu_assert((leaf == NULL) == (index == FROZEN_MISS), "Frozen search hits exactly where the pointer trie does.");
+        mu_assert(!leaf || frozen.lutIndex[index] == leaf->lutIndex, "Frozen hits carry the payload.");
+        mu_assert(batch[f] == index, "Batched search agrees with single search.");
+    }
+    u16 empty = 0;
+    searchFrozenTrieBatch(&frozen, &empty, 1, &empty, 1, batch);
+    mu_assert(batch[0] == FROZEN_MISS, "Empty path misses at a non-terminal root.");
+
+    TrieAllocator undercounted = alloc;
+    undercounted.nodeCount = alloc.nodeCount / 2;
+    usize offset = arena->offset;
+    FrozenTrie overflow = freezeTrie(arena, &undercounted, root);
+    mu_assert(!overflow.labels && overflow.nodeCount == 0, "Freeze past the counted nodes returns an empty trie.");
+    mu_assert(arena->offset == offset, "Failed freeze gives its arena space back.");
+    releasePages(map);
+    PASS_TEST(" Frozen trie and batched lookup agree with the pointer trie.");
+    return NULL;
+}
+
+typedef struct {
+    TrieAllocator* alloc;
+    TrieNode* root;
+    u32 inserted;                   //fragments below this are in the trie, written by the writer
+} StressJob;
+
+//Fragment k, inserted with lutIndex k for even k and never inserted for odd k. Labels are
+//random, so most inserts land mid-array and force a copy.
+static void stressFragment(u32 k, u16* path) {
+    u32 state = 2 * (k / 2) + 11;
+    path[0] = (u16)(rng(&state) % 300);
+    for (u32 i = 1; i < STRESS_LEN; i++) {
+        path[i] = (u16)(rng(&state) % 50000);
+    }
+    if (k & 1) path[STRESS_LEN - 1] = (u16)(50000 + path[STRESS_LEN - 1] % 1000);
+}
+
+//Walks path checking every child array it passes is sorted, unique and within its capacity.
+static TrieNode* checkedSearch(TrieNode* root, const u16* path, bool* torn) {
+    TrieNode* node = root;
+    for (u32 i = 0; i < STRESS_LEN && node; i++) {
+        const TrieChildren* children = __atomic_load_n(&node->children, __ATOMIC_ACQUIRE);
+        u16 count = __atomic_load_n(&children->count, __ATOMIC_ACQUIRE);
+        if (count > ((u32)TRIE_INLINE_CHILDREN << children->sizeClass)) *torn = true;
+        for (u16 c = 1; c < count; c++) {
+            if (children->entries[c - 1].label >= children->entries[c].label) *torn = true;
+        }
+        node = searchChildByLabel(node, path[i]);
+    }
+    return (node && __atomic_load_n(&node->isTerminal, __ATOMIC_ACQUIRE)) ? node : NULL;
+}
+
+//Thread 0 inserts, the rest search; counters->count tallies searches.
+static void stressTask(memptr ctx, u32 threadIndex, StressCounters* counters) {
+    StressJob* job = (StressJob*)ctx;
+    u16 path[STRESS_LEN];
+    if (threadIndex == 0) {
+        for (u32 k = 0; k < STRESS_FRAGMENTS; k += 2) {
+            stressFragment(k, path);
+            insertTrie(job->alloc, job->root, path, STRESS_LEN, k);
+            __atomic_store_n(&job->inserted, k + 1, __ATOMIC_RELEASE);
+        }
+        return;
+    }
+    u32 state = 131 * threadIndex;
+    TrieEpoch* epoch = job->alloc->epoch;
+    for (;;) {
+        u32 inserted = __atomic_load_n(&job->inserted, __ATOMIC_ACQUIRE);
+        for (u32 s = 0; s < 64; s++) {
+            u32 k = rng(&state) % STRESS_FRAGMENTS;
+            stressFragment(k, path);
+            bool torn = false;
+            trieReadBegin(epoch, threadIndex);
+            TrieNode* leaf = checkedSearch(job->root, path, &torn);
+            u32 index = leaf ? __atomic_load_n(&leaf->lutIndex, __ATOMIC_RELAXED) : LUT_NONE;
+            trieReadEnd(epoch, threadIndex);
+            bool expected = !(k & 1) && k < inserted;
+            if (torn || (expected && (!leaf || index != k)) || ((k & 1) && leaf)) counters->errors++;
+            counters->count++;
+        }
+        if (inserted == STRESS_FRAGMENTS - 1) return;
+    }
+}
+
+char* test_concurrent_readers() {
+    memMap* map = initMemMap(MEM_MAP_SIZE);
+    PageArena* arena = createPageArena(map, ARENA_SIZE);
+    TrieAllocator alloc = createConcurrentTrieAllocator(arena);
+    mu_assert(alloc.epoch, "Reader slots allocated.");
+    TrieNode* root = createTrieNode(&alloc, 0);
+    StressJob job = { .alloc = &alloc, .root = root, .inserted = 0 };
+    StressCounters total = runStress(STRESS_THREADS, stressTask, &job);
+    mu_assert(total.count > 0 && total.errors == 0, "Readers never see a torn node or lose a published fragment.");
+    mu_assert(alloc.arraysRetired > 0 && alloc.arraysReused > 0, "Outgrown arrays come back once readers leave.");
+    mu_assert(alloc.arraysDropped < alloc.arraysRetired, "Most retired arrays are reclaimed, not dropped.");
+    reclaimTrieArrays(&alloc);
+    mu_assert(alloc.epoch->limboCount == 0, "With no reader inside, limbo drains.");
+
+    u16 path[STRESS_LEN];
+    for (u32 k = 0; k < STRESS_FRAGMENTS; k++) {
+        stressFragment(k, path);
+        TrieNode* leaf = searchTrie(root, path, STRESS_LEN);
+        mu_assert((k & 1) ? !leaf : (leaf && leaf->lutIndex == k), "Final trie holds exactly the even fragments.");
+    }
+    releasePages(map);
+    PASS_TEST(" Wait-free readers alongside a writer see only whole nodes.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_insert_and_search);
+    mu_run_test(test_child_arrays_are_reused);
+    mu_run_test(test_frozen_matches_pointer_trie);
+    mu_run_test(test_concurrent_readers);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
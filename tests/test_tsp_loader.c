@@ -0,0 +1,143 @@
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+
+#define ARENA_SIZE 1024 * 1024
+
+mu_suite_start();
+s32 tests_run = 0;
+
+char* test_load_fake() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/fake.tsp");
+    mu_assert(inst.status == TSP_LOAD_OK, "Fake file should load.");
+    mu_assert(inst.coords != NULL, "Coords should point into the arena.");
+    mu_assert(inst.dimension == 10, "Dimension should come from the header.");
+    mu_assert(inst.count == 10, "Count should equal coordinate lines.");
+    mu_assert(inst.coords[9][0] == 42150.0000f, "Correct x values should be placed in array.");
+    mu_assert(inst.coords[9][1] == 82966.6667f, "Correct y values should be placed in array.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Single pass load of fake data.");
+    return NULL;
+}
+
+char* test_matches_legacy_canada() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    const char* filename = "test_data/ca4663.tsp";
+    u32 count = CountDataSize(filename);
+    Vec2* legacy = LoadDistances(&arena, filename, count);
+    TspInstance inst = LoadTspInstance(&arena, filename);
+    mu_assert(inst.status == TSP_LOAD_OK, "Canada should load.");
+    mu_assert(inst.count == count && inst.dimension == count, "Count should match legacy count.");
+    mu_assert(memcmp(inst.coords, legacy, sizeof(Vec2) * count) == 0, "Coords should match sscanf bit for bit.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Canada coordinates match legacy loader.");
+    return NULL;
+}
+
+char* test_matches_legacy_italy() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    const char* filename = "test_data/it16862.tsp";
+    u32 count = CountDataSize(filename);
+    Vec2* legacy = LoadDistances(&arena, filename, count);
+    TspInstance inst = LoadTspInstance(&arena, filename);
+    mu_assert(inst.status == TSP_LOAD_OK, "Italy should load.");
+    mu_assert(inst.count == 16862, "Count should equal number of italian cities.");
+    mu_assert(memcmp(inst.coords, legacy, sizeof(Vec2) * count) == 0, "Coords should match sscanf bit for bit.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Italy coordinates match legacy loader.");
+    return NULL;
+}
+
+char* test_malformed_line() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/malformed.tsp");
+    mu_assert(inst.status == TSP_LOAD_ERR_PARSE, "Malformed line should fail to parse.");
+    mu_assert(inst.errorLine == 8, "Error should report the malformed file line.");
+    mu_assert(inst.coords == NULL, "No coords on parse failure.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Malformed line reported.");
+    return NULL;
+}
+
+char* test_missing_file() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&arena, "test_data/missing.tsp");
+    mu_assert(inst.status == TSP_LOAD_ERR_OPEN, "Missing file should report open failure.");
+    mu_assert(inst.coords == NULL, "No coords for missing file.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Missing file handled.");
+    return NULL;
+}
+
+char* test_parallel_matches_serial() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    const char* filename = "test_data/it16862.tsp";
+    TspInstance serial = LoadTspInstance(&arena, filename);
+    u32 threadCounts[] = { 2, 3, 7, 16 };
+    for (u32 t = 0; t < ARRAY_COUNT(threadCounts); t++) {
+        TspInstance par = LoadTspInstanceParallel(&arena, filename, threadCounts[t]);
+        mu_assert(par.status == TSP_LOAD_OK, "Parallel load should succeed.");
+        mu_assert(par.count == serial.count, "Parallel count should match serial.");
+        mu_assert(memcmp(par.coords, serial.coords, sizeof(Vec2) * serial.count) == 0, "Parallel coords should match serial.");
+    }
+    destroyScratchArena(&arena);
+    PASS_TEST(" Parallel chunked load matches serial.");
+    return NULL;
+}
+
+char* test_parallel_malformed_line() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstanceParallel(&arena, "test_data/malformed.tsp", 3);
+    mu_assert(inst.status == TSP_LOAD_ERR_PARSE, "Malformed line should fail in parallel.");
+    mu_assert(inst.errorLine == 8, "Parallel error should report the malformed file line.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Parallel malformed line reported.");
+    return NULL;
+}
+
+char* test_letter_line_is_malformed() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    TspInstance serial = LoadTspInstance(&arena, "test_data/letter_line.tsp");
+    mu_assert(serial.status == TSP_LOAD_ERR_PARSE, "A data line opening with a letter is not a section end.");
+    mu_assert(serial.errorLine == 7 && serial.coords == NULL, "Error should report the letter line.");
+    TspInstance par = LoadTspInstanceParallel(&arena, "test_data/letter_line.tsp", 3);
+    mu_assert(par.status == TSP_LOAD_ERR_PARSE && par.errorLine == 7, "Chunk splitter should not end the section there.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Letter-led data line reported as malformed.");
+    return NULL;
+}
+
+char* test_duplicate_and_missing_index() {
+    ScratchArena arena = createScratchArena(ARENA_SIZE);
+    //index 2 twice and 3 never: the line count still equals DIMENSION
+    TspInstance dup = LoadTspInstance(&arena, "test_data/duplicate_index.tsp");
+    mu_assert(dup.status == TSP_LOAD_ERR_PARSE && dup.errorLine == 8, "Repeated index should fail at its line.");
+    mu_assert(dup.coords == NULL, "No coords on repeated index.");
+    dup = LoadTspInstanceParallel(&arena, "test_data/duplicate_index.tsp", 3);
+    mu_assert(dup.status == TSP_LOAD_ERR_PARSE, "Repeated index should fail in parallel.");
+    TspInstance missing = LoadTspInstance(&arena, "test_data/missing_index.tsp");
+    mu_assert(missing.status == TSP_LOAD_ERR_PARSE && missing.coords == NULL, "Missing index should fail.");
+    missing = LoadTspInstanceParallel(&arena, "test_data/missing_index.tsp", 3);
+    mu_assert(missing.status == TSP_LOAD_ERR_PARSE, "Missing index should fail in parallel.");
+    destroyScratchArena(&arena);
+    PASS_TEST(" Repeated and missing node indices rejected.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_load_fake);
+    mu_run_test(test_matches_legacy_canada);
+    mu_run_test(test_matches_legacy_italy);
+    mu_run_test(test_malformed_line);
+    mu_run_test(test_missing_file);
+    mu_run_test(test_parallel_matches_serial);
+    mu_run_test(test_parallel_malformed_line);
+    mu_run_test(test_letter_line_is_malformed);
+    mu_run_test(test_duplicate_and_missing_index);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,133 @@
+#include <string.h>
+#include "minunit.h"
+#include "arena_base.h"
+#include "scratch_arena.h"
+#include "page_arena.h"
+#include "dist_matrix.h"
+#include "tsp_loader.h"
+#include "dist_kernels.h"
+#include "tour.h"
+#include "construct.h"
+#include "window_opt.h"
+
+#define ARENA_SIZE MiB(64)
+#define WINDOW 10
+#define MEMO_SLOTS (1u << 16)
+
+mu_suite_start();
+s32 tests_run = 0;
+
+//Minimal open-addressing memo over whole windows.
+typedef struct {
+    u32 path[WINDOW];
+    u32 order[WINDOW];
+    u32 len;
+    f32 cost;
+    bool used;
+} MemoEntry;
+
+typedef struct {
+    MemoEntry* slots;
+    u32 inserts;
+} TestMemo;
+
+static u32 hashPath(const u32* path, u32 len) {
+    u32 h = 2166136261u;
+    for (u32 k = 0; k < len; k++) {
+        h = (h ^ path[k]) * 16777619u;
+    }
+    return h & (MEMO_SLOTS - 1);
+}
+
+static MemoEntry* findSlot(TestMemo* memo, const u32* path, u32 len) {
+    u32 s = hashPath(path, len);
+    while (memo->slots[s].used) {
+        MemoEntry* e = &memo->slots[s];
+        if (e->len == len && memcmp(e->path, path, sizeof(u32) * len) == 0) return e;
+        s = (s + 1) & (MEMO_SLOTS - 1);
+    }
+    return &memo->slots[s];
+}
+
+static bool memoLookup(memptr ctx, const u32* path, u32 len, f32* cost, u32* order) {
+    MemoEntry* e = findSlot((TestMemo*)ctx, path, len);
+    if (!e->used) return false;
+    *cost = e->cost;
+    memcpy(order, e->order, sizeof(u32) * len);
+    return true;
+}
+
+static void memoInsert(memptr ctx, const u32* path, u32 len, f32 cost, const u32* order) {
+    TestMemo* memo = (TestMemo*)ctx;
+    MemoEntry* e = findSlot(memo, path, len);
+    if (e->used) return;
+    memcpy(e->path, path, sizeof(u32) * len);
+    memcpy(e->order, order, sizeof(u32) * len);
+    e->len = len;
+    e->cost = cost;
+    e->used = true;
+    memo->inserts++;
+}
+
+char* test_windows_improve_tour() {
+    ScratchArena scratch = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&scratch, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&scratch, &inst);
+    u32 count = inst.count;
+    u32* serial = NearestNeighborTour(&scratch, (const Vec2*)inst.coords, count, 0);
+    u32* parallel = arenaScratchAlloc(&scratch, sizeof(u32) * count, ALIGN_64);
+    memcpy(parallel, serial, sizeof(u32) * count);
+    f64 before = TourLength(dm, serial, count);
+
+    memMap* map = initMemMap(MiB(64));
+    PageArena* arena = createPageArena(map, WindowOptBlockSize(count, WINDOW, 4));
+    WindowOptStats one = WindowOptimize(arena, serial, count, dm, WINDOW, NULL, 1);
+    WindowOptStats four = WindowOptimize(arena, parallel, count, dm, WINDOW, NULL, 4);
+    mu_assert(arena->offset == 0, "Scratch blocks are handed back.");
+
+    f64 after = TourLength(dm, serial, count);
+    mu_assert(IsTourPermutation(&scratch, serial, count), "Windows keep a valid tour.");
+    mu_assert(one.improved > 0 && after < before, "Exact windows shorten a nearest neighbor tour.");
+    mu_assert(before - after > one.gain - 1.0 && before - after < one.gain + 1.0, "Reported gain matches.");
+    mu_assert(memcmp(serial, parallel, sizeof(u32) * count) == 0 && four.gain == one.gain,
+              "Worker count does not change the result.");
+
+    releasePages(map);
+    destroyScratchArena(&scratch);
+    PASS_TEST(" Window re-optimization improves a tour, independent of threads.");
+    return NULL;
+}
+
+char* test_repeat_pass_hits_memo() {
+    ScratchArena scratch = createScratchArena(ARENA_SIZE);
+    TspInstance inst = LoadTspInstance(&scratch, "test_data/ca4663.tsp");
+    DistanceMatrix dm = BuildDistanceMatrix(&scratch, &inst);
+    DistanceOracle oracle = CreateDenseOracle(dm, inst.count, inst.metric);
+    u32 count = inst.count;
+    u32* tour = GreedyEdgeTour(&scratch, (const Vec2*)inst.coords, count, &oracle, 1);
+    TestMemo store = { .slots = arenaScratchAlloc(&scratch, sizeof(MemoEntry) * MEMO_SLOTS, ALIGN_64), .inserts = 0 };
+    memset(store.slots, 0, sizeof(MemoEntry) * MEMO_SLOTS);
+    FragmentMemo memo = { .lookup = memoLookup, .insert = memoInsert, .ctx = &store };
+
+    memMap* map = initMemMap(MiB(64));
+    PageArena* arena = createPageArena(map, WindowOptBlockSize(count, WINDOW, 2));
+    WindowOptStats first = WindowOptimize(arena, tour, count, dm, WINDOW, &memo, 2);
+    mu_assert(first.solved == store.inserts && first.solved + first.cacheHits == first.windows,
+              "Every window is either solved and remembered or answered by the memo.");
+    WindowOptStats again = WindowOptimize(arena, tour, count, dm, WINDOW, &memo, 2);
+    mu_assert(again.improved == 0 && again.solved == 0 && again.cacheHits == again.windows,
+              "A converged tour is answered entirely from the memo.");
+
+    releasePages(map);
+    destroyScratchArena(&scratch);
+    PASS_TEST(" Repeat pass over a converged tour is all memo hits.");
+    return NULL;
+}
+
+static char* all_tests() {
+    mu_run_test(test_windows_improve_tour);
+    mu_run_test(test_repeat_pass_hits_memo);
+    return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,12 @@
+#include <time.h>
+#include "timer.h"
+
+u64 timerNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + (u64)ts.tv_nsec;
+}
+
+f64 timerElapsedMs(u64 startNs) {
+    return (f64)(timerNowNs() - startNs) / 1.0e6;
+}
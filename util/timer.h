@@ -0,0 +1,9 @@
+#ifndef u_TIMER_H
+#define u_TIMER_H
+
+#include "common_types.h"
+
+u64 timerNowNs(void);
+f64 timerElapsedMs(u64 startNs);
+
+#endif